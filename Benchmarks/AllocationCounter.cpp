@@ -0,0 +1,32 @@
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.hpp"
+
+namespace
+{
+    thread_local size_t allocations = 0;
+    thread_local size_t bytes = 0;
+} // namespace
+
+namespace sd::bench
+{
+    size_t allocationsCount() { return allocations; }
+
+    size_t allocatedBytes() { return bytes; }
+} // namespace sd::bench
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    bytes += size;
+    if (auto ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "BTreeMap.hpp"
+#include "Map.hpp"
+
+namespace
+{
+    std::vector<int> makeKeys(size_t size)
+    {
+        std::vector<int> keys(size);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{42});
+        return keys;
+    }
+
+    template <class TMap> void fill(TMap &map, const std::vector<int> &keys)
+    {
+        for (auto key : keys)
+        {
+            map.insert({key, key});
+        }
+    }
+
+    template <class TMap> void BM_OrderedInsert(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        for (auto _ : state)
+        {
+            TMap map;
+            fill(map, keys);
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    template <class TMap> void BM_OrderedFind(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        TMap map;
+        fill(map, keys);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{7});
+        for (auto _ : state)
+        {
+            for (auto key : keys)
+            {
+                benchmark::DoNotOptimize(map.at(key));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    template <class TMap> void BM_OrderedIterate(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        TMap map;
+        fill(map, keys);
+        for (auto _ : state)
+        {
+            long long sum = 0;
+            for (auto &[key, value] : map)
+            {
+                sum += value;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    template <class TMap> void BM_OrderedRemove(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            TMap map;
+            fill(map, keys);
+            state.ResumeTiming();
+            for (auto key : keys)
+            {
+                map.remove(key);
+            }
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    using RedBlackMap = sd::Map<int, int>;
+    using BPlusTreeMap = sd::BTreeMap<int, int>;
+
+    // 100M keys needs several GB of memory per container, so they are registered only when SD_LARGE_BENCHMARKS is set
+    void largeSizes(benchmark::internal::Benchmark *benchmark)
+    {
+        benchmark->Arg(1 << 10)->Arg(1 << 20);
+        if (std::getenv("SD_LARGE_BENCHMARKS"))
+        {
+            benchmark->Arg(100'000'000);
+        }
+    }
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_OrderedInsert, RedBlackMap)->Apply(largeSizes);
+BENCHMARK_TEMPLATE(BM_OrderedInsert, BPlusTreeMap)->Apply(largeSizes);
+BENCHMARK_TEMPLATE(BM_OrderedFind, RedBlackMap)->Apply(largeSizes);
+BENCHMARK_TEMPLATE(BM_OrderedFind, BPlusTreeMap)->Apply(largeSizes);
+BENCHMARK_TEMPLATE(BM_OrderedIterate, RedBlackMap)->Apply(largeSizes);
+BENCHMARK_TEMPLATE(BM_OrderedIterate, BPlusTreeMap)->Apply(largeSizes);
+BENCHMARK_TEMPLATE(BM_OrderedRemove, RedBlackMap)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_OrderedRemove, BPlusTreeMap)->Arg(1 << 10)->Arg(1 << 20);
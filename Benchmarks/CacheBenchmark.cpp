@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "Cache.hpp"
+
+namespace
+{
+    // keys are slices of one network-like buffer, as they come from request parsing
+    std::string makeBuffer(size_t size)
+    {
+        std::string buffer;
+        for (size_t i = 0; i < size; ++i)
+        {
+            buffer += "session-key-" + std::to_string(i) + ";";
+        }
+        return buffer;
+    }
+
+    std::vector<std::string_view> splitBuffer(std::string_view buffer)
+    {
+        std::vector<std::string_view> keys;
+        size_t start = 0;
+        for (auto end = buffer.find(';'); end != std::string_view::npos; end = buffer.find(';', start))
+        {
+            keys.push_back(buffer.substr(start, end - start));
+            start = end + 1;
+        }
+        return keys;
+    }
+
+    void BM_CacheGetStringCopy(benchmark::State &state)
+    {
+        auto buffer = makeBuffer(state.range(0));
+        auto keys = splitBuffer(buffer);
+        sd::Cache cache;
+        for (auto key : keys)
+        {
+            cache.Add(std::string{key}, 1);
+        }
+        auto allocationsBefore = sd::bench::allocationsCount();
+        for (auto _ : state)
+        {
+            for (auto key : keys)
+            {
+                benchmark::DoNotOptimize(cache.Get<int>(std::string{key}));
+            }
+        }
+        auto lookups = state.iterations() * keys.size();
+        state.counters["allocs_per_lookup"] = double(sd::bench::allocationsCount() - allocationsBefore) / lookups;
+        state.SetItemsProcessed(lookups);
+    }
+
+    void BM_CacheGetStringView(benchmark::State &state)
+    {
+        auto buffer = makeBuffer(state.range(0));
+        auto keys = splitBuffer(buffer);
+        sd::Cache cache;
+        for (auto key : keys)
+        {
+            cache.Add(std::string{key}, 1);
+        }
+        auto allocationsBefore = sd::bench::allocationsCount();
+        for (auto _ : state)
+        {
+            for (auto key : keys)
+            {
+                benchmark::DoNotOptimize(cache.Get<int>(key));
+            }
+        }
+        auto lookups = state.iterations() * keys.size();
+        state.counters["allocs_per_lookup"] = double(sd::bench::allocationsCount() - allocationsBefore) / lookups;
+        state.SetItemsProcessed(lookups);
+    }
+} // namespace
+
+BENCHMARK(BM_CacheGetStringCopy)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(BM_CacheGetStringView)->Arg(1 << 10)->Arg(1 << 16);
@@ -0,0 +1,112 @@
+#include <benchmark/benchmark.h>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentMap.hpp"
+#include "Map.hpp"
+
+namespace
+{
+    const int KeySpace = 1 << 16;
+    const int OperationsPerThread = 1 << 16;
+
+    // sd::Map behind one global mutex, what callers had to do before ConcurrentMap
+    class LockedMap
+    {
+      private:
+        sd::Map<int, int> _map;
+        std::mutex _mutex;
+
+      public:
+        bool insert(const std::pair<const int, int> &value)
+        {
+            std::lock_guard lock(_mutex);
+            return _map.insert(value).second;
+        }
+
+        bool remove(int key)
+        {
+            std::lock_guard lock(_mutex);
+            if (!_map.contains(key))
+            {
+                return false;
+            }
+            _map.remove(key);
+            return true;
+        }
+
+        bool contains(int key)
+        {
+            std::lock_guard lock(_mutex);
+            return _map.contains(key);
+        }
+    };
+
+    using SkipListMap = sd::ConcurrentMap<int, int>;
+
+    /**
+     * range(0) is number of threads, range(1) percent of reads, rest is split evenly between inserts and removes.
+     * Threads are started inside timed region, so wall time is measured
+     */
+    template <class TMap> void BM_ConcurrentMixed(benchmark::State &state)
+    {
+        const auto threads = size_t(state.range(0));
+        const auto readPercent = unsigned(state.range(1));
+        TMap map;
+        for (int key = 0; key < KeySpace; key += 2)
+        {
+            map.insert({key, key});
+        }
+        for (auto _ : state)
+        {
+            std::vector<std::thread> workers;
+            for (size_t thread = 0; thread < threads; ++thread)
+            {
+                workers.emplace_back([&, thread] {
+                    std::mt19937 gen{unsigned(thread)};
+                    size_t found = 0;
+                    for (int i = 0; i < OperationsPerThread; ++i)
+                    {
+                        auto key = int(gen() % KeySpace);
+                        auto operation = gen() % 100;
+                        if (operation < readPercent)
+                        {
+                            found += map.contains(key);
+                        }
+                        else if (operation % 2)
+                        {
+                            map.insert({key, key});
+                        }
+                        else
+                        {
+                            map.remove(key);
+                        }
+                    }
+                    benchmark::DoNotOptimize(found);
+                });
+            }
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * threads * OperationsPerThread);
+    }
+
+    void threadsAndReadRatios(benchmark::internal::Benchmark *benchmark)
+    {
+        const int maxThreads = int(std::max(2u, std::thread::hardware_concurrency()));
+        for (int readPercent : {50, 90, 100})
+        {
+            for (int threads = 1; threads <= maxThreads; threads *= 2)
+            {
+                benchmark->Args({threads, readPercent});
+            }
+        }
+    }
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_ConcurrentMixed, LockedMap)->Apply(threadsAndReadRatios)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentMixed, SkipListMap)->Apply(threadsAndReadRatios)->UseRealTime();
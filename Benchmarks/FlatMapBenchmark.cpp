@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "FlatMap.hpp"
+#include "Map.hpp"
+
+namespace
+{
+    // sparse keys, so lookups do not hit consecutive positions
+    std::vector<std::pair<int, int>> makePairs(size_t size)
+    {
+        std::vector<std::pair<int, int>> pairs(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            pairs[i] = {int(i * 7), int(i)};
+        }
+        std::shuffle(pairs.begin(), pairs.end(), std::mt19937{42});
+        return pairs;
+    }
+
+    std::vector<int> makeProbes(const std::vector<std::pair<int, int>> &pairs)
+    {
+        std::vector<int> probes;
+        probes.reserve(pairs.size());
+        for (auto &[key, value] : pairs)
+        {
+            probes.push_back(key);
+        }
+        std::shuffle(probes.begin(), probes.end(), std::mt19937{7});
+        return probes;
+    }
+
+    template <class TMap> double buildMap(TMap &map, const std::vector<std::pair<int, int>> &pairs)
+    {
+        auto bytesBefore = sd::bench::allocatedBytes();
+        for (auto &pair : pairs)
+        {
+            map.insert(pair);
+        }
+        return double(sd::bench::allocatedBytes() - bytesBefore) / pairs.size();
+    }
+
+    double buildMap(sd::FlatMap<int, int> &map, const std::vector<std::pair<int, int>> &pairs)
+    {
+        map = sd::FlatMap<int, int>(pairs.begin(), pairs.end());
+        return double(map.capacity() * (sizeof(int) + sizeof(int))) / pairs.size();
+    }
+
+    template <class TMap> void BM_SortedLookup(benchmark::State &state)
+    {
+        auto pairs = makePairs(state.range(0));
+        auto probes = makeProbes(pairs);
+        TMap map;
+        auto bytesPerEntry = buildMap(map, pairs);
+        for (auto _ : state)
+        {
+            for (auto key : probes)
+            {
+                benchmark::DoNotOptimize(map.at(key));
+            }
+        }
+        state.counters["bytes_per_entry"] = bytesPerEntry;
+        state.SetItemsProcessed(state.iterations() * probes.size());
+    }
+
+    // half of probes are missing keys
+    template <class TMap> void BM_SortedContains(benchmark::State &state)
+    {
+        auto pairs = makePairs(state.range(0));
+        auto probes = makeProbes(pairs);
+        for (size_t i = 0; i < probes.size(); i += 2)
+        {
+            probes[i] += 3;
+        }
+        TMap map;
+        buildMap(map, pairs);
+        for (auto _ : state)
+        {
+            size_t found = 0;
+            for (auto key : probes)
+            {
+                found += map.contains(key);
+            }
+            benchmark::DoNotOptimize(found);
+        }
+        state.SetItemsProcessed(state.iterations() * probes.size());
+    }
+
+    void BM_FlatMapBulkBuild(benchmark::State &state)
+    {
+        auto pairs = makePairs(state.range(0));
+        for (auto _ : state)
+        {
+            sd::FlatMap<int, int> map(pairs.begin(), pairs.end());
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * pairs.size());
+    }
+
+    using RedBlackMap = sd::Map<int, int>;
+    using PoolRedBlackMap = sd::Map<int, int, std::less<int>, sd::PoolNodeAllocator>;
+    using SortedArrayMap = sd::FlatMap<int, int>;
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_SortedLookup, RedBlackMap)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_SortedLookup, PoolRedBlackMap)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_SortedLookup, SortedArrayMap)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_SortedContains, RedBlackMap)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_SortedContains, SortedArrayMap)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_FlatMapBulkBuild)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
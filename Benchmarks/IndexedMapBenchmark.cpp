@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "IndexedMap.hpp"
+#include "Map.hpp"
+
+namespace
+{
+    std::vector<uint64_t> makeKeys(size_t size)
+    {
+        std::vector<uint64_t> keys(size);
+        std::mt19937_64 gen(42);
+        for (auto &key : keys)
+        {
+            key = gen();
+        }
+        return keys;
+    }
+
+    template <class TMap> double buildMap(TMap &map, const std::vector<uint64_t> &keys)
+    {
+        auto bytesBefore = sd::bench::allocatedBytes();
+        for (auto key : keys)
+        {
+            map.insert({key, 1});
+        }
+        return double(sd::bench::allocatedBytes() - bytesBefore) / keys.size();
+    }
+
+    template <class TMap> void BM_IndexedInsert(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        for (auto _ : state)
+        {
+            TMap map;
+            for (auto key : keys)
+            {
+                map.insert({key, 1});
+            }
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    template <class TMap> void BM_IndexedFind(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        TMap map;
+        auto bytesPerEntry = buildMap(map, keys);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{7});
+        for (auto _ : state)
+        {
+            for (auto key : keys)
+            {
+                benchmark::DoNotOptimize(map.at(key));
+            }
+        }
+        state.counters["bytes_per_entry"] = bytesPerEntry;
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    /**
+     * Exact lookups mixed with short ordered scans of 16 elements, range(1) is percentage of lookups
+     */
+    template <class TMap> void BM_IndexedLookupScanMix(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        TMap map;
+        buildMap(map, keys);
+        std::mt19937 gen(7);
+        std::vector<bool> scans(1 << 12);
+        for (auto &&scan : scans)
+        {
+            scan = int(gen() % 100) >= state.range(1);
+        }
+        std::shuffle(keys.begin(), keys.end(), gen);
+        size_t i = 0;
+        for (auto _ : state)
+        {
+            auto key = keys[i % keys.size()];
+            if (scans[i % scans.size()])
+            {
+                uint64_t sum = 0;
+                auto it = map.lowerBound(key);
+                for (int step = 0; step < 16 && it != map.end(); ++step, ++it)
+                {
+                    sum += it->first;
+                }
+                benchmark::DoNotOptimize(sum);
+            }
+            else
+            {
+                benchmark::DoNotOptimize(map.find(key));
+            }
+            ++i;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    using IntMap = sd::Map<uint64_t, int>;
+    using IntIndexedMap = sd::IndexedMap<uint64_t, int>;
+
+    void sizes(benchmark::internal::Benchmark *benchmark) { benchmark->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20); }
+
+    void mixes(benchmark::internal::Benchmark *benchmark)
+    {
+        benchmark->ArgsProduct({{1 << 16, 1 << 20}, {90, 100}});
+    }
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_IndexedInsert, IntMap)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_IndexedInsert, IntIndexedMap)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_IndexedFind, IntMap)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_IndexedFind, IntIndexedMap)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_IndexedLookupScanMix, IntMap)->Apply(mixes);
+BENCHMARK_TEMPLATE(BM_IndexedLookupScanMix, IntIndexedMap)->Apply(mixes);
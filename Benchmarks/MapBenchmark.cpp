@@ -0,0 +1,714 @@
+#include <algorithm>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "Map.hpp"
+
+namespace
+{
+    std::vector<int> makeShuffledKeys(size_t size)
+    {
+        std::vector<int> keys(size);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{42});
+        return keys;
+    }
+
+    template <class TMap> void BM_MapInsert(benchmark::State &state)
+    {
+        auto keys = makeShuffledKeys(state.range(0));
+        for (auto _ : state)
+        {
+            TMap map;
+            for (auto key : keys)
+            {
+                map.insert({key, key});
+            }
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    // bytes requested from operator new per entry, pool chunks included
+    template <class TMap> void BM_MapBytesPerEntry(benchmark::State &state)
+    {
+        auto keys = makeShuffledKeys(state.range(0));
+        size_t bytes = 0;
+        for (auto _ : state)
+        {
+            auto bytesBefore = sd::bench::allocatedBytes();
+            TMap map;
+            for (auto key : keys)
+            {
+                map.insert({key, key});
+            }
+            bytes += sd::bench::allocatedBytes() - bytesBefore;
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.counters["bytesPerEntry"] = double(bytes) / (state.iterations() * keys.size());
+    }
+
+    template <class TMap> void BM_MapFind(benchmark::State &state)
+    {
+        auto keys = makeShuffledKeys(state.range(0));
+        TMap map;
+        for (auto key : keys)
+        {
+            map.insert({key, key});
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{7});
+        for (auto _ : state)
+        {
+            for (auto key : keys)
+            {
+                benchmark::DoNotOptimize(map.at(key));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    /**
+     * range(0) is map size, range(1) batch size, keys are inserted in random order so nodes are scattered in memory
+     */
+    template <class TMap> void BM_MapFindBatchLoop(benchmark::State &state)
+    {
+        auto keys = makeShuffledKeys(state.range(0));
+        TMap map;
+        for (auto key : keys)
+        {
+            map.insert({key, key});
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{7});
+        const auto batch = size_t(state.range(1));
+        std::vector<typename TMap::Iterator> results(batch);
+        size_t offset = 0;
+        for (auto _ : state)
+        {
+            for (size_t i = 0; i < batch; ++i)
+            {
+                results[i] = map.find(keys[offset + i]);
+            }
+            benchmark::DoNotOptimize(results.data());
+            offset = (offset + batch) % (keys.size() - batch);
+        }
+        state.SetItemsProcessed(state.iterations() * batch);
+    }
+
+    template <class TMap> void BM_MapFindMany(benchmark::State &state)
+    {
+        auto keys = makeShuffledKeys(state.range(0));
+        TMap map;
+        for (auto key : keys)
+        {
+            map.insert({key, key});
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{7});
+        const auto batch = size_t(state.range(1));
+        std::vector<typename TMap::Iterator> results(batch);
+        size_t offset = 0;
+        for (auto _ : state)
+        {
+            map.findMany(std::span<const int>(keys).subspan(offset, batch), results);
+            benchmark::DoNotOptimize(results.data());
+            offset = (offset + batch) % (keys.size() - batch);
+        }
+        state.SetItemsProcessed(state.iterations() * batch);
+    }
+
+    template <class TMap> void BM_MapInsertRemoveChurn(benchmark::State &state)
+    {
+        auto keys = makeShuffledKeys(state.range(0));
+        TMap map;
+        for (auto key : keys)
+        {
+            map.insert({key, key});
+        }
+        for (auto _ : state)
+        {
+            for (auto key : keys)
+            {
+                map.remove(key);
+                map.insert({key, key});
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    using HeapMap = sd::Map<int, int>;
+    using PoolMap = sd::Map<int, int, std::less<int>, sd::PoolNodeAllocator>;
+    using CompactHeapMap = sd::Map<int, int, std::less<int>, sd::HeapNodeAllocator, sd::NoAugmentation,
+                                   sd::CompactMapNodeLinks>;
+    using CompactPoolMap = sd::Map<int, int, std::less<int>, sd::PoolNodeAllocator, sd::NoAugmentation,
+                                   sd::CompactMapNodeLinks>;
+    using StatsHeapMap = sd::Map<int, int, std::less<int>, sd::HeapNodeAllocator, sd::NoAugmentation,
+                                 sd::MapNodeLinks, sd::RedBlackBalance, sd::MapStats>;
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_MapInsert, HeapMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapInsert, PoolMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapInsert, CompactHeapMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapInsert, CompactPoolMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapBytesPerEntry, HeapMap)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_MapBytesPerEntry, PoolMap)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_MapBytesPerEntry, CompactHeapMap)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_MapBytesPerEntry, CompactPoolMap)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_MapFind, HeapMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapFind, PoolMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapFind, CompactHeapMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapFind, StatsHeapMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapFindBatchLoop, HeapMap)->ArgsProduct({{1 << 12, 1 << 16, 1 << 20}, {64, 1024}});
+BENCHMARK_TEMPLATE(BM_MapFindMany, HeapMap)->ArgsProduct({{1 << 12, 1 << 16, 1 << 20}, {64, 1024}});
+BENCHMARK_TEMPLATE(BM_MapInsertRemoveChurn, HeapMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapInsertRemoveChurn, PoolMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapInsertRemoveChurn, CompactHeapMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapInsertRemoveChurn, StatsHeapMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+namespace
+{
+    /**
+     * Ttl sweep removing tenth of entries, items are expiry times in random order. Removed entries are inserted
+     * back outside of timing. ByKey collects expired keys in walk and removes each of them, what was only option
+     * before iterator erase, otherwise eraseIf removes them during walk
+     */
+    template <bool ByKey> void BM_MapTtlSweep(benchmark::State &state)
+    {
+        auto keys = makeShuffledKeys(state.range(0));
+        sd::Map<int, int> map;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            map.insert({int(i), keys[i]});
+        }
+        auto expired = [](const std::pair<const int, int> &pair) { return pair.second % 10 == 0; };
+        std::vector<std::pair<int, int>> removed;
+        for (auto _ : state)
+        {
+            if constexpr (ByKey)
+            {
+                removed.clear();
+                for (auto &pair : map)
+                {
+                    if (expired(pair))
+                    {
+                        removed.emplace_back(pair);
+                    }
+                }
+                for (auto &pair : removed)
+                {
+                    map.remove(pair.first);
+                }
+            }
+            else
+            {
+                benchmark::DoNotOptimize(map.eraseIf(expired));
+            }
+
+            state.PauseTiming();
+            if constexpr (!ByKey)
+            {
+                removed.clear();
+                for (size_t i = 0; i < keys.size(); ++i)
+                {
+                    if (keys[i] % 10 == 0)
+                    {
+                        removed.emplace_back(int(i), keys[i]);
+                    }
+                }
+            }
+            for (auto &pair : removed)
+            {
+                map.insert(pair);
+            }
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_MapTtlSweep, true)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapTtlSweep, false)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+
+namespace
+{
+    /**
+     * range(0) is map size, range(1) percent of lookups, other operations insert absent key or remove present one,
+     * so size stays around range(0). Keys are drawn from twice bigger range, half of lookups miss
+     */
+    template <class TMap> void BM_MapBalanceMix(benchmark::State &state)
+    {
+        auto size = int(state.range(0));
+        auto lookups = unsigned(state.range(1));
+        std::mt19937 gen(42);
+        TMap map;
+        while (map.size() < size_t(size))
+        {
+            auto key = int(gen() % unsigned(2 * size));
+            map.insert({key, key});
+        }
+        std::vector<std::pair<int, bool>> operations(1 << 16);
+        for (auto &[key, lookup] : operations)
+        {
+            key = int(gen() % unsigned(2 * size));
+            lookup = gen() % 100 < lookups;
+        }
+        for (auto _ : state)
+        {
+            for (auto [key, lookup] : operations)
+            {
+                if (lookup)
+                {
+                    benchmark::DoNotOptimize(map.find(key));
+                }
+                else if (!map.insert({key, key}).second)
+                {
+                    map.remove(key);
+                }
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * operations.size());
+    }
+
+    using AvlMap = sd::Map<int, int, std::less<int>, sd::HeapNodeAllocator, sd::NoAugmentation, sd::MapNodeLinks,
+                           sd::AvlBalance>;
+    using WavlMap = sd::Map<int, int, std::less<int>, sd::HeapNodeAllocator, sd::NoAugmentation, sd::MapNodeLinks,
+                            sd::WavlBalance>;
+    using TreapMap = sd::Map<int, int, std::less<int>, sd::HeapNodeAllocator, sd::NoAugmentation, sd::MapNodeLinks,
+                             sd::TreapBalance>;
+
+    void balanceMixes(benchmark::internal::Benchmark *benchmark)
+    {
+        benchmark->ArgsProduct({{1 << 16, 1 << 20}, {10, 50, 90, 98}});
+    }
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_MapBalanceMix, HeapMap)->Apply(balanceMixes);
+BENCHMARK_TEMPLATE(BM_MapBalanceMix, AvlMap)->Apply(balanceMixes);
+BENCHMARK_TEMPLATE(BM_MapBalanceMix, WavlMap)->Apply(balanceMixes);
+BENCHMARK_TEMPLATE(BM_MapBalanceMix, TreapMap)->Apply(balanceMixes);
+
+namespace
+{
+    // plain bool comparator, forces map to use two comparisons per tree level
+    struct TwoWayStringLess
+    {
+        bool operator()(const std::string &lhs, const std::string &rhs) const { return lhs < rhs; }
+    };
+
+    std::vector<std::string> makeStringKeys(size_t size)
+    {
+        std::vector<std::string> keys;
+        keys.reserve(size);
+        for (auto key : makeShuffledKeys(size))
+        {
+            keys.push_back("/api/v1/resource/" + std::to_string(key));
+        }
+        return keys;
+    }
+
+    template <class TMap> void BM_MapFindString(benchmark::State &state)
+    {
+        auto keys = makeStringKeys(state.range(0));
+        TMap map;
+        for (auto &key : keys)
+        {
+            map.insert({key, 0});
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{7});
+        for (auto _ : state)
+        {
+            for (auto &key : keys)
+            {
+                benchmark::DoNotOptimize(map.at(key));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    using TwoWayStringMap = sd::Map<std::string, int, TwoWayStringLess>;
+    using ThreeWayStringMap = sd::Map<std::string, int>;
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_MapFindString, TwoWayStringMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MapFindString, ThreeWayStringMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+namespace
+{
+    template <class TMap, class TKey> void BM_MapFindStringAllocations(benchmark::State &state)
+    {
+        auto keys = makeStringKeys(state.range(0));
+        TMap map;
+        for (auto &key : keys)
+        {
+            map.insert({key, 0});
+        }
+        std::vector<std::string_view> probes(keys.begin(), keys.end());
+        auto allocationsBefore = sd::bench::allocationsCount();
+        for (auto _ : state)
+        {
+            for (auto probe : probes)
+            {
+                benchmark::DoNotOptimize(map.at(TKey{probe}));
+            }
+        }
+        auto lookups = state.iterations() * probes.size();
+        state.counters["allocs_per_lookup"] = double(sd::bench::allocationsCount() - allocationsBefore) / lookups;
+        state.SetItemsProcessed(lookups);
+    }
+
+    using TransparentStringMap = sd::Map<std::string, int, std::less<>>;
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_MapFindStringAllocations, ThreeWayStringMap, std::string)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_MapFindStringAllocations, TransparentStringMap, std::string_view)->Arg(1 << 10)->Arg(1 << 16);
+
+namespace
+{
+    std::vector<std::pair<int, int>> makeSortedPairs(size_t size)
+    {
+        std::vector<std::pair<int, int>> pairs;
+        pairs.reserve(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            pairs.push_back({int(i), int(i)});
+        }
+        return pairs;
+    }
+
+    void BM_MapBuildSortedOneByOne(benchmark::State &state)
+    {
+        auto pairs = makeSortedPairs(state.range(0));
+        for (auto _ : state)
+        {
+            HeapMap map;
+            for (auto &pair : pairs)
+            {
+                map.insert(pair);
+            }
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * pairs.size());
+    }
+
+    // time ordered ingestion, hint at end lets every insert skip search from root
+    void BM_MapBuildSortedHinted(benchmark::State &state)
+    {
+        auto pairs = makeSortedPairs(state.range(0));
+        for (auto _ : state)
+        {
+            HeapMap map;
+            for (auto &pair : pairs)
+            {
+                map.insert(map.end(), pair);
+            }
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * pairs.size());
+    }
+
+    void BM_MapBuildSortedRange(benchmark::State &state)
+    {
+        auto pairs = makeSortedPairs(state.range(0));
+        for (auto _ : state)
+        {
+            HeapMap map(pairs.begin(), pairs.end());
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * pairs.size());
+    }
+
+    void BM_MapCopy(benchmark::State &state)
+    {
+        auto pairs = makeSortedPairs(state.range(0));
+        HeapMap source(pairs.begin(), pairs.end());
+        for (auto _ : state)
+        {
+            HeapMap map(source);
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * pairs.size());
+    }
+} // namespace
+
+BENCHMARK(BM_MapBuildSortedOneByOne)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_MapBuildSortedHinted)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_MapBuildSortedRange)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_MapCopy)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+namespace
+{
+    // range(1) is selectivity in per mille of map size
+    void BM_MapRangeScan(benchmark::State &state)
+    {
+        const int size = 1 << 20;
+        auto pairs = makeSortedPairs(size);
+        HeapMap map(pairs.begin(), pairs.end());
+        const int width = int(int64_t(size) * state.range(0) / 1000);
+        std::mt19937 gen{3};
+        std::uniform_int_distribution<int> dist(0, size - width);
+        size_t visited = 0;
+        for (auto _ : state)
+        {
+            auto low = dist(gen);
+            long sum = 0;
+            for (auto &[key, value] : map.range(low, low + width))
+            {
+                sum += value;
+                ++visited;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(visited);
+    }
+
+    // same scan done by walking from begin and filtering
+    void BM_MapRangeScanFromBegin(benchmark::State &state)
+    {
+        const int size = 1 << 20;
+        auto pairs = makeSortedPairs(size);
+        HeapMap map(pairs.begin(), pairs.end());
+        const int width = int(int64_t(size) * state.range(0) / 1000);
+        std::mt19937 gen{3};
+        std::uniform_int_distribution<int> dist(0, size - width);
+        size_t visited = 0;
+        for (auto _ : state)
+        {
+            auto low = dist(gen);
+            long sum = 0;
+            for (auto it = map.begin(); it != map.end() && it->first < low + width; ++it)
+            {
+                if (it->first >= low)
+                {
+                    sum += it->second;
+                    ++visited;
+                }
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(visited);
+    }
+} // namespace
+
+BENCHMARK(BM_MapRangeScan)->Arg(0)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK(BM_MapRangeScanFromBegin)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+
+namespace
+{
+    // map used as ordered work queue, take smallest, push new bigger one
+    void BM_MapWorkQueue(benchmark::State &state)
+    {
+        auto pairs = makeSortedPairs(state.range(0));
+        HeapMap map(pairs.begin(), pairs.end());
+        int next = int(pairs.size());
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(map.begin()->second);
+            map.popFront();
+            map.insert({next, next});
+            ++next;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+} // namespace
+
+BENCHMARK(BM_MapWorkQueue)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+namespace
+{
+    std::pair<HeapMap, HeapMap> makeUnionInputs(size_t size, size_t otherSize)
+    {
+        std::mt19937 gen(3);
+        HeapMap map, other;
+        while (map.size() < size)
+        {
+            auto key = int(gen() % (4 * (size + otherSize)));
+            map.insert({key, key});
+        }
+        while (other.size() < otherSize)
+        {
+            auto key = int(gen() % (4 * (size + otherSize)));
+            other.insert({key, key});
+        }
+        return {std::move(map), std::move(other)};
+    }
+
+    /**
+     * range(0) is size of target map, range(1) size of merged map, inputs are copied and results destroyed
+     * outside of timed region, setup dominates run time so iterations are fixed
+     */
+    template <class Operation> void runUnion(benchmark::State &state, Operation operation)
+    {
+        auto [source, otherSource] = makeUnionInputs(state.range(0), state.range(1));
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            auto map = std::make_unique<HeapMap>(source);
+            auto other = std::make_unique<HeapMap>(otherSource);
+            state.ResumeTiming();
+            operation(*map, *other);
+            benchmark::DoNotOptimize(map->size());
+            state.PauseTiming();
+            map.reset();
+            other.reset();
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * (state.range(0) + state.range(1)));
+    }
+
+    void BM_MapUnionMerge(benchmark::State &state)
+    {
+        runUnion(state, [](HeapMap &map, HeapMap &other) { map.merge(other); });
+    }
+
+    void BM_MapUnionWith(benchmark::State &state)
+    {
+        runUnion(state, [](HeapMap &map, HeapMap &other) { map.unionWith(std::move(other)); });
+    }
+
+    void BM_MapUnionWithParallel(benchmark::State &state)
+    {
+        runUnion(state, [](HeapMap &map, HeapMap &other) { map.unionWith(sd::parallel, std::move(other)); });
+    }
+
+    void unionSizes(benchmark::internal::Benchmark *benchmark)
+    {
+        benchmark->Args({1 << 20, 1 << 10})->Args({1 << 20, 1 << 16})->Args({1 << 20, 1 << 20});
+    }
+} // namespace
+
+BENCHMARK(BM_MapUnionMerge)->Apply(unionSizes)->Iterations(10)->UseRealTime();
+BENCHMARK(BM_MapUnionWith)->Apply(unionSizes)->Iterations(10)->UseRealTime();
+BENCHMARK(BM_MapUnionWithParallel)->Apply(unionSizes)->Iterations(10)->UseRealTime();
+
+namespace
+{
+    const int IntervalSpan = 1 << 30;
+    const int LongestInterval = 1 << 22;
+
+    // time ranges, mostly short with one percent of long ones
+    template <class TMap> TMap makeIntervals(size_t size)
+    {
+        std::mt19937 gen(11);
+        TMap map;
+        for (size_t i = 0; i < size; ++i)
+        {
+            auto low = int(gen() % IntervalSpan);
+            auto length = int(gen() % 100 ? gen() % 1024 : gen() % LongestInterval);
+            map.insert({{low, low + length}, int(i)});
+        }
+        return map;
+    }
+
+    /**
+     * range(0) is number of intervals, range(1) length of queried window
+     */
+    void BM_IntervalMapOverlap(benchmark::State &state)
+    {
+        auto map = makeIntervals<sd::IntervalMap<int, int>>(state.range(0));
+        std::mt19937 gen(5);
+        size_t found = 0;
+        for (auto _ : state)
+        {
+            auto low = int(gen() % IntervalSpan);
+            map.visitOverlapping(low, low + int(state.range(1)), [&](auto &) { ++found; });
+        }
+        state.counters["found"] = double(found) / state.iterations();
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // without augmentation all intervals starting up to longest interval before window have to be checked
+    void BM_MapOverlapScan(benchmark::State &state)
+    {
+        auto map = makeIntervals<sd::Map<sd::Interval<int>, int>>(state.range(0));
+        std::mt19937 gen(5);
+        size_t found = 0;
+        for (auto _ : state)
+        {
+            auto low = int(gen() % IntervalSpan);
+            auto high = low + int(state.range(1));
+            for (auto it = map.lowerBound({low - LongestInterval, 0}); it && it->first.low <= high; ++it)
+            {
+                found += it->first.high >= low;
+            }
+        }
+        state.counters["found"] = double(found) / state.iterations();
+        state.SetItemsProcessed(state.iterations());
+    }
+} // namespace
+
+BENCHMARK(BM_IntervalMapOverlap)->ArgsProduct({{1 << 16, 1 << 20}, {1, 1 << 16}});
+BENCHMARK(BM_MapOverlapScan)->ArgsProduct({{1 << 16, 1 << 20}, {1, 1 << 16}});
+
+namespace
+{
+    // built once and shared by all thread counts, building 10M entries takes longer than measured runs
+    const HeapMap &scalingMap()
+    {
+        static const HeapMap map = [] {
+            std::vector<std::pair<const int, int>> pairs;
+            for (int i = 0; i < 10'000'000; ++i)
+            {
+                pairs.emplace_back(i, i % 1000);
+            }
+            return HeapMap(sd::sortedUnique, pairs.begin(), pairs.end());
+        }();
+        return map;
+    }
+
+    void BM_MapIterateSum(benchmark::State &state)
+    {
+        auto &map = scalingMap();
+        for (auto _ : state)
+        {
+            long long sum = 0;
+            for (auto &[key, value] : map)
+            {
+                sum += value;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * map.size());
+    }
+
+    // range(0) is number of threads
+    void BM_MapParallelReduce(benchmark::State &state)
+    {
+        auto &map = scalingMap();
+        for (auto _ : state)
+        {
+            auto sum = map.parallelReduce(
+                0ll, [](auto &item) { return (long long)item.second; }, std::plus<>{}, size_t(state.range(0)));
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * map.size());
+    }
+
+    void BM_MapParallelForEach(benchmark::State &state)
+    {
+        auto &map = scalingMap();
+        for (auto _ : state)
+        {
+            std::atomic<long long> sum = 0;
+            map.parallelForEach(
+                [&](auto &item) {
+                    if (item.second == 999)
+                    {
+                        sum.fetch_add(1, std::memory_order_relaxed);
+                    }
+                },
+                size_t(state.range(0)));
+            benchmark::DoNotOptimize(sum.load());
+        }
+        state.SetItemsProcessed(state.iterations() * map.size());
+    }
+} // namespace
+
+BENCHMARK(BM_MapIterateSum)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_MapParallelReduce)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_MapParallelForEach)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond)->UseRealTime();
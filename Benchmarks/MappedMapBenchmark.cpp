@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Map.hpp"
+#include "MappedMap.hpp"
+
+namespace
+{
+    std::vector<uint64_t> makeKeys(size_t size)
+    {
+        std::vector<uint64_t> keys(size);
+        std::mt19937_64 gen(42);
+        for (auto &key : keys)
+        {
+            key = gen();
+        }
+        return keys;
+    }
+
+    sd::Map<uint64_t, uint64_t> makeMap(const std::vector<uint64_t> &keys)
+    {
+        sd::Map<uint64_t, uint64_t> map;
+        for (auto key : keys)
+        {
+            map.insert({key, key});
+        }
+        return map;
+    }
+
+    std::string snapshotPath(size_t size)
+    {
+        auto name = "MappedMapBenchmark_" + std::to_string(size) + ".snap";
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    // restart by inserting all elements again, as done without snapshot
+    void BM_SnapshotReinsert(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        for (auto _ : state)
+        {
+            auto map = makeMap(keys);
+            benchmark::DoNotOptimize(map.at(keys[0]));
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    void BM_SnapshotSave(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        auto map = makeMap(keys);
+        auto path = snapshotPath(keys.size());
+        for (auto _ : state)
+        {
+            map.saveSnapshot(path);
+        }
+        state.counters["file_bytes_per_entry"] = double(std::filesystem::file_size(path)) / keys.size();
+        std::filesystem::remove(path);
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    // open and first lookup, file is in page cache after first iteration
+    void BM_SnapshotOpen(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        auto path = snapshotPath(keys.size());
+        makeMap(keys).saveSnapshot(path);
+        for (auto _ : state)
+        {
+            auto mapped = sd::MappedMap<uint64_t, uint64_t>::open(path);
+            benchmark::DoNotOptimize(mapped.at(keys[0]));
+        }
+        std::filesystem::remove(path);
+    }
+
+    template <class TMap> TMap makeLookupMap(const std::vector<uint64_t> &keys, const std::string &path);
+
+    template <> sd::Map<uint64_t, uint64_t> makeLookupMap(const std::vector<uint64_t> &keys, const std::string &)
+    {
+        return makeMap(keys);
+    }
+
+    template <>
+    sd::MappedMap<uint64_t, uint64_t> makeLookupMap(const std::vector<uint64_t> &keys, const std::string &path)
+    {
+        makeMap(keys).saveSnapshot(path);
+        return sd::MappedMap<uint64_t, uint64_t>::open(path);
+    }
+
+    template <class TMap> void BM_SnapshotFind(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        auto path = snapshotPath(keys.size());
+        auto map = makeLookupMap<TMap>(keys, path);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{7});
+        for (auto _ : state)
+        {
+            for (auto key : keys)
+            {
+                benchmark::DoNotOptimize(map.at(key));
+            }
+        }
+        std::filesystem::remove(path);
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    template <class TMap> void BM_SnapshotIterate(benchmark::State &state)
+    {
+        auto keys = makeKeys(state.range(0));
+        auto path = snapshotPath(keys.size());
+        auto map = makeLookupMap<TMap>(keys, path);
+        for (auto _ : state)
+        {
+            uint64_t sum = 0;
+            for (auto it = map.begin(); it != map.end(); ++it)
+            {
+                sum += it->second;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        std::filesystem::remove(path);
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    using IntMap = sd::Map<uint64_t, uint64_t>;
+    using IntMappedMap = sd::MappedMap<uint64_t, uint64_t>;
+
+    void sizes(benchmark::internal::Benchmark *benchmark) { benchmark->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 22); }
+} // namespace
+
+BENCHMARK(BM_SnapshotReinsert)->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SnapshotSave)->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SnapshotOpen)->Apply(sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_SnapshotFind, IntMap)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_SnapshotFind, IntMappedMap)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_SnapshotIterate, IntMap)->Apply(sizes);
+BENCHMARK_TEMPLATE(BM_SnapshotIterate, IntMappedMap)->Apply(sizes);
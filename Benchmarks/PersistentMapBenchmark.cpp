@@ -0,0 +1,117 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+#include "AllocationCounter.hpp"
+#include "Map.hpp"
+#include "PersistentMap.hpp"
+
+namespace
+{
+    using Version = sd::PersistentMap<int, int>;
+
+    std::vector<int> makeRandomKeys(size_t size)
+    {
+        std::vector<int> keys(size);
+        std::mt19937 gen(42);
+        for (auto &key : keys)
+        {
+            key = int(gen() % size);
+        }
+        return keys;
+    }
+
+    Version makeVersion(size_t size)
+    {
+        Version version;
+        for (size_t i = 0; i < size; ++i)
+        {
+            version = version.insert({int(i), int(i)});
+        }
+        return version;
+    }
+
+    /**
+     * Every update makes new version while previous one is still held, like by reader, so its path copy
+     * stays alive. bytesPerUpdate is memory new version does not share with previous one
+     */
+    void BM_PersistentMapUpdate(benchmark::State &state)
+    {
+        auto keys = makeRandomKeys(state.range(0));
+        auto current = makeVersion(state.range(0));
+        // building by inserts allocates path copies too, so entry size is taken from one node map
+        auto bytesBefore = sd::bench::allocatedBytes();
+        auto single = Version().insert({0, 0});
+        auto bytesPerEntry = double(sd::bench::allocatedBytes() - bytesBefore);
+        benchmark::DoNotOptimize(single.size());
+        size_t i = 0;
+        size_t updateBytes = 0;
+        for (auto _ : state)
+        {
+            auto previous = current;
+            bytesBefore = sd::bench::allocatedBytes();
+            auto key = keys[i % keys.size()];
+            ++i;
+            current = previous.insertOrAssign(key, int(i));
+            updateBytes += sd::bench::allocatedBytes() - bytesBefore;
+        }
+        state.counters["bytesPerUpdate"] = double(updateBytes) / state.iterations();
+        state.counters["bytesPerEntry"] = bytesPerEntry;
+    }
+
+    // what readers needed before, writer copies whole map so readers can keep old one
+    void BM_MapCopyUpdate(benchmark::State &state)
+    {
+        auto keys = makeRandomKeys(state.range(0));
+        auto bytesBefore = sd::bench::allocatedBytes();
+        sd::Map<int, int> current;
+        for (int i = 0; i < int(state.range(0)); ++i)
+        {
+            current.insert({i, i});
+        }
+        auto bytesPerEntry = double(sd::bench::allocatedBytes() - bytesBefore) / state.range(0);
+        size_t i = 0;
+        size_t updateBytes = 0;
+        for (auto _ : state)
+        {
+            bytesBefore = sd::bench::allocatedBytes();
+            sd::Map<int, int> next(current);
+            auto key = keys[i % keys.size()];
+            ++i;
+            next.at(key) = int(i);
+            updateBytes += sd::bench::allocatedBytes() - bytesBefore;
+            current.swap(next);
+        }
+        state.counters["bytesPerUpdate"] = double(updateBytes) / state.iterations();
+        state.counters["bytesPerEntry"] = bytesPerEntry;
+    }
+
+    // reader side, taking snapshot of published version
+    void BM_AtomicPersistentMapLoad(benchmark::State &state)
+    {
+        sd::AtomicPersistentMap<int, int> published(makeVersion(state.range(0)));
+        for (auto _ : state)
+        {
+            auto snapshot = published.load();
+            benchmark::DoNotOptimize(snapshot.size());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_AtomicPersistentMapRead(benchmark::State &state)
+    {
+        sd::AtomicPersistentMap<int, int> published(makeVersion(state.range(0)));
+        int key = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(published.read([&](const Version &version) { return version.at(key); }));
+            key = (key + 1) % int(state.range(0));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+} // namespace
+
+BENCHMARK(BM_PersistentMapUpdate)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_MapCopyUpdate)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_AtomicPersistentMapLoad)->Arg(1 << 10);
+BENCHMARK(BM_AtomicPersistentMapRead)->Arg(1 << 10)->Arg(1 << 20);
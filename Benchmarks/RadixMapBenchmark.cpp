@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Map.hpp"
+#include "RadixMap.hpp"
+
+namespace
+{
+    std::vector<uint64_t> makeDenseKeys(size_t size)
+    {
+        std::vector<uint64_t> keys(size);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{42});
+        return keys;
+    }
+
+    std::vector<uint64_t> makeSparseKeys(size_t size)
+    {
+        std::vector<uint64_t> keys(size);
+        std::mt19937_64 gen(42);
+        for (auto &key : keys)
+        {
+            key = gen();
+        }
+        return keys;
+    }
+
+    // few hosts and long shared paths, like keys of url index
+    std::vector<std::string> makeUrlKeys(size_t size)
+    {
+        static const char *hosts[] = {"https://www.example.com/", "https://api.example.com/v2/users/",
+                                      "https://cdn.example.net/static/images/", "http://intranet.local/wiki/"};
+        std::vector<std::string> keys(size);
+        std::mt19937 gen(42);
+        for (size_t i = 0; i < size; ++i)
+        {
+            keys[i] = hosts[gen() % 4] + std::to_string(gen() % 1000) + "/item/" + std::to_string(i);
+        }
+        return keys;
+    }
+
+    template <class Key> std::vector<Key> makeKeys(size_t size, int kind);
+
+    template <> std::vector<uint64_t> makeKeys(size_t size, int kind)
+    {
+        return kind == 0 ? makeDenseKeys(size) : makeSparseKeys(size);
+    }
+
+    template <> std::vector<std::string> makeKeys(size_t size, int) { return makeUrlKeys(size); }
+
+    /**
+     * range(0) is map size, range(1) kind of integer keys (0 dense, 1 sparse), ignored for strings
+     */
+    template <class TMap, class Key> void BM_KeyIndexInsert(benchmark::State &state)
+    {
+        auto keys = makeKeys<Key>(state.range(0), int(state.range(1)));
+        for (auto _ : state)
+        {
+            TMap map;
+            for (auto &key : keys)
+            {
+                map.insert({key, 1});
+            }
+            benchmark::DoNotOptimize(map.size());
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    template <class TMap, class Key> void BM_KeyIndexFind(benchmark::State &state)
+    {
+        auto keys = makeKeys<Key>(state.range(0), int(state.range(1)));
+        TMap map;
+        for (auto &key : keys)
+        {
+            map.insert({key, 1});
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{7});
+        for (auto _ : state)
+        {
+            for (auto &key : keys)
+            {
+                benchmark::DoNotOptimize(map.at(key));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+
+    using IntMap = sd::Map<uint64_t, int>;
+    using IntRadixMap = sd::RadixMap<uint64_t, int>;
+    using UrlMap = sd::Map<std::string, int>;
+    using UrlRadixMap = sd::RadixMap<std::string, int>;
+
+    void intSizes(benchmark::internal::Benchmark *benchmark)
+    {
+        benchmark->ArgsProduct({{1 << 10, 1 << 16, 1 << 20}, {0, 1}});
+    }
+
+    void urlSizes(benchmark::internal::Benchmark *benchmark)
+    {
+        benchmark->ArgsProduct({{1 << 10, 1 << 16, 1 << 20}, {0}});
+    }
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_KeyIndexInsert, IntMap, uint64_t)->Apply(intSizes);
+BENCHMARK_TEMPLATE(BM_KeyIndexInsert, IntRadixMap, uint64_t)->Apply(intSizes);
+BENCHMARK_TEMPLATE(BM_KeyIndexFind, IntMap, uint64_t)->Apply(intSizes);
+BENCHMARK_TEMPLATE(BM_KeyIndexFind, IntRadixMap, uint64_t)->Apply(intSizes);
+BENCHMARK_TEMPLATE(BM_KeyIndexInsert, UrlMap, std::string)->Apply(urlSizes);
+BENCHMARK_TEMPLATE(BM_KeyIndexInsert, UrlRadixMap, std::string)->Apply(urlSizes);
+BENCHMARK_TEMPLATE(BM_KeyIndexFind, UrlMap, std::string)->Apply(urlSizes);
+BENCHMARK_TEMPLATE(BM_KeyIndexFind, UrlRadixMap, std::string)->Apply(urlSizes);
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+
+namespace sd::bench
+{
+    /**
+     * Number of global operator new calls made by current thread since program start
+     */
+    size_t allocationsCount();
+
+    /**
+     * Number of bytes requested through global operator new by current thread since program start
+     */
+    size_t allocatedBytes();
+} // namespace sd::bench
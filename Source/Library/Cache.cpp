@@ -38,13 +38,13 @@ namespace sd
         return true;
     }
 
-    const void *Cache::Get(const std::string &key) const
+    const void *Cache::Get(std::string_view key) const
     {
         auto item = GetItem(key);
         return item ? item->GetRawValue() : nullptr;
     }
 
-    const CacheItemBase *Cache::GetItem(const std::string &key) const
+    const CacheItemBase *Cache::GetItem(std::string_view key) const
     {
         if (auto data = GetData(key); data && data->item)
         {
@@ -53,7 +53,7 @@ namespace sd
         return nullptr;
     }
 
-    bool Cache::Remove(const std::string &key)
+    bool Cache::Remove(std::string_view key)
     {
         auto data = RemoveData(key);
         if (!data)
@@ -69,15 +69,15 @@ namespace sd
         return true;
     }
 
-    bool Cache::Contains(const std::string &key) const { return ContainsData(key); }
+    bool Cache::Contains(std::string_view key) const { return ContainsData(key); }
 
     size_t Cache::Count() const { return CountData(); }
 
-    Cache::Data *Cache::GetEditableData(const std::string &key) { return const_cast<Data *>(GetData(key)); }
+    Cache::Data *Cache::GetEditableData(std::string_view key) { return const_cast<Data *>(GetData(key)); }
 
     bool Cache::AddData(Cache::Data data) { return _items.insert({data.item->GetKey(), std::move(data)}).second; }
 
-    std::optional<Cache::Data> Cache::RemoveData(const std::string &key)
+    std::optional<Cache::Data> Cache::RemoveData(std::string_view key)
     {
         auto it = _items.find(key);
         if (it == _items.end())
@@ -89,7 +89,7 @@ namespace sd
         return std::move(data);
     }
 
-    const Cache::Data *Cache::GetData(const std::string &key) const
+    const Cache::Data *Cache::GetData(std::string_view key) const
     {
         if (auto it = _items.find(key); it != _items.end())
         {
@@ -98,7 +98,7 @@ namespace sd
         return nullptr;
     }
 
-    bool Cache::ContainsData(const std::string &key) const { return _items.contains(key); }
+    bool Cache::ContainsData(std::string_view key) const { return _items.contains(key); }
 
     size_t Cache::CountData() const { return _items.size(); }
 } // namespace sd
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include <stdexcept>
+#include <utility>
+
+#include "DetectOs.hpp"
+#include "MappedFile.hpp"
+
+#ifdef WINDOWS
+#include <windows.h>
+#endif
+
+#if defined(LINUX) || defined(APPLE)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sd
+{
+    namespace
+    {
+        [[noreturn]] void throwMapError(const std::string &path)
+        {
+            throw std::runtime_error("Cannot map file " + path);
+        }
+    } // namespace
+
+#ifdef WINDOWS
+    // view keeps mapping alive, so file and mapping handles are closed right away
+    MappedFile::MappedFile(const std::string &path)
+    {
+        auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throwMapError(path);
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            throwMapError(path);
+        }
+        auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping)
+        {
+            throwMapError(path);
+        }
+        auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view)
+        {
+            throwMapError(path);
+        }
+        _data = static_cast<const std::byte *>(view);
+        _size = size_t(size.QuadPart);
+    }
+
+    void MappedFile::close()
+    {
+        if (_data)
+        {
+            UnmapViewOfFile(_data);
+        }
+        _data = nullptr;
+        _size = 0;
+    }
+#endif
+
+#if defined(LINUX) || defined(APPLE)
+    // mapping stays valid after descriptor is closed
+    MappedFile::MappedFile(const std::string &path)
+    {
+        auto fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throwMapError(path);
+        }
+        struct stat status;
+        if (::fstat(fd, &status) != 0 || status.st_size == 0)
+        {
+            ::close(fd);
+            throwMapError(path);
+        }
+        auto data = ::mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            throwMapError(path);
+        }
+        _data = static_cast<const std::byte *>(data);
+        _size = size_t(status.st_size);
+    }
+
+    void MappedFile::close()
+    {
+        if (_data)
+        {
+            ::munmap(const_cast<std::byte *>(_data), _size);
+        }
+        _data = nullptr;
+        _size = 0;
+    }
+#endif
+
+    MappedFile::MappedFile(MappedFile &&other) { swap(other); }
+
+    MappedFile::~MappedFile() { close(); }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other)
+    {
+        if (this != &other)
+        {
+            close();
+            swap(other);
+        }
+        return *this;
+    }
+
+    void MappedFile::swap(MappedFile &other)
+    {
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+    }
+} // namespace sd
@@ -0,0 +1,828 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace sd
+{
+    /**
+     * Uninitialized storage for N values, only first count values (tracked by owner) are alive
+     */
+    template <class V, size_t N> class BTreeSlots
+    {
+      private:
+        alignas(V) std::byte _data[sizeof(V) * N];
+
+      public:
+        V *data() { return std::launder(reinterpret_cast<V *>(_data)); }
+
+        const V *data() const { return std::launder(reinterpret_cast<const V *>(_data)); }
+
+        V &operator[](size_t index) { return data()[index]; }
+
+        const V &operator[](size_t index) const { return data()[index]; }
+
+        template <class... Args> void construct(size_t index, Args &&...args)
+        {
+            std::construct_at(data() + index, std::forward<Args>(args)...);
+        }
+
+        void destroy(size_t index) { std::destroy_at(data() + index); }
+
+        void destroy(size_t from, size_t to) { std::destroy(data() + from, data() + to); }
+
+        /**
+         * Inserts value at index shifting alive values [index, count) one slot right. Values which cannot be
+         * assigned, like pairs with const key, are shifted by constructing them in next slot and destroying old one
+         */
+        template <class Arg> void insertAt(size_t index, size_t count, Arg &&value)
+        {
+            if (index == count)
+            {
+                construct(count, std::forward<Arg>(value));
+                return;
+            }
+            if constexpr (std::is_move_assignable_v<V>)
+            {
+                construct(count, std::move(data()[count - 1]));
+                std::move_backward(data() + index, data() + count - 1, data() + count);
+                data()[index] = std::forward<Arg>(value);
+            }
+            else
+            {
+                // built first, so throwing constructor leaves values in place
+                V inserted(std::forward<Arg>(value));
+                auto values = data();
+                for (auto i = count; i > index; --i)
+                {
+                    std::construct_at(values + i, std::move(values[i - 1]));
+                    std::destroy_at(values + i - 1);
+                }
+                construct(index, std::move(inserted));
+            }
+        }
+
+        // erases value at index shifting alive values (index, count) one slot left
+        void eraseAt(size_t index, size_t count)
+        {
+            if constexpr (std::is_move_assignable_v<V>)
+            {
+                std::move(data() + index + 1, data() + count, data() + index);
+                destroy(count - 1);
+            }
+            else
+            {
+                auto values = data();
+                std::destroy_at(values + index);
+                for (auto i = index + 1; i < count; ++i)
+                {
+                    std::construct_at(values + i - 1, std::move(values[i]));
+                    std::destroy_at(values + i);
+                }
+            }
+        }
+
+        // moves n alive values starting at from into uninitialized slots of destination starting at to
+        void moveTo(size_t from, size_t n, BTreeSlots &destination, size_t to)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                destination.construct(to + i, std::move(data()[from + i]));
+            }
+            destroy(from, from + n);
+        }
+    };
+
+    struct BTreeNode
+    {
+        size_t count = 0;
+        bool leaf;
+
+        explicit BTreeNode(bool isLeaf) : leaf(isLeaf) {}
+    };
+
+    template <class K, class T, size_t Capacity> struct BTreeLeaf : BTreeNode
+    {
+        using Pair = std::pair<const K, T>;
+
+        // values are shifted inside node by constructing them again, key is never assigned
+        BTreeSlots<Pair, Capacity> slots;
+        BTreeLeaf *prev = nullptr;
+        BTreeLeaf *next = nullptr;
+
+        BTreeLeaf() : BTreeNode(true) {}
+        ~BTreeLeaf() { slots.destroy(0, count); }
+
+        const K &getKey(size_t index) const { return slots[index].first; }
+
+        Pair &getPair(size_t index) { return slots[index]; }
+
+        const Pair &getPair(size_t index) const { return slots[index]; }
+    };
+
+    template <class K, size_t Capacity> struct BTreeInner : BTreeNode
+    {
+        BTreeSlots<K, Capacity> keys;
+        BTreeNode *children[Capacity + 1];
+
+        BTreeInner() : BTreeNode(false) {}
+        ~BTreeInner() { keys.destroy(0, count); }
+    };
+
+    template <class Leaf, bool C, bool R> // C= const, R = Reverse
+    class BTreeMapIterator
+    {
+      public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename Leaf::Pair;
+        using difference_type = std::ptrdiff_t;
+        using LeafPtr = std::conditional_t<C, const Leaf *, Leaf *>;
+        using Pair = std::conditional_t<C, const typename Leaf::Pair, typename Leaf::Pair>;
+        using PairRef = Pair &;
+        using PairPtr = Pair *;
+
+      protected:
+        LeafPtr _leaf = nullptr;
+        size_t _index = 0;
+
+      public:
+        BTreeMapIterator(LeafPtr leaf = nullptr, size_t index = 0) : _leaf(leaf), _index(index) {}
+        BTreeMapIterator(const BTreeMapIterator &rawIterator) = default;
+        ~BTreeMapIterator() = default;
+
+        BTreeMapIterator &operator=(const BTreeMapIterator &rawIterator) = default;
+
+        operator bool() const { return _leaf; }
+
+        bool operator==(const BTreeMapIterator &rawIterator) const
+        {
+            return _leaf == rawIterator._leaf && _index == rawIterator._index;
+        }
+        bool operator!=(const BTreeMapIterator &rawIterator) const { return !(*this == rawIterator); }
+
+        BTreeMapIterator &operator++()
+        {
+            if constexpr (R)
+            {
+                previous();
+            }
+            else
+            {
+                next();
+            }
+            return *this;
+        }
+
+        BTreeMapIterator &operator--()
+        {
+            if constexpr (R)
+            {
+                next();
+            }
+            else
+            {
+                previous();
+            }
+            return *this;
+        }
+
+        BTreeMapIterator operator++(int)
+        {
+            auto temp(*this);
+            ++*this;
+            return temp;
+        }
+
+        BTreeMapIterator operator--(int)
+        {
+            auto temp(*this);
+            --*this;
+            return temp;
+        }
+
+        PairRef operator*() const { return _leaf->getPair(_index); }
+
+        PairPtr operator->() const { return &_leaf->getPair(_index); }
+
+      private:
+        void next()
+        {
+            if (++_index == _leaf->count)
+            {
+                _leaf = _leaf->next;
+                _index = 0;
+            }
+        }
+
+        void previous()
+        {
+            if (_index == 0)
+            {
+                _leaf = _leaf->prev;
+                _index = _leaf ? _leaf->count - 1 : 0;
+            }
+            else
+            {
+                --_index;
+            }
+        }
+    };
+
+    /**
+     * Ordered map stored as B+tree, nodes hold many keys (about NodeBytes of data), values live only in leafs
+     * and leafs are linked together, so lookups touch few cache lines and in order iteration is sequential
+     */
+    template <class K, class T, class Compare = std::less<K>, size_t NodeBytes = 512> class BTreeMap
+    {
+      public:
+        static constexpr size_t LeafCapacity = std::clamp<size_t>(NodeBytes / sizeof(std::pair<K, T>), 4, 1024);
+        static constexpr size_t InnerCapacity =
+            std::clamp<size_t>(NodeBytes / (sizeof(K) + sizeof(BTreeNode *)), 4, 1024);
+
+      private:
+        using Leaf = BTreeLeaf<K, T, LeafCapacity>;
+        using Inner = BTreeInner<K, InnerCapacity>;
+        using Pair = std::pair<const K, T>;
+
+        static constexpr size_t LeafMinimum = LeafCapacity / 2;
+        static constexpr size_t InnerMinimum = (InnerCapacity - 1) / 2;
+        static constexpr size_t MaxDepth = 64;
+
+        struct PathEntry
+        {
+            Inner *node;
+            size_t index;
+        };
+
+        BTreeNode *_root = nullptr;
+        Leaf *_first = nullptr;
+        Leaf *_last = nullptr;
+        size_t _size = 0;
+        [[no_unique_address]] Compare _compare;
+
+      public:
+        using Iterator = BTreeMapIterator<Leaf, false, false>;
+        using ConstIterator = BTreeMapIterator<Leaf, true, false>;
+
+        using ReverseIterator = BTreeMapIterator<Leaf, false, true>;
+        using ConstReverseIterator = BTreeMapIterator<Leaf, true, true>;
+
+        // Constructors
+        BTreeMap() = default;
+
+        explicit BTreeMap(const Compare &compare) : _compare(compare) {}
+
+        template <class InputIt> BTreeMap(InputIt first, InputIt last) { insert(first, last); }
+
+        BTreeMap(const BTreeMap &other) : _compare(other._compare) { insert(other.begin(), other.end()); }
+
+        BTreeMap(BTreeMap &&other) { swap(other); }
+
+        BTreeMap(std::initializer_list<Pair> init) { insert(init); }
+
+        ~BTreeMap() { clear(); }
+
+        // Assign
+        BTreeMap &operator=(const BTreeMap &other)
+        {
+            if (this != &other)
+            {
+                clear();
+                _compare = other._compare;
+                insert(other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        BTreeMap &operator=(BTreeMap &&other)
+        {
+            if (this != &other)
+            {
+                clear();
+                swap(other);
+            }
+            return *this;
+        }
+
+        BTreeMap &operator=(std::initializer_list<Pair> ilist)
+        {
+            clear();
+            insert(ilist);
+            return *this;
+        }
+
+        // Element access
+        T &at(const K &key)
+        {
+            auto [leaf, index] = findPosition(key);
+            assertPosition(leaf);
+            return leaf->getPair(index).second;
+        }
+
+        const T &at(const K &key) const
+        {
+            auto [leaf, index] = findPosition(key);
+            assertPosition(leaf);
+            return leaf->getPair(index).second;
+        }
+
+        T &operator[](const K &key) { return at(key); }
+
+        const T &operator[](const K &key) const { return at(key); }
+
+        // Modifiers
+        std::pair<Iterator, bool> insert(const Pair &value) { return insertValue(value); }
+        std::pair<Iterator, bool> insert(Pair &&value) { return insertValue(std::move(value)); }
+
+        template <class InputIt> void insert(InputIt first, InputIt last)
+        {
+            for (auto it = first; it != last; ++it)
+            {
+                insertValue(*it);
+            }
+        }
+
+        void insert(const std::initializer_list<Pair> &ilist) { insert(ilist.begin(), ilist.end()); }
+
+        void remove(const K &key) { removeKey(key); }
+
+        void swap(BTreeMap &other)
+        {
+            std::swap(_root, other._root);
+            std::swap(_first, other._first);
+            std::swap(_last, other._last);
+            std::swap(_size, other._size);
+            std::swap(_compare, other._compare);
+        }
+
+        void clear()
+        {
+            deleteSubtree(_root);
+            _root = nullptr;
+            _first = nullptr;
+            _last = nullptr;
+            _size = 0;
+        }
+
+        // LookUp
+        Iterator find(const K &key)
+        {
+            auto [leaf, index] = findPosition(key);
+            return Iterator{leaf, index};
+        }
+
+        ConstIterator find(const K &key) const
+        {
+            auto [leaf, index] = findPosition(key);
+            return ConstIterator{leaf, index};
+        }
+
+        bool contains(const K &key) const { return findPosition(key).first; }
+
+        Iterator lowerBound(const K &key)
+        {
+            auto [leaf, index] = lowerBoundPosition(key);
+            return Iterator{leaf, index};
+        }
+
+        ConstIterator lowerBound(const K &key) const
+        {
+            auto [leaf, index] = lowerBoundPosition(key);
+            return ConstIterator{leaf, index};
+        }
+
+        Iterator upperBound(const K &key)
+        {
+            auto it = lowerBound(key);
+            return it && !_compare(key, it->first) ? ++it : it;
+        }
+
+        ConstIterator upperBound(const K &key) const
+        {
+            auto it = lowerBound(key);
+            return it && !_compare(key, it->first) ? ++it : it;
+        }
+
+        // Capacity
+        size_t size() const { return _size; }
+
+        bool empty() const { return size() == 0; }
+
+        // Iterators
+        Iterator begin() { return Iterator{_first, 0}; }
+        Iterator end() { return Iterator{}; }
+
+        ConstIterator begin() const { return ConstIterator{_first, 0}; }
+        ConstIterator end() const { return ConstIterator{}; }
+
+        ConstIterator cBegin() const { return ConstIterator{_first, 0}; }
+        ConstIterator cEnd() const { return ConstIterator{}; }
+
+        ReverseIterator rBegin() { return ReverseIterator{_last, _last ? _last->count - 1 : 0}; }
+        ReverseIterator rEnd() { return ReverseIterator{}; }
+
+        ConstReverseIterator rBegin() const { return ConstReverseIterator{_last, _last ? _last->count - 1 : 0}; }
+        ConstReverseIterator rEnd() const { return ConstReverseIterator{}; }
+
+        ConstReverseIterator crBegin() const { return rBegin(); }
+        ConstReverseIterator crEnd() const { return ConstReverseIterator{}; }
+
+      private:
+        static Leaf *asLeaf(BTreeNode *node) { return static_cast<Leaf *>(node); }
+
+        static Inner *asInner(BTreeNode *node) { return static_cast<Inner *>(node); }
+
+        // index of child which can contain key, number of separators not greater than key
+        size_t childIndex(const Inner *inner, const K &key) const
+        {
+            return searchNode(inner->keys.data(), inner->count, [&](const K &separator) {
+                return !_compare(key, separator);
+            });
+        }
+
+        size_t leafIndex(const Leaf *leaf, const K &key) const
+        {
+            return searchNode(leaf->slots.data(), leaf->count,
+                              [&](const auto &slot) { return _compare(slot.first, key); });
+        }
+
+        /**
+         * Number of leading values for which isBefore holds, values are partitioned by it. Cheap arithmetic keys
+         * are counted with plain scan over whole node, it vectorizes and loads all node cache lines in parallel,
+         * other keys use binary search which only selects next base, so compiler can use conditional moves
+         */
+        template <class V, class Predicate> static size_t searchNode(const V *values, size_t count, Predicate isBefore)
+        {
+            if constexpr (std::is_arithmetic_v<K>)
+            {
+                size_t before = 0;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    before += isBefore(values[i]);
+                }
+                return before;
+            }
+            else
+            {
+                if (count == 0)
+                {
+                    return 0;
+                }
+                auto base = values;
+                while (count > 1)
+                {
+                    auto half = count / 2;
+                    base = isBefore(base[half - 1]) ? base + half : base;
+                    count -= half;
+                }
+                return base - values + isBefore(*base);
+            }
+        }
+
+        Leaf *findLeaf(const K &key) const
+        {
+            auto node = _root;
+            while (!node->leaf)
+            {
+                auto inner = asInner(node);
+                node = inner->children[childIndex(inner, key)];
+            }
+            return asLeaf(node);
+        }
+
+        std::pair<Leaf *, size_t> lowerBoundPosition(const K &key) const
+        {
+            if (!_root)
+            {
+                return {nullptr, 0};
+            }
+            auto leaf = findLeaf(key);
+            auto index = leafIndex(leaf, key);
+            if (index == leaf->count)
+            {
+                return {leaf->next, 0};
+            }
+            return {leaf, index};
+        }
+
+        std::pair<Leaf *, size_t> findPosition(const K &key) const
+        {
+            if (!_root)
+            {
+                return {nullptr, 0};
+            }
+            auto leaf = findLeaf(key);
+            auto index = leafIndex(leaf, key);
+            if (index == leaf->count || _compare(key, leaf->getKey(index)))
+            {
+                return {nullptr, 0};
+            }
+            return {leaf, index};
+        }
+
+        template <class Arg> std::pair<Iterator, bool> insertValue(Arg &&value)
+        {
+            if (!_root)
+            {
+                _root = _first = _last = new Leaf;
+            }
+            const K &key = value.first;
+            PathEntry path[MaxDepth];
+            size_t depth = 0;
+            auto node = _root;
+            while (!node->leaf)
+            {
+                auto inner = asInner(node);
+                auto index = childIndex(inner, key);
+                path[depth++] = {inner, index};
+                node = inner->children[index];
+            }
+            auto leaf = asLeaf(node);
+            auto index = leafIndex(leaf, key);
+            if (index < leaf->count && !_compare(key, leaf->getKey(index)))
+            {
+                return {Iterator{leaf, index}, false};
+            }
+            if (leaf->count == LeafCapacity)
+            {
+                auto right = splitLeaf(leaf);
+                insertSeparator(path, depth, K{right->getKey(0)}, right);
+                if (index > leaf->count)
+                {
+                    index -= leaf->count;
+                    leaf = right;
+                }
+            }
+            leaf->slots.insertAt(index, leaf->count, std::forward<Arg>(value));
+            ++leaf->count;
+            ++_size;
+            return {Iterator{leaf, index}, true};
+        }
+
+        Leaf *splitLeaf(Leaf *leaf)
+        {
+            auto right = new Leaf;
+            auto keep = leaf->count / 2;
+            leaf->slots.moveTo(keep, leaf->count - keep, right->slots, 0);
+            right->count = leaf->count - keep;
+            leaf->count = keep;
+
+            right->next = leaf->next;
+            right->prev = leaf;
+            if (leaf->next)
+            {
+                leaf->next->prev = right;
+            }
+            else
+            {
+                _last = right;
+            }
+            leaf->next = right;
+            return right;
+        }
+
+        void insertSeparator(PathEntry *path, size_t depth, K separator, BTreeNode *right)
+        {
+            while (depth > 0)
+            {
+                auto [inner, index] = path[--depth];
+                if (inner->count < InnerCapacity)
+                {
+                    insertIntoInner(inner, index, std::move(separator), right);
+                    return;
+                }
+                auto middle = inner->count / 2;
+                auto newRight = new Inner;
+                K upKey = std::move(inner->keys[middle]);
+                inner->keys.moveTo(middle + 1, inner->count - middle - 1, newRight->keys, 0);
+                std::copy(inner->children + middle + 1, inner->children + inner->count + 1, newRight->children);
+                newRight->count = inner->count - middle - 1;
+                inner->keys.destroy(middle);
+                inner->count = middle;
+
+                if (index <= middle)
+                {
+                    insertIntoInner(inner, index, std::move(separator), right);
+                }
+                else
+                {
+                    insertIntoInner(newRight, index - middle - 1, std::move(separator), right);
+                }
+                separator = std::move(upKey);
+                right = newRight;
+            }
+            auto newRoot = new Inner;
+            newRoot->keys.construct(0, std::move(separator));
+            newRoot->children[0] = _root;
+            newRoot->children[1] = right;
+            newRoot->count = 1;
+            _root = newRoot;
+        }
+
+        // separator goes at index, right child just after child at index
+        void insertIntoInner(Inner *inner, size_t index, K &&separator, BTreeNode *right)
+        {
+            inner->keys.insertAt(index, inner->count, std::move(separator));
+            std::copy_backward(inner->children + index + 1, inner->children + inner->count + 1,
+                               inner->children + inner->count + 2);
+            inner->children[index + 1] = right;
+            ++inner->count;
+        }
+
+        void removeFromInner(Inner *inner, size_t keyIndex, size_t childIndex)
+        {
+            inner->keys.eraseAt(keyIndex, inner->count);
+            std::copy(inner->children + childIndex + 1, inner->children + inner->count + 1,
+                      inner->children + childIndex);
+            --inner->count;
+        }
+
+        void removeKey(const K &key)
+        {
+            assertPosition(_root);
+            PathEntry path[MaxDepth];
+            size_t depth = 0;
+            auto node = _root;
+            while (!node->leaf)
+            {
+                auto inner = asInner(node);
+                auto index = childIndex(inner, key);
+                path[depth++] = {inner, index};
+                node = inner->children[index];
+            }
+            auto leaf = asLeaf(node);
+            auto index = leafIndex(leaf, key);
+            if (index == leaf->count || _compare(key, leaf->getKey(index)))
+            {
+                assertPosition(nullptr);
+            }
+
+            leaf->slots.eraseAt(index, leaf->count);
+            --leaf->count;
+            --_size;
+            if (depth == 0)
+            {
+                if (leaf->count == 0)
+                {
+                    clear();
+                }
+                return;
+            }
+            if (leaf->count < LeafMinimum)
+            {
+                rebalanceLeaf(path, depth, leaf);
+            }
+        }
+
+        void rebalanceLeaf(PathEntry *path, size_t depth, Leaf *leaf)
+        {
+            auto [parent, index] = path[depth - 1];
+            auto left = index > 0 ? asLeaf(parent->children[index - 1]) : nullptr;
+            auto right = index < parent->count ? asLeaf(parent->children[index + 1]) : nullptr;
+
+            if (left && left->count > LeafMinimum)
+            {
+                leaf->slots.insertAt(0, leaf->count, std::move(left->slots[left->count - 1]));
+                left->slots.destroy(--left->count);
+                ++leaf->count;
+                parent->keys[index - 1] = leaf->getKey(0);
+                return;
+            }
+            if (right && right->count > LeafMinimum)
+            {
+                leaf->slots.construct(leaf->count++, std::move(right->slots[0]));
+                right->slots.eraseAt(0, right->count--);
+                parent->keys[index] = right->getKey(0);
+                return;
+            }
+            if (left)
+            {
+                mergeLeafs(left, leaf);
+                removeFromInner(parent, index - 1, index);
+            }
+            else
+            {
+                mergeLeafs(leaf, right);
+                removeFromInner(parent, index, index + 1);
+            }
+            rebalanceInner(path, depth - 1);
+        }
+
+        // moves all values of right into left and deletes right
+        void mergeLeafs(Leaf *left, Leaf *right)
+        {
+            right->slots.moveTo(0, right->count, left->slots, left->count);
+            left->count += right->count;
+            right->count = 0;
+
+            left->next = right->next;
+            if (right->next)
+            {
+                right->next->prev = left;
+            }
+            else
+            {
+                _last = left;
+            }
+            delete right;
+        }
+
+        void rebalanceInner(PathEntry *path, size_t depth)
+        {
+            auto node = path[depth].node;
+            if (depth == 0)
+            {
+                if (node->count == 0)
+                {
+                    _root = node->children[0];
+                    delete node;
+                }
+                return;
+            }
+            if (node->count >= InnerMinimum)
+            {
+                return;
+            }
+            auto [parent, index] = path[depth - 1];
+            auto left = index > 0 ? asInner(parent->children[index - 1]) : nullptr;
+            auto right = index < parent->count ? asInner(parent->children[index + 1]) : nullptr;
+
+            if (left && left->count > InnerMinimum)
+            {
+                node->keys.insertAt(0, node->count, std::move(parent->keys[index - 1]));
+                std::copy_backward(node->children, node->children + node->count + 1,
+                                   node->children + node->count + 2);
+                node->children[0] = left->children[left->count];
+                ++node->count;
+                parent->keys[index - 1] = std::move(left->keys[left->count - 1]);
+                left->keys.destroy(--left->count);
+                return;
+            }
+            if (right && right->count > InnerMinimum)
+            {
+                node->keys.construct(node->count, std::move(parent->keys[index]));
+                node->children[node->count + 1] = right->children[0];
+                ++node->count;
+                parent->keys[index] = std::move(right->keys[0]);
+                removeFromInner(right, 0, 0);
+                return;
+            }
+            if (left)
+            {
+                mergeInners(left, std::move(parent->keys[index - 1]), node);
+                removeFromInner(parent, index - 1, index);
+            }
+            else
+            {
+                mergeInners(node, std::move(parent->keys[index]), right);
+                removeFromInner(parent, index, index + 1);
+            }
+            rebalanceInner(path, depth - 1);
+        }
+
+        // moves separator and all keys and children of right into left and deletes right
+        void mergeInners(Inner *left, K &&separator, Inner *right)
+        {
+            left->keys.construct(left->count, std::move(separator));
+            right->keys.moveTo(0, right->count, left->keys, left->count + 1);
+            std::copy(right->children, right->children + right->count + 1, left->children + left->count + 1);
+            left->count += right->count + 1;
+            right->count = 0;
+            delete right;
+        }
+
+        void deleteSubtree(BTreeNode *node)
+        {
+            if (!node)
+            {
+                return;
+            }
+            if (node->leaf)
+            {
+                delete asLeaf(node);
+                return;
+            }
+            auto inner = asInner(node);
+            for (size_t i = 0; i <= inner->count; ++i)
+            {
+                deleteSubtree(inner->children[i]);
+            }
+            delete inner;
+        }
+
+        void assertPosition(const void *ptr) const
+        {
+            if (!ptr)
+            {
+                throw std::out_of_range("Item was not found");
+            }
+        }
+    };
+} // namespace sd
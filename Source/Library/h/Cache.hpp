@@ -4,6 +4,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <unordered_map>
 
@@ -116,13 +117,13 @@ namespace sd
 
         virtual bool Set(CacheItemBase::UPtr item, ICachePolicy::UPtr policy = nullptr) = 0;
 
-        virtual const void *Get(const std::string &key) const = 0;
+        virtual const void *Get(std::string_view key) const = 0;
 
-        virtual const CacheItemBase *GetItem(const std::string &key) const = 0;
+        virtual const CacheItemBase *GetItem(std::string_view key) const = 0;
 
-        virtual bool Remove(const std::string &key) = 0;
+        virtual bool Remove(std::string_view key) = 0;
 
-        virtual bool Contains(const std::string &key) const = 0;
+        virtual bool Contains(std::string_view key) const = 0;
 
         virtual size_t Count() const = 0;
 
@@ -138,7 +139,15 @@ namespace sd
             ICachePolicy::UPtr policy;
         };
 
-        std::unordered_map<std::string, Data> _items;
+        // transparent hash, lets lookups use std::string_view without building temporary std::string
+        struct KeyHash
+        {
+            using is_transparent = void;
+
+            size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+        };
+
+        std::unordered_map<std::string, Data, KeyHash, std::equal_to<>> _items;
 
       public:
         Cache() = default;
@@ -178,38 +187,38 @@ namespace sd
 
         bool Set(CacheItemBase::UPtr item, ICachePolicy::UPtr policy = nullptr) final;
 
-        template <class TValue> const TValue *Get(const std::string &key) const
+        template <class TValue> const TValue *Get(std::string_view key) const
         {
             auto item = GetItem(key);
             return item ? item->GetValueAs<TValue>() : nullptr;
         }
 
-        const void *Get(const std::string &key) const final;
+        const void *Get(std::string_view key) const final;
 
-        template <class TValue> const CacheItem<TValue> *GetItem(const std::string &key) const
+        template <class TValue> const CacheItem<TValue> *GetItem(std::string_view key) const
         {
             auto item = GetItem(key);
             return item ? item->Upcast<TValue>() : nullptr;
         }
 
-        const CacheItemBase *GetItem(const std::string &key) const final;
+        const CacheItemBase *GetItem(std::string_view key) const final;
 
-        bool Remove(const std::string &key) final;
+        bool Remove(std::string_view key) final;
 
-        bool Contains(const std::string &key) const final;
+        bool Contains(std::string_view key) const final;
 
         size_t Count() const final;
 
       private:
         bool AddData(Data data);
 
-        Data *GetEditableData(const std::string &key);
+        Data *GetEditableData(std::string_view key);
 
-        const Data *GetData(const std::string &key) const;
+        const Data *GetData(std::string_view key) const;
 
-        std::optional<Cache::Data> RemoveData(const std::string &key);
+        std::optional<Cache::Data> RemoveData(std::string_view key);
 
-        bool ContainsData(const std::string &key) const;
+        bool ContainsData(std::string_view key) const;
 
         size_t CountData() const;
     };
@@ -240,19 +249,19 @@ namespace sd
             return _cache.Set<TValue>(BuildKey<TValue>(key), std::move(value), std::move(policy));
         }
 
-        template <class TValue> const TValue *Get(const std::string &key) const
+        template <class TValue> const TValue *Get(std::string_view key) const
         {
             return _cache.Get<TValue>(BuildKey<TValue>(key));
         }
 
-        template <class TValue> const CacheItem<TValue> *GetItem(const std::string &key) const
+        template <class TValue> const CacheItem<TValue> *GetItem(std::string_view key) const
         {
             return _cache.GetItem<TValue>(BuildKey<TValue>(key));
         }
 
-        template <class TValue> bool Remove(const std::string &key) { return _cache.Remove(BuildKey<TValue>(key)); }
+        template <class TValue> bool Remove(std::string_view key) { return _cache.Remove(BuildKey<TValue>(key)); }
 
-        template <class TValue> bool Contains(const std::string &key) const
+        template <class TValue> bool Contains(std::string_view key) const
         {
             return _cache.Contains(BuildKey<TValue>(key));
         }
@@ -260,10 +269,12 @@ namespace sd
         size_t Count() const { return _cache.Count(); }
 
       private:
-        template <class TValue> std::string BuildKey(const std::string &key) const
+        template <class TValue> std::string BuildKey(std::string_view key) const
         {
             std::string name = typeid(TValue).name();
-            return name + _separator + key;
+            name += _separator;
+            name += key;
+            return name;
         }
     };
 } // namespace sd
\ No newline at end of file
@@ -0,0 +1,593 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "EpochReclaimer.hpp"
+#include "Map.hpp"
+
+namespace sd
+{
+    /**
+     * Minimal test and test-and-set lock, nodes are locked only for few stores so spinning is cheaper than mutex
+     */
+    class SpinLock
+    {
+      private:
+        std::atomic<bool> _locked{false};
+
+      public:
+        void lock()
+        {
+            while (_locked.exchange(true, std::memory_order_acquire))
+            {
+                while (_locked.load(std::memory_order_relaxed))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        void unlock() { _locked.store(false, std::memory_order_release); }
+    };
+
+    template <class Node> class ConcurrentMapNodeLinks
+    {
+      public:
+        using Link = std::atomic<Node *>;
+
+      private:
+        // links live in same allocation just after node
+        Link *_next;
+        int _topLevel;
+        std::atomic<bool> _marked{false};
+        std::atomic<bool> _fullyLinked{false};
+        SpinLock _lock;
+
+      public:
+        ConcurrentMapNodeLinks(Link *next, int topLevel) : _next(next), _topLevel(topLevel) {}
+
+        Link &next(int level) { return _next[level]; }
+
+        const Link &next(int level) const { return _next[level]; }
+
+        int getTopLevel() const { return _topLevel; }
+
+        // marked node is logically removed, it is unlinked afterwards
+        bool isMarked() const { return _marked.load(std::memory_order_acquire); }
+
+        void setMarked() { _marked.store(true, std::memory_order_release); }
+
+        // node is visible for lookups only when it is linked on all its levels
+        bool isFullyLinked() const { return _fullyLinked.load(std::memory_order_acquire); }
+
+        void setFullyLinked() { _fullyLinked.store(true, std::memory_order_release); }
+
+        void lock() { _lock.lock(); }
+
+        void unlock() { _lock.unlock(); }
+    };
+
+    template <class K, class T> class ConcurrentMapNode : public ConcurrentMapNodeLinks<ConcurrentMapNode<K, T>>
+    {
+      public:
+        using Links = ConcurrentMapNodeLinks<ConcurrentMapNode<K, T>>;
+        using Pair = std::pair<const K, T>;
+
+      private:
+        Pair _keyItem;
+
+      public:
+        template <class... Args>
+        ConcurrentMapNode(typename Links::Link *next, int topLevel, Args &&...args)
+            : Links(next, topLevel), _keyItem(std::forward<Args>(args)...)
+        {
+        }
+
+        const K &getKey() const { return _keyItem.first; }
+
+        const T &getItem() const { return _keyItem.second; }
+
+        const Pair &getPair() const { return _keyItem; }
+    };
+
+    /**
+     * Forward iterator over live elements, it keeps reclaimer epoch pinned, so nodes it walks through
+     * stay allocated even when other threads remove them. Long lived iterators delay freeing of removed nodes
+     */
+    template <class Node> class ConcurrentMapIterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename Node::Pair;
+        using difference_type = std::ptrdiff_t;
+        using PairRef = const typename Node::Pair &;
+        using PairPtr = const typename Node::Pair *;
+
+      private:
+        const Node *_ptr = nullptr;
+        EpochReclaimer *_reclaimer = nullptr;
+        EpochReclaimer::Pin _pin{};
+
+      public:
+        ConcurrentMapIterator() = default;
+
+        // takes over pin, it is released by iterator
+        ConcurrentMapIterator(EpochReclaimer *reclaimer, EpochReclaimer::Pin pin, const Node *ptr)
+            : _ptr(ptr), _reclaimer(reclaimer), _pin(pin)
+        {
+            skipRemoved();
+        }
+
+        ConcurrentMapIterator(const ConcurrentMapIterator &other)
+            : _ptr(other._ptr), _reclaimer(other._reclaimer), _pin(other._pin)
+        {
+            if (_reclaimer)
+            {
+                _reclaimer->repin(_pin);
+            }
+        }
+
+        ~ConcurrentMapIterator()
+        {
+            if (_reclaimer)
+            {
+                _reclaimer->leave(_pin);
+            }
+        }
+
+        ConcurrentMapIterator &operator=(ConcurrentMapIterator other)
+        {
+            std::swap(_ptr, other._ptr);
+            std::swap(_reclaimer, other._reclaimer);
+            std::swap(_pin, other._pin);
+            return *this;
+        }
+
+        operator bool() const { return _ptr; }
+
+        bool operator==(const ConcurrentMapIterator &other) const { return _ptr == other._ptr; }
+        bool operator!=(const ConcurrentMapIterator &other) const { return _ptr != other._ptr; }
+
+        ConcurrentMapIterator &operator++()
+        {
+            _ptr = _ptr->next(0).load(std::memory_order_acquire);
+            skipRemoved();
+            return *this;
+        }
+
+        ConcurrentMapIterator operator++(int)
+        {
+            auto temp(*this);
+            ++*this;
+            return temp;
+        }
+
+        PairRef operator*() const { return _ptr->getPair(); }
+
+        PairPtr operator->() const { return &_ptr->getPair(); }
+
+      private:
+        void skipRemoved()
+        {
+            while (_ptr && (_ptr->isMarked() || !_ptr->isFullyLinked()))
+            {
+                _ptr = _ptr->next(0).load(std::memory_order_acquire);
+            }
+        }
+    };
+
+    /**
+     * Elements of concurrent map from begin iterator up to first key not less than high. End is checked by key,
+     * node at which iteration would stop could be removed by other thread, so it cannot be used as end iterator
+     */
+    template <class Iterator, class K, class Compare> class ConcurrentMapRange
+    {
+      private:
+        Iterator _begin;
+        K _high;
+        [[no_unique_address]] Compare _compare;
+
+      public:
+        struct Sentinel
+        {
+            const ConcurrentMapRange *range;
+        };
+
+        ConcurrentMapRange(Iterator begin, const K &high, const Compare &compare)
+            : _begin(std::move(begin)), _high(high), _compare(compare)
+        {
+        }
+
+        Iterator begin() const { return _begin; }
+        Sentinel end() const { return {this}; }
+
+        bool empty() const { return _begin == end(); }
+
+        friend bool operator==(const Iterator &it, const Sentinel &sentinel)
+        {
+            return !it || !sentinel.range->_compare(it->first, sentinel.range->_high);
+        }
+    };
+
+    /**
+     * Ordered map safe for concurrent use by many threads, implemented as lazy skip list: lookups and iteration
+     * take no locks, insert and remove lock only the predecessors of changed node and validate them before linking.
+     * Removed nodes are freed through epoch based reclamation, so readers never touch freed memory.
+     * Items are read only once inserted, as other threads may read them at any time
+     */
+    template <class K, class T, class Compare = std::less<K>> class ConcurrentMap
+    {
+      private:
+        using Node = ConcurrentMapNode<K, T>;
+        using Links = typename Node::Links;
+        using Link = typename Links::Link;
+        using Pair = std::pair<const K, T>;
+
+        static constexpr int MaxLevel = 32;
+
+        Links *_head = makeHead();
+        std::atomic<size_t> _size{0};
+        [[no_unique_address]] Compare _compare;
+        mutable EpochReclaimer _reclaimer;
+
+      public:
+        using Iterator = ConcurrentMapIterator<Node>;
+        using ConstIterator = Iterator;
+
+        // Constructors
+        ConcurrentMap() = default;
+
+        explicit ConcurrentMap(const Compare &compare) : _compare(compare) {}
+
+        ConcurrentMap(std::initializer_list<Pair> init)
+        {
+            for (auto &value : init)
+            {
+                insert(value);
+            }
+        }
+
+        ConcurrentMap(const ConcurrentMap &) = delete;
+        ConcurrentMap &operator=(const ConcurrentMap &) = delete;
+
+        // no thread may use map while it is destroyed
+        ~ConcurrentMap()
+        {
+            auto ptr = _head->next(0).load();
+            while (ptr)
+            {
+                auto next = ptr->next(0).load();
+                deleteNode(ptr);
+                ptr = next;
+            }
+            deleteHead(_head);
+        }
+
+        // Element access
+        // item is copied, reference could outlive node when other thread removes it
+        std::optional<T> get(const K &key) const
+        {
+            EpochGuard guard{_reclaimer};
+            auto node = findLiveNode(key);
+            if (!node)
+            {
+                return std::nullopt;
+            }
+            return node->getItem();
+        }
+
+        // Modifiers
+        // returns false when key is already present, present item is not changed
+        bool insert(const Pair &value) { return insertNode(value.first, value); }
+        bool insert(Pair &&value) { return insertNode(value.first, std::move(value)); }
+
+        // returns false when key was not present
+        bool remove(const K &key) { return removeNode(key); }
+
+        // LookUp
+        Iterator find(const K &key) const
+        {
+            auto pin = _reclaimer.enter();
+            return Iterator{&_reclaimer, pin, findLiveNode(key)};
+        }
+
+        bool contains(const K &key) const
+        {
+            EpochGuard guard{_reclaimer};
+            return findLiveNode(key);
+        }
+
+        // first element not less than key
+        Iterator lowerBound(const K &key) const
+        {
+            auto pin = _reclaimer.enter();
+            Links *preds[MaxLevel];
+            Node *succs[MaxLevel];
+            findLevels(key, preds, succs);
+            return Iterator{&_reclaimer, pin, succs[0]};
+        }
+
+        // elements with keys in [low, high), iteration sees elements present for its whole duration,
+        // elements inserted or removed concurrently may or may not be visited
+        ConcurrentMapRange<Iterator, K, Compare> range(const K &low, const K &high) const
+        {
+            return {lowerBound(low), high, _compare};
+        }
+
+        // Capacity
+        // exact only when no other thread modifies map
+        size_t size() const { return _size.load(std::memory_order_relaxed); }
+
+        bool empty() const { return size() == 0; }
+
+        // Iterators
+        Iterator begin() const
+        {
+            auto pin = _reclaimer.enter();
+            return Iterator{&_reclaimer, pin, _head->next(0).load(std::memory_order_acquire)};
+        }
+
+        Iterator end() const { return Iterator{}; }
+
+        Iterator cBegin() const { return begin(); }
+        Iterator cEnd() const { return end(); }
+
+      private:
+        /**
+         * Fills predecessors and successors of key on every level, returns highest level on which node
+         * with key was found or -1
+         */
+        int findLevels(const K &key, Links **preds, Node **succs) const
+        {
+            int found = -1;
+            Links *pred = _head;
+            for (int level = MaxLevel - 1; level >= 0; --level)
+            {
+                auto curr = pred->next(level).load(std::memory_order_acquire);
+                while (curr && _compare(curr->getKey(), key))
+                {
+                    pred = curr;
+                    curr = pred->next(level).load(std::memory_order_acquire);
+                }
+                if (found == -1 && curr && !_compare(key, curr->getKey()))
+                {
+                    found = level;
+                }
+                preds[level] = pred;
+                succs[level] = curr;
+            }
+            return found;
+        }
+
+        const Node *findLiveNode(const K &key) const
+        {
+            const Links *pred = _head;
+            for (int level = MaxLevel - 1; level >= 0; --level)
+            {
+                auto curr = pred->next(level).load(std::memory_order_acquire);
+                while (curr && _compare(curr->getKey(), key))
+                {
+                    pred = curr;
+                    curr = pred->next(level).load(std::memory_order_acquire);
+                }
+                if (curr && !_compare(key, curr->getKey()))
+                {
+                    return curr->isFullyLinked() && !curr->isMarked() ? curr : nullptr;
+                }
+            }
+            return nullptr;
+        }
+
+        template <class Arg> bool insertNode(const K &key, Arg &&value)
+        {
+            EpochGuard guard{_reclaimer};
+            auto topLevel = randomLevel();
+            Links *preds[MaxLevel];
+            Node *succs[MaxLevel];
+            while (true)
+            {
+                auto found = findLevels(key, preds, succs);
+                if (found != -1)
+                {
+                    auto node = succs[found];
+                    if (!node->isMarked())
+                    {
+                        while (!node->isFullyLinked())
+                        {
+                            std::this_thread::yield();
+                        }
+                        return false;
+                    }
+                    // node with same key is being removed, retry when it is unlinked
+                    std::this_thread::yield();
+                    continue;
+                }
+                int lockedLevels;
+                auto valid = lockPredecessors(preds, topLevel, lockedLevels, [&](Links *pred, int level) {
+                    auto succ = succs[level];
+                    return !pred->isMarked() && (!succ || !succ->isMarked()) &&
+                           pred->next(level).load(std::memory_order_acquire) == succ;
+                });
+                if (!valid)
+                {
+                    unlockPredecessors(preds, lockedLevels);
+                    continue;
+                }
+                Node *node;
+                try
+                {
+                    node = makeNode(topLevel, std::forward<Arg>(value));
+                }
+                catch (...)
+                {
+                    unlockPredecessors(preds, lockedLevels);
+                    throw;
+                }
+                for (int level = 0; level < topLevel; ++level)
+                {
+                    node->next(level).store(succs[level], std::memory_order_relaxed);
+                }
+                for (int level = 0; level < topLevel; ++level)
+                {
+                    preds[level]->next(level).store(node, std::memory_order_release);
+                }
+                node->setFullyLinked();
+                unlockPredecessors(preds, lockedLevels);
+                _size.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        bool removeNode(const K &key)
+        {
+            EpochGuard guard{_reclaimer};
+            Node *victim = nullptr;
+            bool marked = false;
+            Links *preds[MaxLevel];
+            Node *succs[MaxLevel];
+            while (true)
+            {
+                auto found = findLevels(key, preds, succs);
+                if (!marked)
+                {
+                    if (found == -1)
+                    {
+                        return false;
+                    }
+                    victim = succs[found];
+                    // only fully linked node found on its top level is candidate, others are still being inserted
+                    if (!victim->isFullyLinked() || victim->getTopLevel() != found + 1 || victim->isMarked())
+                    {
+                        return false;
+                    }
+                    victim->lock();
+                    if (victim->isMarked())
+                    {
+                        victim->unlock();
+                        return false;
+                    }
+                    victim->setMarked();
+                    marked = true;
+                }
+                auto topLevel = victim->getTopLevel();
+                int lockedLevels;
+                auto valid = lockPredecessors(preds, topLevel, lockedLevels, [&](Links *pred, int level) {
+                    return !pred->isMarked() && pred->next(level).load(std::memory_order_acquire) == victim;
+                });
+                if (!valid)
+                {
+                    unlockPredecessors(preds, lockedLevels);
+                    continue;
+                }
+                for (int level = topLevel - 1; level >= 0; --level)
+                {
+                    preds[level]->next(level).store(victim->next(level).load(std::memory_order_acquire),
+                                                    std::memory_order_release);
+                }
+                victim->unlock();
+                unlockPredecessors(preds, lockedLevels);
+                _size.fetch_sub(1, std::memory_order_relaxed);
+                _reclaimer.retire(victim, [](void *ptr) { deleteNode(static_cast<Node *>(ptr)); });
+                return true;
+            }
+        }
+
+        /**
+         * Locks distinct predecessors from bottom level up while they pass validation, lockedLevels tells how many
+         * levels have locked predecessor, returns true when all topLevel levels are locked and valid
+         */
+        template <class Validate> bool lockPredecessors(Links **preds, int topLevel, int &lockedLevels, Validate validate)
+        {
+            Links *previous = nullptr;
+            for (lockedLevels = 0; lockedLevels < topLevel;)
+            {
+                auto pred = preds[lockedLevels];
+                if (pred != previous)
+                {
+                    pred->lock();
+                    previous = pred;
+                }
+                if (!validate(pred, lockedLevels++))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void unlockPredecessors(Links **preds, int lockedLevels)
+        {
+            Links *previous = nullptr;
+            for (int level = 0; level < lockedLevels; ++level)
+            {
+                if (preds[level] != previous)
+                {
+                    preds[level]->unlock();
+                    previous = preds[level];
+                }
+            }
+        }
+
+        // geometric distribution with p = 1/2, level 1 for half of nodes
+        static int randomLevel()
+        {
+            thread_local uint64_t state = std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1;
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return std::min(std::countr_zero(state | (uint64_t(1) << (MaxLevel - 1))) + 1, MaxLevel);
+        }
+
+        /**
+         * Node and its links are placed in single allocation, links follow node
+         */
+        template <class... Args> static Node *makeNode(int topLevel, Args &&...args)
+        {
+            auto memory = static_cast<std::byte *>(::operator new(sizeof(Node) + topLevel * sizeof(Link)));
+            auto links = reinterpret_cast<Link *>(memory + sizeof(Node));
+            std::uninitialized_value_construct_n(links, topLevel);
+            try
+            {
+                return new (memory) Node(links, topLevel, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                ::operator delete(memory);
+                throw;
+            }
+        }
+
+        static void deleteNode(Node *ptr)
+        {
+            std::destroy_at(ptr);
+            ::operator delete(static_cast<void *>(ptr));
+        }
+
+        // head is only links part of node, it is before every element on all levels
+        static Links *makeHead()
+        {
+            auto memory = static_cast<std::byte *>(::operator new(sizeof(Links) + MaxLevel * sizeof(Link)));
+            auto links = reinterpret_cast<Link *>(memory + sizeof(Links));
+            std::uninitialized_value_construct_n(links, MaxLevel);
+            return new (memory) Links(links, MaxLevel);
+        }
+
+        static void deleteHead(Links *head)
+        {
+            std::destroy_at(head);
+            ::operator delete(static_cast<void *>(head));
+        }
+    };
+} // namespace sd
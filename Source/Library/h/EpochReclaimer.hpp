@@ -0,0 +1,148 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace sd
+{
+    /**
+     * Epoch based memory reclamation. Threads pin current epoch for the time they touch shared nodes, unlinked
+     * nodes are retired with epoch they were unlinked in and freed once no thread can be pinned in that epoch.
+     * Pins are counted per epoch parity in several stripes, so readers on different cores rarely share cache line
+     */
+    class EpochReclaimer
+    {
+      public:
+        static constexpr size_t Stripes = 16;
+        // retired nodes are collected in batches, epoch is advanced only when batch is full
+        static constexpr size_t AdvanceEvery = 64;
+
+        struct Pin
+        {
+            size_t slot;
+            size_t stripe;
+        };
+
+      private:
+        struct alignas(64) Counter
+        {
+            std::atomic<size_t> count{0};
+        };
+
+        struct Retired
+        {
+            void *ptr;
+            void (*deleter)(void *);
+        };
+
+        std::atomic<uint64_t> _epoch{0};
+        Counter _active[2][Stripes];
+        std::mutex _retireMutex;
+        std::vector<Retired> _retired[3];
+        size_t _retiredSinceAdvance = 0;
+
+      public:
+        EpochReclaimer() = default;
+        EpochReclaimer(const EpochReclaimer &) = delete;
+        EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+        ~EpochReclaimer()
+        {
+            for (auto &retired : _retired)
+            {
+                freeAll(retired);
+            }
+        }
+
+        Pin enter()
+        {
+            auto stripe = threadStripe();
+            while (true)
+            {
+                auto epoch = _epoch.load();
+                auto &counter = _active[epoch & 1][stripe].count;
+                counter.fetch_add(1);
+                // epoch could advance between load and pin, then pin would not protect anything
+                if (_epoch.load() == epoch)
+                {
+                    return {size_t(epoch & 1), stripe};
+                }
+                counter.fetch_sub(1);
+            }
+        }
+
+        // pins again epoch already pinned by pin, used when pinned object is copied
+        void repin(Pin pin) { _active[pin.slot][pin.stripe].count.fetch_add(1); }
+
+        void leave(Pin pin) { _active[pin.slot][pin.stripe].count.fetch_sub(1); }
+
+        /**
+         * Schedules ptr to be freed by deleter, it has to be already unreachable for threads pinning from now on
+         */
+        void retire(void *ptr, void (*deleter)(void *))
+        {
+            std::lock_guard lock(_retireMutex);
+            _retired[_epoch.load() % 3].push_back({ptr, deleter});
+            if (++_retiredSinceAdvance >= AdvanceEvery)
+            {
+                tryAdvance();
+            }
+        }
+
+      private:
+        /**
+         * Epoch E can become E + 1 when no thread is pinned in E - 1, then nodes retired in E - 1 are freed:
+         * threads pinned in E started after they were unlinked and threads of older epochs are gone
+         */
+        void tryAdvance()
+        {
+            auto epoch = _epoch.load();
+            auto previousSlot = (epoch + 1) & 1;
+            for (auto &counter : _active[previousSlot])
+            {
+                if (counter.count.load() != 0)
+                {
+                    return;
+                }
+            }
+            _epoch.store(epoch + 1);
+            freeAll(_retired[(epoch + 2) % 3]);
+            _retiredSinceAdvance = 0;
+        }
+
+        static void freeAll(std::vector<Retired> &retired)
+        {
+            for (auto [ptr, deleter] : retired)
+            {
+                deleter(ptr);
+            }
+            retired.clear();
+        }
+
+        static size_t threadStripe()
+        {
+            static std::atomic<size_t> nextStripe{0};
+            thread_local size_t stripe = nextStripe.fetch_add(1) % Stripes;
+            return stripe;
+        }
+    };
+
+    /**
+     * Pins reclaimer epoch for scope lifetime
+     */
+    class EpochGuard
+    {
+      private:
+        EpochReclaimer &_reclaimer;
+        EpochReclaimer::Pin _pin;
+
+      public:
+        explicit EpochGuard(EpochReclaimer &reclaimer) : _reclaimer(reclaimer), _pin(reclaimer.enter()) {}
+        EpochGuard(const EpochGuard &) = delete;
+        EpochGuard &operator=(const EpochGuard &) = delete;
+
+        ~EpochGuard() { _reclaimer.leave(_pin); }
+    };
+} // namespace sd
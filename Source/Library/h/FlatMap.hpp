@@ -0,0 +1,465 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Map.hpp"
+
+namespace sd
+{
+    template <class K, class T, bool C, bool R> // C= const, R = Reverse
+    class FlatMapIterator
+    {
+      public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using ItemPtr = std::conditional_t<C, const T *, T *>;
+        using ItemRef = std::conditional_t<C, const T &, T &>;
+        // keys and items live in separate arrays, so pair of references is returned instead of stored pair
+        using Pair = std::pair<const K &, ItemRef>;
+        using value_type = Pair;
+
+        struct PairPtr
+        {
+            Pair pair;
+
+            Pair *operator->() { return &pair; }
+        };
+
+      private:
+        const K *_keys = nullptr;
+        ItemPtr _items = nullptr;
+        std::ptrdiff_t _index = 0;
+        std::ptrdiff_t _size = 0;
+
+      public:
+        FlatMapIterator() = default;
+        FlatMapIterator(const K *keys, ItemPtr items, std::ptrdiff_t index, std::ptrdiff_t size)
+            : _keys(keys), _items(items), _index(index), _size(size)
+        {
+        }
+        FlatMapIterator(const FlatMapIterator &rawIterator) = default;
+        ~FlatMapIterator() = default;
+
+        FlatMapIterator &operator=(const FlatMapIterator &rawIterator) = default;
+
+        operator bool() const { return _index >= 0 && _index < _size; }
+
+        bool operator==(const FlatMapIterator &rawIterator) const { return _index == rawIterator._index; }
+        bool operator!=(const FlatMapIterator &rawIterator) const { return _index != rawIterator._index; }
+
+        FlatMapIterator &operator++()
+        {
+            _index += R ? -1 : 1;
+            return *this;
+        }
+
+        FlatMapIterator &operator--()
+        {
+            _index -= R ? -1 : 1;
+            return *this;
+        }
+
+        FlatMapIterator operator++(int)
+        {
+            auto temp(*this);
+            ++*this;
+            return temp;
+        }
+
+        FlatMapIterator operator--(int)
+        {
+            auto temp(*this);
+            --*this;
+            return temp;
+        }
+
+        Pair operator*() const { return {_keys[_index], _items[_index]}; }
+
+        PairPtr operator->() const { return {**this}; }
+
+        // position of element in key and item arrays
+        size_t index() const { return size_t(_index); }
+    };
+
+    /**
+     * Ordered map stored as two sorted contiguous arrays, one for keys and one for items. Meant for maps built once
+     * and then mostly read, lookups are branchless binary searches over dense key array and iteration is linear,
+     * single insert or remove is O(n) as following elements are shifted
+     */
+    template <class K, class T, class Compare = std::less<K>> class FlatMap
+    {
+      private:
+        using Pair = std::pair<const K, T>;
+
+        // below this many candidate keys search finishes with plain scan, which vectorizes for arithmetic keys
+        static constexpr size_t ScanWidth = std::is_arithmetic_v<K> ? 16 : 1;
+
+        std::vector<K> _keys;
+        std::vector<T> _items;
+        [[no_unique_address]] Compare _compare;
+
+      public:
+        using Iterator = FlatMapIterator<K, T, false, false>;
+        using ConstIterator = FlatMapIterator<K, T, true, false>;
+
+        using ReverseIterator = FlatMapIterator<K, T, false, true>;
+        using ConstReverseIterator = FlatMapIterator<K, T, true, true>;
+
+        // Constructors
+        FlatMap() = default;
+
+        explicit FlatMap(const Compare &compare) : _compare(compare) {}
+
+        /**
+         * Builds map from unsorted range in O(n log n), range is sorted and for duplicated keys
+         * first occurrence is kept, same as inserting elements one by one
+         */
+        template <class InputIt> FlatMap(InputIt first, InputIt last) { insert(first, last); }
+
+        template <class InputIt> FlatMap(SortedUniqueTag, InputIt first, InputIt last)
+        {
+            for (auto it = first; it != last; ++it)
+            {
+                _keys.push_back((*it).first);
+                _items.push_back((*it).second);
+            }
+        }
+
+        FlatMap(const FlatMap &other) = default;
+
+        FlatMap(FlatMap &&other) { swap(other); }
+
+        FlatMap(std::initializer_list<Pair> init) { insert(init); }
+
+        ~FlatMap() = default;
+
+        // Assign
+        FlatMap &operator=(const FlatMap &other) = default;
+
+        FlatMap &operator=(FlatMap &&other)
+        {
+            if (this != &other)
+            {
+                clear();
+                swap(other);
+            }
+            return *this;
+        }
+
+        FlatMap &operator=(std::initializer_list<Pair> ilist)
+        {
+            clear();
+            insert(ilist);
+            return *this;
+        }
+
+        // Element access
+        T &at(const K &key) { return _items[assertIndex(findIndex(key))]; }
+
+        const T &at(const K &key) const { return _items[assertIndex(findIndex(key))]; }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        T &at(const Key &key)
+        {
+            return _items[assertIndex(findIndex(key))];
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        const T &at(const Key &key) const
+        {
+            return _items[assertIndex(findIndex(key))];
+        }
+
+        T &operator[](const K &key) { return at(key); }
+
+        const T &operator[](const K &key) const { return at(key); }
+
+        // sorted keys and items stored at matching positions
+        const std::vector<K> &keys() const { return _keys; }
+
+        const std::vector<T> &items() const { return _items; }
+
+        // Modifiers
+        std::pair<Iterator, bool> insert(const Pair &value) { return insertValue(value.first, value.second); }
+        std::pair<Iterator, bool> insert(Pair &&value) { return insertValue(value.first, std::move(value.second)); }
+
+        /**
+         * Inserts range, new elements are sorted and deduplicated first and then merged with existing ones
+         * in single linear pass, so bulk insert costs O(n + m log m) instead of O(n * m)
+         */
+        template <class InputIt> void insert(InputIt first, InputIt last)
+        {
+            std::vector<std::pair<K, T>> entries;
+            for (auto it = first; it != last; ++it)
+            {
+                entries.emplace_back((*it).first, (*it).second);
+            }
+            auto keyLess = [this](const auto &lhs, const auto &rhs) { return _compare(lhs.first, rhs.first); };
+            if (!std::is_sorted(entries.begin(), entries.end(), keyLess))
+            {
+                std::stable_sort(entries.begin(), entries.end(), keyLess);
+            }
+            auto uniqueEnd = std::unique(entries.begin(), entries.end(), [this](const auto &lhs, const auto &rhs) {
+                return !_compare(lhs.first, rhs.first);
+            });
+            entries.erase(uniqueEnd, entries.end());
+            mergeSorted(entries);
+        }
+
+        void insert(const std::initializer_list<Pair> &ilist) { insert(ilist.begin(), ilist.end()); }
+
+        void remove(const K &key)
+        {
+            auto index = assertIndex(findIndex(key));
+            _keys.erase(_keys.begin() + index);
+            _items.erase(_items.begin() + index);
+        }
+
+        void swap(FlatMap &other)
+        {
+            std::swap(_keys, other._keys);
+            std::swap(_items, other._items);
+            std::swap(_compare, other._compare);
+        }
+
+        void clear()
+        {
+            _keys.clear();
+            _items.clear();
+        }
+
+        void reserve(size_t capacity)
+        {
+            _keys.reserve(capacity);
+            _items.reserve(capacity);
+        }
+
+        void shrinkToFit()
+        {
+            _keys.shrink_to_fit();
+            _items.shrink_to_fit();
+        }
+
+        // LookUp
+        Iterator find(const K &key) { return makeIterator(findIndex(key)); }
+
+        ConstIterator find(const K &key) const { return makeConstIterator(findIndex(key)); }
+
+        bool contains(const K &key) const { return findIndex(key) != size(); }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        Iterator find(const Key &key)
+        {
+            return makeIterator(findIndex(key));
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        ConstIterator find(const Key &key) const
+        {
+            return makeConstIterator(findIndex(key));
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        bool contains(const Key &key) const
+        {
+            return findIndex(key) != size();
+        }
+
+        // Bounds, first element not less than key
+        Iterator lowerBound(const K &key) { return makeIterator(lowerBoundIndex(key)); }
+
+        ConstIterator lowerBound(const K &key) const { return makeConstIterator(lowerBoundIndex(key)); }
+
+        // first element greater than key
+        Iterator upperBound(const K &key) { return makeIterator(upperBoundIndex(key)); }
+
+        ConstIterator upperBound(const K &key) const { return makeConstIterator(upperBoundIndex(key)); }
+
+        // elements with keys in [low, high)
+        MapRange<Iterator> range(const K &low, const K &high)
+        {
+            auto last = lowerBoundIndex(high);
+            return {makeIterator(_compare(low, high) ? lowerBoundIndex(low) : last), makeIterator(last)};
+        }
+
+        MapRange<ConstIterator> range(const K &low, const K &high) const
+        {
+            auto last = lowerBoundIndex(high);
+            return {makeConstIterator(_compare(low, high) ? lowerBoundIndex(low) : last), makeConstIterator(last)};
+        }
+
+        // Capacity
+        size_t size() const { return _keys.size(); }
+
+        bool empty() const { return size() == 0; }
+
+        size_t capacity() const { return _keys.capacity(); }
+
+        // Iterators
+        Iterator begin() { return makeIterator(0); }
+        Iterator end() { return makeIterator(size()); }
+
+        ConstIterator begin() const { return makeConstIterator(0); }
+        ConstIterator end() const { return makeConstIterator(size()); }
+
+        ConstIterator cBegin() const { return makeConstIterator(0); }
+        ConstIterator cEnd() const { return makeConstIterator(size()); }
+
+        ReverseIterator rBegin() { return ReverseIterator{_keys.data(), _items.data(), ssize() - 1, ssize()}; }
+        ReverseIterator rEnd() { return ReverseIterator{_keys.data(), _items.data(), -1, ssize()}; }
+
+        ConstReverseIterator rBegin() const
+        {
+            return ConstReverseIterator{_keys.data(), _items.data(), ssize() - 1, ssize()};
+        }
+        ConstReverseIterator rEnd() const { return ConstReverseIterator{_keys.data(), _items.data(), -1, ssize()}; }
+
+        ConstReverseIterator crBegin() const { return rBegin(); }
+        ConstReverseIterator crEnd() const { return rEnd(); }
+
+      private:
+        std::ptrdiff_t ssize() const { return std::ptrdiff_t(size()); }
+
+        Iterator makeIterator(size_t index) { return Iterator{_keys.data(), _items.data(), std::ptrdiff_t(index), ssize()}; }
+
+        ConstIterator makeConstIterator(size_t index) const
+        {
+            return ConstIterator{_keys.data(), _items.data(), std::ptrdiff_t(index), ssize()};
+        }
+
+        /**
+         * Branchless binary search, each step only selects next base so compiler emits conditional moves instead
+         * of hard to predict branches, both possible next probes are prefetched so cache misses of large arrays
+         * overlap. Last ScanWidth candidates of arithmetic keys are counted with fixed width scan, which vectorizes
+         */
+        template <class Key> size_t lowerBoundIndex(const Key &key) const
+        {
+            const K *keys = _keys.data();
+            auto base = keys;
+            auto count = _keys.size();
+            while (count > ScanWidth)
+            {
+                auto half = count / 2;
+#if defined(__GNUC__)
+                __builtin_prefetch(base + half / 2);
+                __builtin_prefetch(base + half + half / 2);
+#endif
+                // multiplication instead of ternary, compilers tend to turn the latter back into branch
+                base += half * size_t(_compare(base[half - 1], key));
+                count -= half;
+            }
+            if (ScanWidth > 1 && _keys.size() >= ScanWidth)
+            {
+                // window moved left only gains keys known to be smaller, fixed trip count lets compiler unroll it
+                base = std::min(base, keys + _keys.size() - ScanWidth);
+                count = ScanWidth;
+            }
+            size_t before = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                before += _compare(base[i], key);
+            }
+            return base - keys + before;
+        }
+
+        size_t upperBoundIndex(const K &key) const
+        {
+            auto index = lowerBoundIndex(key);
+            return index != size() && !_compare(key, _keys[index]) ? index + 1 : index;
+        }
+
+        // index of key or size() if it is not present
+        template <class Key> size_t findIndex(const Key &key) const
+        {
+            auto index = lowerBoundIndex(key);
+            return index != size() && !_compare(key, _keys[index]) ? index : size();
+        }
+
+        template <class Item> std::pair<Iterator, bool> insertValue(const K &key, Item &&item)
+        {
+            auto index = lowerBoundIndex(key);
+            if (index != size() && !_compare(key, _keys[index]))
+            {
+                return {makeIterator(index), false};
+            }
+            _keys.insert(_keys.begin() + index, key);
+            try
+            {
+                _items.insert(_items.begin() + index, std::forward<Item>(item));
+            }
+            catch (...)
+            {
+                _keys.erase(_keys.begin() + index);
+                throw;
+            }
+            return {makeIterator(index), true};
+        }
+
+        // merges sorted unique entries into map, existing keys win
+        void mergeSorted(std::vector<std::pair<K, T>> &entries)
+        {
+            if (entries.empty())
+            {
+                return;
+            }
+            std::vector<K> keys;
+            std::vector<T> items;
+            keys.reserve(size() + entries.size());
+            items.reserve(size() + entries.size());
+            size_t index = 0;
+            for (auto &[key, item] : entries)
+            {
+                while (index < size() && _compare(_keys[index], key))
+                {
+                    keys.push_back(std::move(_keys[index]));
+                    items.push_back(std::move(_items[index]));
+                    ++index;
+                }
+                if (index < size() && !_compare(key, _keys[index]))
+                {
+                    continue;
+                }
+                keys.push_back(std::move(key));
+                items.push_back(std::move(item));
+            }
+            for (; index < size(); ++index)
+            {
+                keys.push_back(std::move(_keys[index]));
+                items.push_back(std::move(_items[index]));
+            }
+            _keys = std::move(keys);
+            _items = std::move(items);
+        }
+
+        size_t assertIndex(size_t index) const
+        {
+            if (index == size())
+            {
+                throw std::out_of_range("Item was not found");
+            }
+            return index;
+        }
+    };
+
+    template <class K, class T, class C> bool operator==(const FlatMap<K, T, C> &lhs, const FlatMap<K, T, C> &rhs)
+    {
+        return lhs.keys() == rhs.keys() && lhs.items() == rhs.items();
+    }
+
+    template <class K, class T, class C> bool operator!=(const FlatMap<K, T, C> &lhs, const FlatMap<K, T, C> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+} // namespace sd
@@ -0,0 +1,410 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Map.hpp"
+
+namespace sd
+{
+    /**
+     * Ordered map with hash index over its nodes. Tree keeps order for iteration and range queries, open addressing
+     * table from key to tree node answers at, find and contains in expected constant time without walking the tree.
+     * Hash has to agree with Compare: keys equivalent under Compare must have equal hashes. Index takes pointer and
+     * tag byte per slot, at most 3/4 of slots are used, so it adds 12 to 24 bytes per element
+     */
+    template <class K, class T, class Hash = std::hash<K>, class Compare = std::less<K>,
+              template <class> class Allocator = HeapNodeAllocator>
+    class IndexedMap
+    {
+      private:
+        using Tree = Map<K, T, Compare, Allocator>;
+        // tree pointers, index keeps real nodes only
+        using MapNodePtr = typename Tree::MapNodePtr;
+
+        using Pair = std::pair<const K, T>;
+
+        static constexpr std::uint8_t EmptyTag = 0;
+        static constexpr size_t MinCapacity = 16;
+
+        Tree _tree;
+        // slot is free when its tag is empty, otherwise tag holds top bits of key hash with highest bit set
+        std::vector<MapNodePtr> _slots;
+        std::vector<std::uint8_t> _tags;
+        [[no_unique_address]] Hash _hash;
+
+      public:
+        using Iterator = typename Tree::Iterator;
+        using ConstIterator = typename Tree::ConstIterator;
+
+        using ReverseIterator = typename Tree::ReverseIterator;
+        using ConstReverseIterator = typename Tree::ConstReverseIterator;
+
+        // Constructors
+        IndexedMap() = default;
+
+        template <class InputIt> IndexedMap(InputIt first, InputIt last) { insert(first, last); }
+
+        IndexedMap(const IndexedMap &other) : _tree(other._tree), _hash(other._hash)
+        {
+            rebuildIndex(other._slots.size());
+        }
+
+        IndexedMap(IndexedMap &&other) { swap(other); }
+
+        IndexedMap(std::initializer_list<Pair> init) { insert(init); }
+
+        // Assign
+        IndexedMap &operator=(const IndexedMap &other)
+        {
+            if (this != &other)
+            {
+                clear();
+                _hash = other._hash;
+                _tree = other._tree;
+                rebuildIndex(std::max(_slots.size(), other._slots.size()));
+            }
+            return *this;
+        }
+
+        IndexedMap &operator=(IndexedMap &&other)
+        {
+            if (this != &other)
+            {
+                clear();
+                swap(other);
+            }
+            return *this;
+        }
+
+        IndexedMap &operator=(std::initializer_list<Pair> ilist)
+        {
+            clear();
+            insert(ilist);
+            return *this;
+        }
+
+        // Element access
+        T &at(const K &key)
+        {
+            auto node = findIndexed(key);
+            assertNode(node);
+            return node->getItem();
+        }
+
+        const T &at(const K &key) const
+        {
+            auto node = findIndexed(key);
+            assertNode(node);
+            return node->getItem();
+        }
+
+        T &operator[](const K &key) { return at(key); }
+
+        const T &operator[](const K &key) const { return at(key); }
+
+        Pair &front() { return _tree.front(); }
+
+        const Pair &front() const { return _tree.front(); }
+
+        Pair &back() { return _tree.back(); }
+
+        const Pair &back() const { return _tree.back(); }
+
+        // Iterators
+        Iterator begin() { return _tree.begin(); }
+        Iterator end() { return _tree.end(); }
+
+        ConstIterator begin() const { return _tree.begin(); }
+        ConstIterator end() const { return _tree.end(); }
+
+        ConstIterator cBegin() const { return _tree.cBegin(); }
+        ConstIterator cEnd() const { return _tree.cEnd(); }
+
+        ReverseIterator rBegin() { return _tree.rBegin(); }
+        ReverseIterator rEnd() { return _tree.rEnd(); }
+
+        ConstReverseIterator rBegin() const { return _tree.rBegin(); }
+        ConstReverseIterator rEnd() const { return _tree.rEnd(); }
+
+        // Capacity
+        size_t size() const { return _tree.size(); }
+
+        bool empty() const { return _tree.empty(); }
+
+        // number of index slots, index grows when more than 3/4 of them would be used
+        size_t bucketCount() const { return _slots.size(); }
+
+        // makes index large enough for count elements, so inserting them does not rehash
+        void reserve(size_t count)
+        {
+            if (count > maxLoad(_slots.size()))
+            {
+                rebuildIndex(capacityFor(count));
+            }
+        }
+
+        // Modifiers
+        std::pair<Iterator, bool> insert(const Pair &value)
+        {
+            return emplaceKey(value.first, [&] { return _tree.makeNode(value); });
+        }
+
+        std::pair<Iterator, bool> insert(Pair &&value)
+        {
+            return emplaceKey(value.first, [&] { return _tree.makeNode(std::move(value)); });
+        }
+
+        template <class InputIt> void insert(InputIt first, InputIt last)
+        {
+            for (; first != last; ++first)
+            {
+                insert(*first);
+            }
+        }
+
+        void insert(std::initializer_list<Pair> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        template <class... Args> std::pair<Iterator, bool> tryEmplace(const K &key, Args &&...args)
+        {
+            return emplaceKey(key, [&] {
+                return _tree.makeNode(std::in_place, std::piecewise_construct, std::forward_as_tuple(key),
+                                      std::forward_as_tuple(std::forward<Args>(args)...));
+            });
+        }
+
+        template <class... Args> std::pair<Iterator, bool> tryEmplace(K &&key, Args &&...args)
+        {
+            return emplaceKey(key, [&] {
+                return _tree.makeNode(std::in_place, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                      std::forward_as_tuple(std::forward<Args>(args)...));
+            });
+        }
+
+        template <class M> std::pair<Iterator, bool> insertOrAssign(const K &key, M &&item)
+        {
+            auto result = tryEmplace(key, std::forward<M>(item));
+            if (!result.second)
+            {
+                result.first->second = std::forward<M>(item);
+            }
+            return result;
+        }
+
+        template <class M> std::pair<Iterator, bool> insertOrAssign(K &&key, M &&item)
+        {
+            auto result = tryEmplace(std::move(key), std::forward<M>(item));
+            if (!result.second)
+            {
+                result.first->second = std::forward<M>(item);
+            }
+            return result;
+        }
+
+        void remove(const K &key)
+        {
+            auto hash = hashOf(key);
+            auto slot = findSlot(key, hash);
+            if (slot == _slots.size() || _tags[slot] == EmptyTag)
+            {
+                throw std::out_of_range("Item was not found");
+            }
+            auto node = _slots[slot];
+            eraseSlot(slot);
+            _tree.removeNode(node);
+        }
+
+        void popFront()
+        {
+            _tree.assertEmpty();
+            remove(_tree._leftmost->getKey());
+        }
+
+        void popBack()
+        {
+            _tree.assertEmpty();
+            remove(_tree._rightmost->getKey());
+        }
+
+        void swap(IndexedMap &other)
+        {
+            _tree.swap(other._tree);
+            _slots.swap(other._slots);
+            _tags.swap(other._tags);
+            std::swap(_hash, other._hash);
+        }
+
+        // index keeps its slots, so map filled again to similar size does not rehash
+        void clear()
+        {
+            _tree.clear();
+            std::fill(_tags.begin(), _tags.end(), EmptyTag);
+        }
+
+        // LookUp
+        Iterator find(const K &key) { return Iterator{orGuard(findIndexed(key))}; }
+
+        ConstIterator find(const K &key) const { return ConstIterator{orGuard(findIndexed(key))}; }
+
+        bool contains(const K &key) const { return findIndexed(key) != nullptr; }
+
+        // ordered queries are answered by tree
+        Iterator lowerBound(const K &key) { return _tree.lowerBound(key); }
+
+        ConstIterator lowerBound(const K &key) const { return _tree.lowerBound(key); }
+
+        Iterator upperBound(const K &key) { return _tree.upperBound(key); }
+
+        ConstIterator upperBound(const K &key) const { return _tree.upperBound(key); }
+
+        MapRange<Iterator> range(const K &low, const K &high) { return _tree.range(low, high); }
+
+        MapRange<ConstIterator> range(const K &low, const K &high) const { return _tree.range(low, high); }
+
+      private:
+        // Index
+        static size_t mix(size_t hash)
+        {
+            // murmur3 finalizer, std::hash of integers is identity and would put consecutive keys in one run
+            std::uint64_t value = hash;
+            value ^= value >> 33;
+            value *= 0xff51afd7ed558ccdULL;
+            value ^= value >> 33;
+            value *= 0xc4ceb9fe1a85ec53ULL;
+            value ^= value >> 33;
+            return size_t(value);
+        }
+
+        size_t hashOf(const K &key) const { return mix(_hash(key)); }
+
+        static std::uint8_t tagOf(size_t hash) { return std::uint8_t(hash >> (sizeof(size_t) * 8 - 7)) | 0x80; }
+
+        static size_t maxLoad(size_t capacity) { return capacity / 4 * 3; }
+
+        static size_t capacityFor(size_t count)
+        {
+            auto capacity = MinCapacity;
+            while (maxLoad(capacity) < count)
+            {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+
+        /**
+         * Returns slot holding key or first empty slot of its probe sequence, size of index when index has no
+         * slots. Tags are compared first, so keys are read only for slots with matching tag
+         */
+        size_t findSlot(const K &key, size_t hash) const
+        {
+            if (_slots.empty())
+            {
+                return 0;
+            }
+            auto mask = _slots.size() - 1;
+            auto tag = tagOf(hash);
+            for (auto slot = hash & mask;; slot = (slot + 1) & mask)
+            {
+                if (_tags[slot] == EmptyTag ||
+                    (_tags[slot] == tag && _tree.compareKeys(_slots[slot]->getKey(), key) == 0))
+                {
+                    return slot;
+                }
+            }
+        }
+
+        MapNodePtr findIndexed(const K &key) const
+        {
+            auto slot = findSlot(key, hashOf(key));
+            return slot == _slots.size() || _tags[slot] == EmptyTag ? nullptr : _slots[slot];
+        }
+
+        void placeNode(MapNodePtr node, size_t hash)
+        {
+            auto mask = _slots.size() - 1;
+            auto slot = hash & mask;
+            while (_tags[slot] != EmptyTag)
+            {
+                slot = (slot + 1) & mask;
+            }
+            _slots[slot] = node;
+            _tags[slot] = tagOf(hash);
+        }
+
+        /**
+         * Frees slot by moving following entries of its run back, so lookups never need tombstones. Entry can
+         * fill the hole only when hole lies between its home slot and its current slot
+         */
+        void eraseSlot(size_t hole)
+        {
+            auto mask = _slots.size() - 1;
+            for (auto slot = (hole + 1) & mask; _tags[slot] != EmptyTag; slot = (slot + 1) & mask)
+            {
+                auto home = hashOf(_slots[slot]->getKey()) & mask;
+                if (((slot - home) & mask) >= ((slot - hole) & mask))
+                {
+                    _slots[hole] = _slots[slot];
+                    _tags[hole] = _tags[slot];
+                    hole = slot;
+                }
+            }
+            _tags[hole] = EmptyTag;
+        }
+
+        // fills index of given capacity from tree, capacity is raised when tree would not fit in it
+        void rebuildIndex(size_t capacity)
+        {
+            capacity = std::max(capacity, capacityFor(_tree.size()));
+            std::vector<MapNodePtr> slots(capacity);
+            std::vector<std::uint8_t> tags(capacity, EmptyTag);
+            _slots.swap(slots);
+            _tags.swap(tags);
+            for (auto node = _tree._leftmost; !_tree.isGuard(node); node = _tree.succesor(node))
+            {
+                placeNode(node, hashOf(node->getKey()));
+            }
+        }
+
+        /**
+         * Index is grown before node is made, so failed allocation leaves map unchanged, and node is indexed
+         * only after tree took it
+         */
+        template <class MakeNode> std::pair<Iterator, bool> emplaceKey(const K &key, MakeNode makeNode)
+        {
+            auto hash = hashOf(key);
+            auto slot = findSlot(key, hash);
+            if (slot != _slots.size() && _tags[slot] != EmptyTag)
+            {
+                return {Iterator{_slots[slot]}, false};
+            }
+            reserve(_tree.size() + 1);
+            auto position = _tree.findInsertPosition(key);
+            auto node = makeNode();
+            _tree.attachNode(node, position.parent, position.left);
+            placeNode(node, hash);
+            return {Iterator{node}, true};
+        }
+
+        MapNodePtr orGuard(MapNodePtr node) const { return node ? node : _tree._guardPtr; }
+
+        static void assertNode(MapNodePtr node)
+        {
+            if (!node)
+            {
+                throw std::out_of_range("Item was not found");
+            }
+        }
+    };
+
+    template <class K, class T, class H, class C, template <class> class A>
+    bool operator==(const IndexedMap<K, T, H, C, A> &lhs, const IndexedMap<K, T, H, C, A> &rhs)
+    {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+} // namespace sd
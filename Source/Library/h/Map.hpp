@@ -1,7 +1,26 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "MapSnapshot.hpp"
+#include "NodeAllocator.hpp"
 
 namespace sd
 {
@@ -11,58 +30,247 @@ namespace sd
         Red
     };
 
-    template <class K, class T> class MapNode
+    /**
+     * Default augmentation policy, nodes carry no additional data
+     */
+    struct NoAugmentation
+    {
+        static constexpr bool enabled = false;
+
+        struct Data
+        {
+        };
+
+        template <class Node> static void update(Node *) {}
+    };
+
+    /**
+     * Augmentation policy keeping size of subtree in every node, enables nth and rank in O(log n)
+     */
+    struct OrderStatistics
+    {
+        static constexpr bool enabled = true;
+
+        using Data = size_t;
+
+        // guard has size 0, so leafs need no special case
+        template <class Node> static void update(Node *node)
+        {
+            node->getAugment() = node->getLeft()->getAugment() + node->getRight()->getAugment() + 1;
+        }
+    };
+
+    /**
+     * Closed interval [low, high] used as key of IntervalMap, ordered by low and then by high. Expects low <= high
+     */
+    template <class E> struct Interval
+    {
+        using Endpoint = E;
+
+        E low;
+        E high;
+
+        auto operator<=>(const Interval &) const = default;
+    };
+
+    /**
+     * Augmentation policy keeping biggest high endpoint of interval keys in subtree, enables overlap queries
+     * which skip subtrees ending before queried interval
+     */
+    template <class E> struct MaxEndpoint
+    {
+        static constexpr bool enabled = true;
+
+        using Endpoint = E;
+        // guard holds no value, so leafs need no special case
+        using Data = std::optional<E>;
+
+        template <class Node> static void update(Node *node)
+        {
+            auto &max = node->getAugment();
+            max = node->getKey().high;
+            for (auto &childMax : {node->getLeft()->getAugment(), node->getRight()->getAugment()})
+            {
+                if (childMax && *max < *childMax)
+                {
+                    max = childMax;
+                }
+            }
+        }
+    };
+
+    template <class Augment>
+    concept IntervalAugmentation = std::same_as<Augment, MaxEndpoint<typename Augment::Endpoint>>;
+
+    /**
+     * Links part of map node, also used alone as guard of tree. Links point to links of other nodes, so guard is never
+     * seen as node, value accessors cast to Node and are only called on real nodes
+     */
+    template <class Node, class Augment = NoAugmentation> class MapNodeLinks
     {
       public:
-        using KeyType = K;
-        using ItemType = T;
-        using MapNodePtr = MapNode<K, T> *;
-        using ConstMapNodePtr = const MapNode<K, T> *;
-        using Pair = std::pair<const K, T>;
+        using LinksPtr = MapNodeLinks *;
+        using ConstLinksPtr = const MapNodeLinks *;
+        using AugmentData = typename Augment::Data;
 
       private:
-        Pair _keyItem;
-        Color _color = Color::Black;
-        MapNodePtr _parent = nullptr;
-        MapNodePtr _left = nullptr;
-        MapNodePtr _right = nullptr;
+        LinksPtr _parent = nullptr;
+        LinksPtr _left = nullptr;
+        LinksPtr _right = nullptr;
+        std::uint8_t _balance = 0;
+        [[no_unique_address]] AugmentData _augment{};
 
       public:
-        MapNode() = delete;
+        static constexpr unsigned BalanceBits = 8;
 
-        MapNode(const Pair &p) : _keyItem{p} {}
-        MapNode(Pair &&p) : _keyItem{std::move(p)} {}
-        // template <class... Args1, class... Args2>
-        // MapNode(std::tuple<Args1...> args1, std::tuple<Args2...> args2)
-        //     : _keyItem(std::piecewise_construct, args1, args2)
-        // {
-        // }
-        MapNode(const K &k, const T &i) : _keyItem{k, i} {}
-        MapNode(K &&k, T &&i) : _keyItem{std::move(k), std::move(i)} {}
+        void setRight(LinksPtr p) { _right = p; }
 
-        ~MapNode() = default;
+        LinksPtr getRight() { return _right; }
+
+        ConstLinksPtr getRight() const { return _right; }
+
+        bool isRightEmpty() const { return !_right; }
+
+        void setLeft(LinksPtr p) { _left = p; }
+
+        LinksPtr getLeft() { return _left; }
+
+        ConstLinksPtr getLeft() const { return _left; }
+
+        bool isLeftEmpty() const { return !_left; }
+
+        void setParent(LinksPtr p) { _parent = p; }
+
+        LinksPtr getParent() { return _parent; }
+
+        ConstLinksPtr getParent() const { return _parent; }
+
+        // data of balancing policy, color of red black tree or height or rank of AVL and WAVL trees
+        std::uint8_t getBalance() const { return _balance; }
+
+        void setBalance(std::uint8_t balance) { _balance = balance; }
+
+        Color getColor() const { return Color(_balance); }
+
+        void setColor(Color color) { _balance = color; }
+
+        // data of augmentation policy, kept up to date by Map on every structural change
+        AugmentData &getAugment() { return _augment; }
+
+        const AugmentData &getAugment() const { return _augment; }
+
+        // value of node, links have to be part of Node, never guard
+        const auto &getKey() const { return static_cast<const Node *>(this)->getKey(); }
+
+        auto &getItem() { return static_cast<Node *>(this)->getItem(); }
+
+        const auto &getItem() const { return static_cast<const Node *>(this)->getItem(); }
+
+        auto &getPair() { return static_cast<Node *>(this)->getPair(); }
+
+        const auto &getPair() const { return static_cast<const Node *>(this)->getPair(); }
+    };
 
-        void setRight(MapNodePtr p) { _right = p; }
+    /**
+     * Node links with color kept in lowest bit of parent pointer, nodes are at least pointer aligned so this bit is
+     * always zero. Saves padding after color, for small keys and items like Map<int, int> node shrinks by 8 bytes.
+     * Single bit is enough for red black and treap balancing only
+     */
+    template <class Node, class Augment = NoAugmentation> class CompactMapNodeLinks
+    {
+      public:
+        using LinksPtr = CompactMapNodeLinks *;
+        using ConstLinksPtr = const CompactMapNodeLinks *;
+        using AugmentData = typename Augment::Data;
+
+      private:
+        static constexpr std::uintptr_t ColorMask = 1;
+
+        std::uintptr_t _parentColor = 0;
+        LinksPtr _left = nullptr;
+        LinksPtr _right = nullptr;
+        [[no_unique_address]] AugmentData _augment{};
+
+      public:
+        static constexpr unsigned BalanceBits = 1;
+
+        void setRight(LinksPtr p) { _right = p; }
 
-        MapNodePtr getRight() { return _right; }
+        LinksPtr getRight() { return _right; }
 
-        ConstMapNodePtr getRight() const { return _right; }
+        ConstLinksPtr getRight() const { return _right; }
 
         bool isRightEmpty() const { return !_right; }
 
-        void setLeft(MapNodePtr p) { _left = p; }
+        void setLeft(LinksPtr p) { _left = p; }
 
-        MapNodePtr getLeft() { return _left; }
+        LinksPtr getLeft() { return _left; }
 
-        ConstMapNodePtr getLeft() const { return _left; }
+        ConstLinksPtr getLeft() const { return _left; }
 
         bool isLeftEmpty() const { return !_left; }
 
-        void setParent(MapNodePtr p) { _parent = p; }
+        void setParent(LinksPtr p)
+        {
+            _parentColor = reinterpret_cast<std::uintptr_t>(p) | (_parentColor & ColorMask);
+        }
+
+        LinksPtr getParent() { return reinterpret_cast<LinksPtr>(_parentColor & ~ColorMask); }
+
+        ConstLinksPtr getParent() const { return reinterpret_cast<ConstLinksPtr>(_parentColor & ~ColorMask); }
+
+        std::uint8_t getBalance() const { return std::uint8_t(_parentColor & ColorMask); }
+
+        void setBalance(std::uint8_t balance) { _parentColor = (_parentColor & ~ColorMask) | (balance & ColorMask); }
+
+        Color getColor() const { return Color(getBalance()); }
+
+        void setColor(Color color) { setBalance(color); }
+
+        AugmentData &getAugment() { return _augment; }
+
+        const AugmentData &getAugment() const { return _augment; }
+
+        const auto &getKey() const { return static_cast<const Node *>(this)->getKey(); }
+
+        auto &getItem() { return static_cast<Node *>(this)->getItem(); }
+
+        const auto &getItem() const { return static_cast<const Node *>(this)->getItem(); }
+
+        auto &getPair() { return static_cast<Node *>(this)->getPair(); }
+
+        const auto &getPair() const { return static_cast<const Node *>(this)->getPair(); }
+    };
+
+    template <class K, class T, class Augment = NoAugmentation,
+              template <class, class> class NodeLinks = MapNodeLinks>
+    class MapNode : public NodeLinks<MapNode<K, T, Augment, NodeLinks>, Augment>
+    {
+      public:
+        using KeyType = K;
+        using ItemType = T;
+        using Links = NodeLinks<MapNode<K, T, Augment, NodeLinks>, Augment>;
+        using MapNodePtr = MapNode<K, T, Augment, NodeLinks> *;
+        using ConstMapNodePtr = const MapNode<K, T, Augment, NodeLinks> *;
+        using Pair = std::pair<const K, T>;
+
+      private:
+        Pair _keyItem;
+
+      public:
+        MapNode() = delete;
 
-        MapNodePtr getParent() { return _parent; }
+        MapNode(const Pair &p) : _keyItem{p} {}
+        MapNode(Pair &&p) : _keyItem{std::move(p)} {}
+        // constructs pair in place from any arguments accepted by its constructor, also piecewise ones
+        template <class... Args>
+        explicit MapNode(std::in_place_t, Args &&...args) : _keyItem(std::forward<Args>(args)...)
+        {
+        }
+        MapNode(const K &k, const T &i) : _keyItem{k, i} {}
+        MapNode(K &&k, T &&i) : _keyItem{std::move(k), std::move(i)} {}
 
-        ConstMapNodePtr getParent() const { return _parent; }
+        ~MapNode() = default;
 
         const K &getKey() const { return _keyItem.first; }
 
@@ -73,45 +281,57 @@ namespace sd
         std::pair<const K, T> &getPair() { return _keyItem; }
 
         const std::pair<const K, T> &getPair() const { return _keyItem; }
-
-        Color getColor() const { return _color; }
-
-        void setColor(Color color) { _color = color; }
     };
 
-    template <class K, class T> class Map;
-
-    template <class K, class T, bool C, bool R> // C= const, R = Reverse
+    template <class Node, bool C, bool R> // C= const, R = Reverse
     class MapIterator
     {
       public:
         using iterator_category = std::bidirectional_iterator_tag;
-        using value_type = T;
-        using pointer = T *;
-        using reference = T &;
-        using MapNode = std::conditional_t<C, const MapNode<K, T>, MapNode<K, T>>;
-        using MapNodePtr = MapNode *;
-        using Pair = std::conditional_t<C, const std::pair<const K, T>, std::pair<const K, T>>;
+        using value_type = typename Node::ItemType;
+        using pointer = value_type *;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type &;
+        // iterator past end points to guard, which is links part only
+        using LinksType = std::conditional_t<C, const typename Node::Links, typename Node::Links>;
+        using MapNodePtr = LinksType *;
+        using Pair = std::conditional_t<C, const typename Node::Pair, typename Node::Pair>;
         using PairRef = Pair &;
         using PairPtr = Pair *;
 
       protected:
         MapNodePtr _ptr = nullptr;
-        const Map<K, T> *const _parentMap;
+
+        template <class, class, class, template <class> class, class, template <class, class> class, class, class>
+        friend class Map;
+        template <class, bool, bool> friend class MapIterator;
 
       public:
-        MapIterator(const Map<K, T> *const parentMap, MapNodePtr ptr) : _parentMap(parentMap) { _ptr = ptr; }
-        MapIterator(const MapIterator<K, T, C, R> &rawIterator) = default;
+        MapIterator() = default;
+        explicit MapIterator(MapNodePtr ptr) : _ptr(ptr) {}
+        MapIterator(const MapIterator<Node, C, R> &rawIterator) = default;
+
+        // mutable iterator converts to const one
+        template <bool OtherC>
+            requires(C && !OtherC)
+        MapIterator(const MapIterator<Node, OtherC, R> &rawIterator)
+            : _ptr(rawIterator._ptr)
+        {
+        }
         ~MapIterator() = default;
 
-        MapIterator<K, T, C, R> &operator=(const MapIterator<K, T, C, R> &rawIterator) = default;
+        MapIterator<Node, C, R> &operator=(const MapIterator<Node, C, R> &rawIterator) = default;
 
-        operator bool() const { return !_parentMap->isGuard(_ptr); }
+        operator bool() const { return _ptr && !isGuard(_ptr); }
 
-        bool operator==(const MapIterator<K, T, C, R> &rawIterator) const { return _ptr == rawIterator._ptr; }
-        bool operator!=(const MapIterator<K, T, C, R> &rawIterator) const { return _ptr != rawIterator._ptr; }
+        // all guards are end, so end iterators stay equal when maps exchange guards in set operations or split
+        bool operator==(const MapIterator<Node, C, R> &rawIterator) const
+        {
+            return _ptr == rawIterator._ptr || (isEnd(_ptr) && isEnd(rawIterator._ptr));
+        }
+        bool operator!=(const MapIterator<Node, C, R> &rawIterator) const { return !(*this == rawIterator); }
 
-        MapIterator<K, T, C, R> &operator++()
+        MapIterator<Node, C, R> &operator++()
         {
 
             if constexpr (R)
@@ -126,7 +346,7 @@ namespace sd
             return (*this);
         }
 
-        MapIterator<K, T, C, R> &operator--()
+        MapIterator<Node, C, R> &operator--()
         {
             if constexpr (R)
             {
@@ -139,14 +359,14 @@ namespace sd
             return (*this);
         }
 
-        MapIterator<K, T, C, R> operator++(int)
+        MapIterator<Node, C, R> operator++(int)
         {
             auto temp(*this);
             ++*this;
             return temp;
         }
 
-        MapIterator<K, T, C, R> operator--(int)
+        MapIterator<Node, C, R> operator--(int)
         {
             auto temp(*this);
             --*this;
@@ -160,12 +380,20 @@ namespace sd
         PairPtr operator->() const { return &_ptr->getPair(); }
 
       private:
+        /**
+         * Guard is only node linked to itself, it is recognized without pointer to guard of map, so iterators stay
+         * valid when their nodes are moved to other map by merge, set operations or split
+         */
+        static bool isGuard(const typename Node::Links *ptr) { return ptr->getLeft() == ptr; }
+
+        static bool isEnd(const typename Node::Links *ptr) { return ptr && isGuard(ptr); }
+
         void next()
         {
-            if (!_parentMap->isGuard(_ptr->getRight()))
+            if (!isGuard(_ptr->getRight()))
             {
                 _ptr = _ptr->getRight();
-                while (!_parentMap->isGuard(_ptr->getLeft()))
+                while (!isGuard(_ptr->getLeft()))
                 {
                     _ptr = _ptr->getLeft();
                 }
@@ -173,7 +401,7 @@ namespace sd
             else
             {
                 auto y = _ptr->getParent();
-                if (_parentMap->isGuard(y))
+                if (isGuard(y))
                 {
                     _ptr = y;
                 }
@@ -194,10 +422,10 @@ namespace sd
 
         void previous()
         {
-            if (!_parentMap->isGuard(_ptr->getLeft()))
+            if (!isGuard(_ptr->getLeft()))
             {
                 _ptr = _ptr->getLeft();
-                while (!_parentMap->isGuard(_ptr->getRight()))
+                while (!isGuard(_ptr->getRight()))
                 {
                     _ptr = _ptr->getRight();
                 }
@@ -205,7 +433,7 @@ namespace sd
             else
             {
                 auto y = _ptr->getParent();
-                if (_parentMap->isGuard(y))
+                if (isGuard(y))
                 {
                     _ptr = y;
                 }
@@ -225,379 +453,272 @@ namespace sd
         }
     };
 
-    template <class K, class T> class Map
+    /**
+     * Half open range of map iterators, usable in range based for loop
+     */
+    template <class Iterator> class MapRange
     {
       private:
-        friend class MapIterator<K, T, false, false>;
-        friend class MapIterator<K, T, true, false>;
-        friend class MapIterator<K, T, false, true>;
-        friend class MapIterator<K, T, true, true>;
-
-        using MapNodePtr = MapNode<K, T> *;
-        using ConstMapNodePtr = const MapNode<K, T> *;
-
-        using Pair = std::pair<const K, T>;
-
-        int _guard = 0;
-        MapNodePtr _guardPtr = reinterpret_cast<MapNodePtr>(&_guard);
-        MapNodePtr _root = _guardPtr;
-        size_t _size = 0;
+        Iterator _begin;
+        Iterator _end;
 
       public:
-        using Iterator = MapIterator<K, T, false, false>;
-        using ConstIterator = MapIterator<K, T, true, false>;
-
-        using ReverseIterator = MapIterator<K, T, false, true>;
-        using ConstReverseIterator = MapIterator<K, T, true, true>;
+        MapRange(Iterator begin, Iterator end) : _begin(begin), _end(end) {}
 
-        // Constructors
-        Map() = default;
-
-        template <class InputIt> Map(InputIt first, InputIt last) { insert(first, last); }
+        Iterator begin() const { return _begin; }
+        Iterator end() const { return _end; }
 
-        Map(const Map<K, T> &other) { insert(other.begin(), other.end()); }
+        bool empty() const { return _begin == _end; }
+    };
 
-        Map(Map<K, T> &&other)
-        {
-            _root = other._root;
-            _size = other._size;
-            _guardPtr = other._guardPtr;
-            other._root = other._guardPtr;
-            other._size = 0;
-        }
+    /**
+     * Owns node extracted from map, node can be inserted back to any map with same node type without allocation
+     * or copying of key and item. Node not inserted anywhere is destroyed with handle
+     */
+    template <class Node, class NodeAllocator> class MapNodeHandle
+    {
+      private:
+        Node *_node = nullptr;
 
-        Map(std::initializer_list<Pair> init) { insert(init); }
+        template <class, class, class, template <class> class, class, template <class, class> class, class, class>
+        friend class Map;
 
-        ~Map() { clear(); }
+        explicit MapNodeHandle(Node *node) : _node(node) {}
 
-        // Assign
-        Map<K, T> &operator=(const Map<K, T> &other)
-        {
-            clear();
-            insert(other.begin(), other.end());
-            return *this;
-        }
+      public:
+        MapNodeHandle() = default;
+        MapNodeHandle(const MapNodeHandle &) = delete;
+        MapNodeHandle(MapNodeHandle &&other) : _node(std::exchange(other._node, nullptr)) {}
 
-        Map<K, T> &operator=(Map<K, T> &&other)
+        MapNodeHandle &operator=(const MapNodeHandle &) = delete;
+        MapNodeHandle &operator=(MapNodeHandle &&other)
         {
-            clear();
-            _root = other._root;
-            _size = other._size;
-            _guardPtr = other._guardPtr;
-            other._root = other._guardPtr;
-            other._size = 0;
+            if (this != &other)
+            {
+                reset();
+                _node = std::exchange(other._node, nullptr);
+            }
             return *this;
         }
 
-        Map<K, T> &operator=(std::initializer_list<Pair> ilist)
-        {
-            clear();
-            insert(ilist);
-            return *this;
-        }
+        ~MapNodeHandle() { reset(); }
 
-        // Element access
-        T &at(const K &key)
-        {
-            auto node = findNode(key);
-            assertNode(node);
-            return node->getItem();
-        }
+        bool empty() const { return !_node; }
 
-        const T &at(const K &key) const
-        {
-            auto node = findConstNode(key);
-            assertNode(node);
-            return node->getItem();
-        }
+        operator bool() const { return _node; }
 
-        T &operator[](const K &key) { return at(key); }
+        const typename Node::KeyType &key() const { return _node->getKey(); }
 
-        const T &operator[](const K &key) const { return at(key); }
+        typename Node::ItemType &item() { return _node->getItem(); }
 
-        // Modifiers
-        std::pair<Iterator, bool> insert(const Pair &value) { return insertNode(makeNode(value)); }
-        std::pair<Iterator, bool> insert(Pair &&value) { return insertNode(makeNode(value)); }
+        const typename Node::ItemType &item() const { return _node->getItem(); }
 
-        template <class InputIt> void insert(InputIt first, InputIt last)
+      private:
+        void reset()
         {
-            for (auto it = first; it != last; ++it)
+            if (_node)
             {
-                insertNode(makeNode(*it));
+                std::destroy_at(_node);
+                NodeAllocator{}.deallocate(_node);
+                _node = nullptr;
             }
         }
 
-        void insert(const std::initializer_list<Pair> &ilist)
+        Node *release() { return std::exchange(_node, nullptr); }
+    };
+
+    /**
+     * Comparator returning ordering (like std::compare_three_way) instead of bool
+     */
+    template <class Compare, class L, class R>
+    concept ThreeWayComparator = requires(const Compare &compare, const L &lhs, const R &rhs) {
         {
-            auto end = ilist.end();
-            for (auto it = ilist.begin(); it != end; ++it)
-            {
-                insertNode(makeNode(*it));
-            }
-        }
+            compare(lhs, rhs)
+        } -> std::convertible_to<std::weak_ordering>;
+    };
 
-        // template <class... Args1, class... Args2> void
-        // emplace(std::tuple<Args1...> args1, std::tuple<Args2...> args2)
-        // {
-        //     insertNode(makeNodeWithItem(args1, args2));
-        // }
+    /**
+     * Comparator marked with is_transparent, allows lookups with types other than key type
+     */
+    template <class Compare>
+    concept TransparentComparator = requires { typename Compare::is_transparent; };
 
-        void remove(const K &key)
-        {
-            auto node = findNode(key);
-            assertNode(node);
-            removeNode(node);
-        }
+    template <class Compare, class Key, class K>
+    concept TransparentKey = TransparentComparator<Compare> && std::invocable<const Compare &, const Key &, const K &> &&
+                             std::invocable<const Compare &, const K &, const Key &>;
 
-        void swap(Map<K, T> &other)
-        {
-            auto tmp{std::move(*this)};
-            *this = std::move(other);
-            other = std::move(tmp);
-        }
+    /**
+     * Tag telling Map that input range is already sorted by key and has no duplicated keys
+     */
+    struct SortedUniqueTag
+    {
+    };
+    inline constexpr SortedUniqueTag sortedUnique{};
 
-        void clear()
-        {
-            removeAllNodes(_root);
-            _root = _guardPtr;
-            _size = 0;
-        }
+    /**
+     * Tag selecting fork join variant of Map set operations, independent subtrees are processed on separate threads
+     */
+    struct ParallelTag
+    {
+    };
+    inline constexpr ParallelTag parallel{};
+
+    /**
+     * Work counters and shape of Map returned by Map::stats. Counters are totals since map was created or stats
+     * were reset, operation starts with every key search or pop, rotations and recolorings of rebalancing after
+     * insert or remove count for operation which found the place
+     */
+    struct MapStatistics
+    {
+        std::uint64_t operations = 0;
+        std::uint64_t comparisons = 0;
+        std::uint64_t rotations = 0;
+        std::uint64_t recolorings = 0;
+        std::uint64_t nodeVisits = 0;
+        // most nodes visited by single operation, long searches reveal skewed or adversarial key distributions
+        std::uint64_t maxOperationVisits = 0;
+
+        size_t size = 0;
+        // longest search path seen since reset, so lower bound of tree height, exact one is given by Map::checkShape
+        size_t height = 0;
+        // black nodes on path to leftmost leaf, same on every path while red black invariants hold
+        size_t blackHeight = 0;
+    };
 
-        // LookUp
-        Iterator find(const K &key) { return Iterator{findNode(key)}; }
+    // shape of Map tree measured by Map::checkShape
+    struct MapShape
+    {
+        size_t height = 0;
+        // black nodes on every path to leaf, only red black trees have it
+        size_t blackHeight = 0;
+        // whether red black invariants hold, always true for other trees
+        bool balanced = true;
+    };
 
-        bool contains(const K &key) { return !isGuard(findNode(key)); }
+    /**
+     * Default stats policy of Map, counting calls are empty and compile away, Map::stats reports only size and
+     * black height
+     */
+    struct NoMapStats
+    {
+        void operation() {}
+        void compared() {}
+        void visited() {}
+        void rotated() {}
+        void recolored() {}
 
-        // Capacity
-        size_t size() const { return _size; }
+        MapStatistics counters() const { return {}; }
 
-        bool empty() const { return size() == 0; }
+        void reset() {}
+    };
 
-        // Iterators
-        Iterator begin() { return Iterator{this, minimum(_root)}; }
-        Iterator end() { return Iterator{this, _guardPtr}; }
+    /**
+     * Stats policy counting work done by Map operations. Counters are relaxed atomics updated without read modify
+     * write, so concurrent lookups do not race and add no locked instructions, but may lose some counts
+     */
+    class MapStats
+    {
+      private:
+        using Counter = std::atomic<std::uint64_t>;
 
-        ConstIterator begin() const { return ConstIterator{this, const_cast<MapNodePtr>(minimum(_root))}; }
-        ConstIterator end() const { return ConstIterator{this, const_cast<MapNodePtr>(_guardPtr)}; }
+        Counter _operations = 0;
+        Counter _comparisons = 0;
+        Counter _rotations = 0;
+        Counter _recolorings = 0;
+        Counter _nodeVisits = 0;
+        Counter _operationVisits = 0;
+        Counter _maxOperationVisits = 0;
 
-        ConstIterator cBegin() const { return ConstIterator{this, minimum(const_cast<MapNodePtr>(_root))}; }
-        ConstIterator cEnd() const { return ConstIterator{this, const_cast<MapNodePtr>(_guardPtr)}; }
+        static std::uint64_t load(const Counter &counter) { return counter.load(std::memory_order_relaxed); }
 
-        ReverseIterator rBegin() { return ReverseIterator{this, maximum(_root)}; }
-        ReverseIterator rEnd() { return ReverseIterator{this, _guardPtr}; }
+        static void store(Counter &counter, std::uint64_t value) { counter.store(value, std::memory_order_relaxed); }
 
-        ConstReverseIterator rBegin() const
-        {
-            return ConstReverseIterator{this, const_cast<MapNodePtr>(maximum(_root))};
-        }
-        ConstReverseIterator rEnd() const { return ConstReverseIterator{this, const_cast<MapNodePtr>(_guardPtr)}; }
+        static void add(Counter &counter) { store(counter, load(counter) + 1); }
 
-        ConstReverseIterator crBegin() const
+      public:
+        // visits of finished operation are added to total here, so each visit updates single counter
+        void operation()
         {
-            return ConstReverseIterator{this, const_cast<MapNodePtr>(maximum(_root))};
+            auto visits = load(_operationVisits);
+            store(_nodeVisits, load(_nodeVisits) + visits);
+            store(_maxOperationVisits, std::max(load(_maxOperationVisits), visits));
+            store(_operationVisits, 0);
+            add(_operations);
         }
-        ConstReverseIterator crEnd() const { return ConstReverseIterator{this, const_cast<MapNodePtr>(_guardPtr)}; }
 
-      private:
-        MapNodePtr findNode(const K &key) { return const_cast<MapNodePtr>(findConstNode(key)); }
+        void compared() { add(_comparisons); }
+
+        void visited() { add(_operationVisits); }
 
-        ConstMapNodePtr findConstNode(const K &key) const
+        void rotated() { add(_rotations); }
+
+        void recolored() { add(_recolorings); }
+
+        MapStatistics counters() const
         {
-            auto ptr = _root;
-            while (!isGuard(ptr))
-            {
-                if (key < ptr->getKey())
-                {
-                    ptr = ptr->getLeft();
-                }
-                else if (key > ptr->getKey())
-                {
-                    ptr = ptr->getRight();
-                }
-                else
-                {
-                    return ptr;
-                }
-            }
-            return _guardPtr;
+            MapStatistics stats;
+            stats.operations = load(_operations);
+            stats.comparisons = load(_comparisons);
+            stats.rotations = load(_rotations);
+            stats.recolorings = load(_recolorings);
+            stats.nodeVisits = load(_nodeVisits) + load(_operationVisits);
+            stats.maxOperationVisits = std::max(load(_maxOperationVisits), load(_operationVisits));
+            return stats;
         }
 
-        MapNodePtr minimum(MapNodePtr ptr) const
+        void reset()
         {
-            if (!isGuard(ptr))
+            for (auto counter : {&_operations, &_comparisons, &_rotations, &_recolorings, &_nodeVisits,
+                                 &_operationVisits, &_maxOperationVisits})
             {
-                while (!isGuard(ptr->getLeft()))
-                {
-                    ptr = ptr->getLeft();
-                }
+                store(*counter, 0);
             }
-            return ptr;
         }
+    };
 
-        MapNodePtr maximum(MapNodePtr ptr) const
+    /**
+     * Balancing policies decide shape of Map tree. Policy gets map as tree and uses its rotations and helpers:
+     * attached rebalances after new leaf was linked, unlink takes node out, build makes tree of sorted range and
+     * join links two trees with node between them, split and set operations are built on join only.
+     * Subtree rank (black height, height, rank or priority level) orders joins and sizes parallel work
+     */
+
+    /**
+     * Red black tree, one bit of color per node, height at most 2 log n and at most three rotations per update
+     */
+    struct RedBlackBalance
+    {
+        static constexpr unsigned Bits = 1;
+        // subtrees with smaller black height are not worth a thread
+        static constexpr size_t ParallelMinRank = 8;
+        static constexpr bool CopyableShape = true;
+
+        // changes color of node already in tree, so stats count only real changes
+        template <class Tree, class Node> static void recolor(Tree &tree, Node *node, Color color)
         {
-            if (!isGuard(ptr))
+            if (node->getColor() != color)
             {
-                while (!isGuard(ptr->getRight()))
-                {
-                    ptr = ptr->getRight();
-                }
+                tree._stats.recolored();
             }
-            return ptr;
+            node->setColor(color);
         }
 
-        MapNodePtr succesor(MapNodePtr ptr)
+        template <class Tree, class Node> static void attached(Tree &tree, Node *node)
         {
-            MapNodePtr r;
+            Node *Y;
 
-            if (!isGuard(ptr))
+            node->setColor(Color::Red);
+            while ((node != tree._root) && (node->getParent()->getColor() == Color::Red))
             {
-                if (!isGuard(ptr->getRight()))
-                    return minimum(ptr->getRight());
-                else
-                {
-                    r = ptr->getParent();
-                    while (!isGuard(r) && (ptr == r->getRight()))
-                    {
-                        ptr = r;
-                        r = r->getParent();
-                    }
-                    return r;
-                }
-            }
-            return _guardPtr;
-        }
-
-        void rotateLeft(MapNodePtr A)
-        {
-            MapNodePtr B, p;
-
-            B = A->getRight();
-            if (!isGuard(B))
-            {
-                p = A->getParent();
-                A->setRight(B->getLeft());
-                if (!isGuard(A->getRight()))
-                {
-                    A->getRight()->setParent(A);
-                }
-
-                B->setLeft(A);
-                B->setParent(p);
-                A->setParent(B);
-
-                if (!isGuard(p))
-                {
-                    if (p->getLeft() == A)
-                    {
-
-                        p->setLeft(B);
-                    }
-                    else
-                    {
-
-                        p->setRight(B);
-                    }
-                }
-                else
-                {
-
-                    _root = B;
-                }
-            }
-        }
-
-        void rotateRight(MapNodePtr A)
-        {
-            MapNodePtr B, p;
-
-            B = A->getLeft();
-            if (!isGuard(B))
-            {
-                p = A->getParent();
-                A->setLeft(B->getRight());
-                if (!isGuard(A->getLeft()))
-                {
-                    A->getLeft()->setParent(A);
-                }
-
-                B->setRight(A);
-                B->setParent(p);
-                A->setParent(B);
-
-                if (!isGuard(p))
-                {
-                    if (p->getLeft() == A)
-                    {
-
-                        p->setLeft(B);
-                    }
-                    else
-                    {
-
-                        p->setRight(B);
-                    }
-                }
-                else
-                {
-
-                    _root = B;
-                }
-            }
-        }
-
-        std::pair<Iterator, bool> insertNode(MapNodePtr node)
-        {
-            MapNodePtr Y;
-
-            auto &key = node->getKey();
-            node->setLeft(_guardPtr);
-            node->setRight(_guardPtr);
-            node->setParent(_root);
-
-            if (isGuard(node->getParent()))
-                _root = node;
-            else
-                while (true)
-                {
-                    if (key < node->getParent()->getKey())
-                    {
-                        if (isGuard(node->getParent()->getLeft()))
-                        {
-                            node->getParent()->setLeft(node);
-                            break;
-                        }
-                        node->setParent(node->getParent()->getLeft());
-                    }
-                    else if (key > node->getParent()->getKey())
-                    {
-                        if (isGuard(node->getParent()->getRight()))
-                        {
-                            node->getParent()->setRight(node);
-                            break;
-                        }
-                        node->setParent(node->getParent()->getRight());
-                    }
-                    else
-                    {
-
-                        std::pair<Iterator, bool> res = {Iterator{this, node->getParent()}, false};
-                        deleteNode(node);
-                        return res;
-                    }
-                }
-            node->setColor(Color::Red);
-            while ((node != _root) && (node->getParent()->getColor() == Color::Red))
-            {
-                if (node->getParent() == node->getParent()->getParent()->getLeft())
+                if (node->getParent() == node->getParent()->getParent()->getLeft())
                 {
                     Y = node->getParent()->getParent()->getRight();
 
                     if (Y->getColor() == Color::Red)
                     {
-                        node->getParent()->setColor(Color::Black);
-                        Y->setColor(Color::Black);
-                        node->getParent()->getParent()->setColor(Color::Red);
+                        recolor(tree, node->getParent(), Color::Black);
+                        recolor(tree, Y, Color::Black);
+                        recolor(tree, node->getParent()->getParent(), Color::Red);
                         node = node->getParent()->getParent();
                         continue;
                     }
@@ -605,13 +726,13 @@ namespace sd
                     if (node == node->getParent()->getRight())
                     {
                         node = node->getParent();
-                        rotateLeft(node);
+                        tree.rotateLeft(node);
                     }
 
-                    node->getParent()->setColor(Color::Black);
-                    node->getParent()->getParent()->setColor(Color::Red);
+                    recolor(tree, node->getParent(), Color::Black);
+                    recolor(tree, node->getParent()->getParent(), Color::Red);
 
-                    rotateRight(node->getParent()->getParent());
+                    tree.rotateRight(node->getParent()->getParent());
                     break;
                 }
                 else
@@ -621,9 +742,9 @@ namespace sd
                     if (Y->getColor() == Color::Red)
                     {
 
-                        node->getParent()->setColor(Color::Black);
-                        Y->setColor(Color::Black);
-                        node->getParent()->getParent()->setColor(Color::Red);
+                        recolor(tree, node->getParent(), Color::Black);
+                        recolor(tree, Y, Color::Black);
+                        recolor(tree, node->getParent()->getParent(), Color::Red);
 
                         node = node->getParent()->getParent();
                         continue;
@@ -632,111 +753,60 @@ namespace sd
                     if (node == node->getParent()->getLeft())
                     {
                         node = node->getParent();
-                        rotateRight(node);
+                        tree.rotateRight(node);
                     }
-                    node->getParent()->setColor(Color::Black);
-                    node->getParent()->getParent()->setColor(Color::Red);
+                    recolor(tree, node->getParent(), Color::Black);
+                    recolor(tree, node->getParent()->getParent(), Color::Red);
 
-                    rotateLeft(node->getParent()->getParent());
+                    tree.rotateLeft(node->getParent()->getParent());
                     break;
                 }
             }
-            _root->setColor(Color::Black);
-            ++_size;
-            return {Iterator{this, node}, true};
+            recolor(tree, tree._root, Color::Black);
         }
 
-        void removeNode(MapNodePtr node)
+        template <class Tree, class Node> static void unlink(Tree &tree, Node *node)
         {
-            MapNodePtr W, Y, Z;
-
-            if (isGuard(node->getLeft()) || isGuard(node->getRight()))
-            {
-                Y = node;
-            }
-            else
-            {
-                Y = succesor(node);
-            }
-
-            if (!isGuard(Y->getLeft()))
-            {
-                Z = Y->getLeft();
-            }
-            else
-            {
-                Z = Y->getRight();
-            }
-
-            Z->setParent(Y->getParent());
-
-            if (isGuard(Y->getParent()))
-            {
-                _root = Z;
-            }
-            else if (Y == Y->getParent()->getLeft())
-            {
-                Y->getParent()->setLeft(Z);
-            }
-            else
-            {
-                Y->getParent()->setRight(Z);
-            }
+            auto removed = tree.spliceNode(node);
+            auto Z = removed.child;
+            Node *W;
 
-            if (Y != node)
+            if (removed.balance == Color::Black)
             {
-                auto color = node->getColor();
-                auto left = node->getLeft();
-                auto right = node->getRight();
-                auto parent = node->getParent();
-
-                node->setColor(Y->getColor());
-                node->setParent(Y->getParent());
-                node->setLeft(Y->getLeft());
-                node->setRight(Y->getRight());
-
-                Y->setColor(color);
-                Y->setParent(parent);
-                Y->setLeft(left);
-                Y->setRight(right);
-
-                Y = node;
-            }
-
-            if (Y->getColor() == Color::Black)
-                while ((Z != _root) && (Z->getColor() == Color::Black))
+                while ((Z != tree._root) && (Z->getColor() == Color::Black))
+                {
                     if (Z == Z->getParent()->getLeft())
                     {
                         W = Z->getParent()->getRight();
 
                         if (W->getColor() == Color::Red)
                         {
-                            W->setColor(Color::Black);
-                            Z->getParent()->setColor(Color::Red);
-                            rotateLeft(Z->getParent());
+                            recolor(tree, W, Color::Black);
+                            recolor(tree, Z->getParent(), Color::Red);
+                            tree.rotateLeft(Z->getParent());
                             W = Z->getParent()->getRight();
                         }
 
                         if ((W->getLeft()->getColor() == Color::Black) && (W->getRight()->getColor() == Color::Black))
                         {
-                            W->setColor(Color::Red);
+                            recolor(tree, W, Color::Red);
                             Z = Z->getParent();
                             continue;
                         }
 
                         if (W->getRight()->getColor() == Color::Black)
                         { // Przypadek 3
-                            W->getLeft()->setColor(Color::Black);
-                            W->setColor(Color::Red);
-                            rotateRight(W);
+                            recolor(tree, W->getLeft(), Color::Black);
+                            recolor(tree, W, Color::Red);
+                            tree.rotateRight(W);
                             W = Z->getParent()->getRight();
                         }
 
-                        W->setColor(Z->getParent()->getColor());
-                        Z->getParent()->setColor(Color::Black);
-                        W->getRight()->setColor(Color::Black);
-                        rotateLeft(Z->getParent());
-                        Z = _root;
+                        recolor(tree, W, Z->getParent()->getColor());
+                        recolor(tree, Z->getParent(), Color::Black);
+                        recolor(tree, W->getRight(), Color::Black);
+                        tree.rotateLeft(Z->getParent());
+                        Z = tree._root;
                     }
                     else
                     {
@@ -744,109 +814,3036 @@ namespace sd
 
                         if (W->getColor() == Color::Red)
                         {
-                            W->setColor(Color::Black);
-                            Z->getParent()->setColor(Color::Red);
-                            rotateRight(Z->getParent());
+                            recolor(tree, W, Color::Black);
+                            recolor(tree, Z->getParent(), Color::Red);
+                            tree.rotateRight(Z->getParent());
                             W = Z->getParent()->getLeft();
                         }
 
                         if ((W->getLeft()->getColor() == Color::Black) && (W->getRight()->getColor() == Color::Black))
                         {
-                            W->setColor(Color::Red);
+                            recolor(tree, W, Color::Red);
                             Z = Z->getParent();
                             continue;
                         }
 
-                        if (W->getLeft()->getColor() == Color::Red)
+                        if (W->getLeft()->getColor() == Color::Black)
                         {
-                            W->getRight()->setColor(Color::Black);
-                            W->setColor(Color::Red);
-                            rotateLeft(W);
+                            recolor(tree, W->getRight(), Color::Black);
+                            recolor(tree, W, Color::Red);
+                            tree.rotateLeft(W);
                             W = Z->getParent()->getLeft();
                         }
 
-                        W->setColor(Z->getParent()->getColor());
-                        Z->getParent()->setColor(Color::Black);
-                        W->getLeft()->setColor(Color::Black);
-                        rotateRight(Z->getParent());
-                        Z = _root;
+                        recolor(tree, W, Z->getParent()->getColor());
+                        recolor(tree, Z->getParent(), Color::Black);
+                        recolor(tree, W->getLeft(), Color::Black);
+                        tree.rotateRight(Z->getParent());
+                        Z = tree._root;
                     }
+                }
+            }
 
-            Z->setColor(Color::Black);
+            recolor(tree, Z, Color::Black);
+        }
 
-            deleteNode(Y);
-            --_size;
+        /**
+         * All levels except the deepest one are full, nodes on the deepest incomplete level are red,
+         * so every path has the same black height
+         */
+        template <class Tree, class InputIt> static auto build(Tree &tree, InputIt &it, size_t count)
+        {
+            auto redDepth = size_t(std::bit_width(count + 1) - 1);
+            auto finish = [&](auto node, size_t depth) {
+                node->setColor(depth == redDepth ? Color::Red : Color::Black);
+            };
+            return tree.buildBalanced(it, count, 0, finish);
         }
 
-        void removeAllNodes(MapNodePtr ptr)
+        // black height, paths to all leafs have the same one
+        template <class Tree, class Node> static size_t subtreeRank(const Tree &tree, const Node *ptr)
         {
-            if (!isGuard(ptr))
+            size_t height = 0;
+            for (; !tree.isGuard(ptr); ptr = ptr->getLeft())
             {
-                removeAllNodes(ptr->getLeft());
-                removeAllNodes(ptr->getRight());
-                deleteNode(ptr);
+                height += ptr->getColor() == Color::Black;
             }
+            return height;
         }
 
-        void assertNode(ConstMapNodePtr ptr) const
+        template <class Tree, class Subtree, class Node>
+        static size_t childRank(const Tree &, Subtree parent, const Node *)
         {
-            if (isGuard(ptr))
+            return parent.rank - (parent.root->getColor() == Color::Black);
+        }
+
+        template <class Tree, class Node> static void finishRoot(Tree &, Node *root) { root->setColor(Color::Black); }
+
+        /**
+         * Taller tree is descended along its inner spine to subtree of same black height, node is linked there
+         * as red and red-red violations are fixed with rotations on way back, see "Just Join for Parallel
+         * Ordered Sets"
+         */
+        template <class Tree, class Subtree, class Node>
+        static Subtree join(Tree &tree, Subtree left, Node *node, Subtree right)
+        {
+            if (left.rank > right.rank)
             {
-                throw std::out_of_range("Item was not found");
+                auto root = joinRight(tree, left, node, right);
+                if (root->getColor() == Color::Red && root->getRight()->getColor() == Color::Red)
+                {
+                    recolor(tree, root, Color::Black);
+                    return {root, left.rank + 1};
+                }
+                return {root, left.rank};
+            }
+            if (left.rank < right.rank)
+            {
+                auto root = joinLeft(tree, left, node, right);
+                if (root->getColor() == Color::Red && root->getLeft()->getColor() == Color::Red)
+                {
+                    recolor(tree, root, Color::Black);
+                    return {root, right.rank + 1};
+                }
+                return {root, right.rank};
+            }
+            tree.setChildren(node, left.root, right.root);
+            if (left.root->getColor() == Color::Black && right.root->getColor() == Color::Black)
+            {
+                node->setColor(Color::Red);
+                return {node, left.rank};
             }
+            node->setColor(Color::Black);
+            return {node, left.rank + 1};
         }
 
-        void assertEmpty() const
+        template <class Tree, class Subtree, class Node>
+        static Node *joinRight(Tree &tree, Subtree left, Node *node, Subtree right)
         {
-            if (empty())
+            auto top = left.root;
+            if (top->getColor() == Color::Black && left.rank == right.rank)
+            {
+                node->setColor(Color::Red);
+                tree.setChildren(node, top, right.root);
+                return node;
+            }
+            auto joined = joinRight(tree, Subtree{top->getRight(), childRank(tree, left, top)}, node, right);
+            top->setRight(joined);
+            joined->setParent(top);
+            if (top->getColor() == Color::Black && joined->getColor() == Color::Red &&
+                joined->getRight()->getColor() == Color::Red)
             {
-                throw std::runtime_error("List is empty");
+                recolor(tree, joined->getRight(), Color::Black);
+                return tree.rotateLeftDetached(top);
             }
+            Tree::updateNode(top);
+            return top;
         }
 
-        bool isGuard(ConstMapNodePtr const ptr) const { return ptr == _guardPtr; }
+        template <class Tree, class Subtree, class Node>
+        static Node *joinLeft(Tree &tree, Subtree left, Node *node, Subtree right)
+        {
+            auto top = right.root;
+            if (top->getColor() == Color::Black && left.rank == right.rank)
+            {
+                node->setColor(Color::Red);
+                tree.setChildren(node, left.root, top);
+                return node;
+            }
+            auto joined = joinLeft(tree, left, node, Subtree{top->getLeft(), childRank(tree, right, top)});
+            top->setLeft(joined);
+            joined->setParent(top);
+            if (top->getColor() == Color::Black && joined->getColor() == Color::Red &&
+                joined->getLeft()->getColor() == Color::Red)
+            {
+                recolor(tree, joined->getLeft(), Color::Black);
+                return tree.rotateRightDetached(top);
+            }
+            Tree::updateNode(top);
+            return top;
+        }
+    };
+
+    /**
+     * AVL tree, heights of sibling subtrees differ by at most one, so height is at most 1.44 log n. Searches are
+     * shorter than in red black tree at cost of more rotations on insert and remove, suits read mostly maps
+     */
+    struct AvlBalance
+    {
+        static constexpr unsigned Bits = 8;
+        static constexpr size_t ParallelMinRank = 12;
+        static constexpr bool CopyableShape = true;
+
+        // height is kept in node, guard data is never written so its height is 0
+        template <class Node> static size_t height(const Node *node) { return node->getBalance(); }
+
+        template <class Node> static void updateHeight(Node *node)
+        {
+            node->setBalance(std::uint8_t(std::max(height(node->getLeft()), height(node->getRight())) + 1));
+        }
+
+        template <class Tree, class Node> static void attached(Tree &tree, Node *node)
+        {
+            node->setBalance(1);
+            retrace(tree, node->getParent());
+        }
+
+        template <class Tree, class Node> static void unlink(Tree &tree, Node *node)
+        {
+            retrace(tree, tree.spliceNode(node).parent);
+        }
+
+        // fixes heights and balance from ptr up, stops at first subtree which height did not change
+        template <class Tree, class Node> static void retrace(Tree &tree, Node *ptr)
+        {
+            while (!tree.isGuard(ptr))
+            {
+                auto before = height(ptr);
+                ptr = rebalance(tree, ptr);
+                if (height(ptr) == before)
+                {
+                    return;
+                }
+                ptr = ptr->getParent();
+            }
+        }
+
+        // single or double rotation when heights of children differ by two, returns new root of subtree
+        template <class Tree, class Node> static Node *rebalance(Tree &tree, Node *node)
+        {
+            auto left = node->getLeft(), right = node->getRight();
+            if (height(left) > height(right) + 1)
+            {
+                if (height(left->getLeft()) < height(left->getRight()))
+                {
+                    tree.rotateLeft(left);
+                    updateHeight(left);
+                }
+                tree.rotateRight(node);
+            }
+            else if (height(right) > height(left) + 1)
+            {
+                if (height(right->getRight()) < height(right->getLeft()))
+                {
+                    tree.rotateRight(right);
+                    updateHeight(right);
+                }
+                tree.rotateLeft(node);
+            }
+            else
+            {
+                updateHeight(node);
+                return node;
+            }
+            updateHeight(node);
+            updateHeight(node->getParent());
+            return node->getParent();
+        }
+
+        // perfectly balanced tree, every node gets its height
+        template <class Tree, class InputIt> static auto build(Tree &tree, InputIt &it, size_t count)
+        {
+            auto finish = [](auto node, size_t) { updateHeight(node); };
+            return tree.buildBalanced(it, count, 0, finish);
+        }
 
-        MapNodePtr makeNode(const K &key, const T &item) { return new MapNode<K, T>(key, item); }
+        template <class Tree, class Node> static size_t subtreeRank(const Tree &, const Node *ptr)
+        {
+            return height(ptr);
+        }
 
-        MapNodePtr makeNode(K &&key, T &&item) { return new MapNode<K, T>(std::move(key), std::move(item)); }
+        template <class Tree, class Subtree, class Node>
+        static size_t childRank(const Tree &, Subtree, const Node *child)
+        {
+            return height(child);
+        }
 
-        MapNodePtr makeNode(Pair &&pair) { return new MapNode<K, T>(std::move(pair)); }
+        template <class Tree, class Node> static void finishRoot(Tree &, Node *) {}
 
-        MapNodePtr makeNode(const Pair &pair) { return new MapNode<K, T>(pair); }
+        // taller tree is descended along its inner spine to subtree at most one higher than other tree
+        template <class Tree, class Subtree, class Node>
+        static Subtree join(Tree &tree, Subtree left, Node *node, Subtree right)
+        {
+            Node *root = node;
+            if (height(left.root) > height(right.root) + 1)
+            {
+                root = joinRight(tree, left.root, node, right.root);
+            }
+            else if (height(right.root) > height(left.root) + 1)
+            {
+                root = joinLeft(tree, left.root, node, right.root);
+            }
+            else
+            {
+                tree.setChildren(node, left.root, right.root);
+                updateHeight(node);
+            }
+            return {root, height(root)};
+        }
 
-        // template <class... Args1, class... Args2>
-        // MapNodePtr makeNodeWithItem(std::tuple<Args1...> args1,
-        // std::tuple<Args2...> args2)
-        // {
-        //     return new MapNode<K, T>(args1, args2);
-        // }
+        template <class Tree, class Node> static Node *joinRight(Tree &tree, Node *top, Node *node, Node *right)
+        {
+            auto inner = top->getRight();
+            auto joined = node;
+            if (height(inner) <= height(right) + 1)
+            {
+                tree.setChildren(node, inner, right);
+                updateHeight(node);
+            }
+            else
+            {
+                joined = joinRight(tree, inner, node, right);
+            }
+            tree.setChildren(top, top->getLeft(), joined);
+            if (height(joined) <= height(top->getLeft()) + 1)
+            {
+                updateHeight(top);
+                return top;
+            }
+            if (height(joined->getLeft()) > height(joined->getRight()))
+            {
+                joined = tree.rotateRightDetached(joined);
+                updateHeight(joined->getRight());
+                updateHeight(joined);
+                tree.setChildren(top, top->getLeft(), joined);
+            }
+            auto root = tree.rotateLeftDetached(top);
+            updateHeight(top);
+            updateHeight(root);
+            return root;
+        }
 
-        void deleteNode(MapNodePtr ptr) { delete ptr; }
+        template <class Tree, class Node> static Node *joinLeft(Tree &tree, Node *left, Node *node, Node *top)
+        {
+            auto inner = top->getLeft();
+            auto joined = node;
+            if (height(inner) <= height(left) + 1)
+            {
+                tree.setChildren(node, left, inner);
+                updateHeight(node);
+            }
+            else
+            {
+                joined = joinLeft(tree, left, node, inner);
+            }
+            tree.setChildren(top, joined, top->getRight());
+            if (height(joined) <= height(top->getRight()) + 1)
+            {
+                updateHeight(top);
+                return top;
+            }
+            if (height(joined->getRight()) > height(joined->getLeft()))
+            {
+                joined = tree.rotateLeftDetached(joined);
+                updateHeight(joined->getLeft());
+                updateHeight(joined);
+                tree.setChildren(top, joined, top->getRight());
+            }
+            auto root = tree.rotateRightDetached(top);
+            updateHeight(top);
+            updateHeight(root);
+            return root;
+        }
     };
 
-    template <class K, class T> bool operator==(const Map<K, T> &lhs, const Map<K, T> &rhs)
+    /**
+     * Weak AVL tree (Haeupler, Sen, Tarjan "Rank-Balanced Trees"), every node has rank which differs from rank
+     * of its children by 1 or 2 and leafs have rank 0. Built by inserts only it is AVL tree, removals never do
+     * more than two rotations and keep height below 2 log n
+     */
+    struct WavlBalance
     {
-        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
-    }
+        static constexpr unsigned Bits = 8;
+        static constexpr size_t ParallelMinRank = 12;
+        static constexpr bool CopyableShape = true;
 
-    template <class K, class T> bool operator!=(const Map<K, T> &lhs, const Map<K, T> &rhs) { return !(lhs == rhs); }
+        // rank plus one is kept in node, so guard which data is never written has rank -1 of missing node
+        template <class Node> static int rank(const Node *node) { return node->getBalance(); }
+
+        template <class Node> static int difference(const Node *parent, const Node *child)
+        {
+            return rank(parent) - rank(child);
+        }
+
+        template <class Node> static void promote(Node *node) { node->setBalance(node->getBalance() + 1); }
+
+        template <class Node> static void demote(Node *node) { node->setBalance(node->getBalance() - 1); }
+
+        template <class Tree, class Node> static bool isLeaf(const Tree &tree, const Node *node)
+        {
+            return tree.isGuard(node->getLeft()) && tree.isGuard(node->getRight());
+        }
+
+        template <class Tree, class Node> static void attached(Tree &tree, Node *node)
+        {
+            node->setBalance(1);
+            // node is 0-child, promotions move violation up until one single or double rotation ends it
+            for (auto parent = node->getParent(); !tree.isGuard(parent) && rank(parent) == rank(node);
+                 parent = node->getParent())
+            {
+                auto left = parent->getLeft() == node;
+                if (difference(parent, left ? parent->getRight() : parent->getLeft()) == 1)
+                {
+                    promote(parent);
+                    node = parent;
+                    continue;
+                }
+                auto inner = left ? node->getRight() : node->getLeft();
+                if (difference(node, inner) == 2)
+                {
+                    tree.rotateUp(node);
+                    demote(parent);
+                }
+                else
+                {
+                    tree.rotateUp(inner);
+                    tree.rotateUp(inner);
+                    promote(inner);
+                    demote(node);
+                    demote(parent);
+                }
+                return;
+            }
+        }
+
+        template <class Tree, class Node> static void unlink(Tree &tree, Node *node)
+        {
+            auto removed = tree.spliceNode(node);
+            auto child = removed.child, parent = removed.parent;
+            if (!tree.isGuard(parent) && isLeaf(tree, parent) && rank(parent) == 2)
+            {
+                // leaf of rank 1 is not allowed
+                demote(parent);
+                child = parent;
+                parent = parent->getParent();
+            }
+            // child can be 3-child, demotions move violation up until rotations end it
+            while (!tree.isGuard(parent) && difference(parent, child) == 3)
+            {
+                // guard child is the only empty child of parent here
+                auto left = parent->getLeft() == child;
+                auto sibling = left ? parent->getRight() : parent->getLeft();
+                if (difference(parent, sibling) == 2)
+                {
+                    demote(parent);
+                }
+                else if (difference(sibling, sibling->getLeft()) == 2 && difference(sibling, sibling->getRight()) == 2)
+                {
+                    demote(parent);
+                    demote(sibling);
+                }
+                else
+                {
+                    auto inner = left ? sibling->getLeft() : sibling->getRight();
+                    auto outer = left ? sibling->getRight() : sibling->getLeft();
+                    if (difference(sibling, outer) == 1)
+                    {
+                        tree.rotateUp(sibling);
+                        promote(sibling);
+                        demote(parent);
+                        if (isLeaf(tree, parent) && rank(parent) == 2)
+                        {
+                            demote(parent);
+                        }
+                    }
+                    else
+                    {
+                        tree.rotateUp(inner);
+                        tree.rotateUp(inner);
+                        promote(inner);
+                        promote(inner);
+                        demote(sibling);
+                        demote(parent);
+                        demote(parent);
+                    }
+                    return;
+                }
+                child = parent;
+                parent = parent->getParent();
+            }
+        }
+
+        // perfectly balanced tree with rank equal to height is valid, it is AVL tree
+        template <class Tree, class InputIt> static auto build(Tree &tree, InputIt &it, size_t count)
+        {
+            auto finish = [](auto node, size_t) {
+                node->setBalance(std::uint8_t(std::max(rank(node->getLeft()), rank(node->getRight())) + 1));
+            };
+            return tree.buildBalanced(it, count, 0, finish);
+        }
+
+        template <class Tree, class Node> static size_t subtreeRank(const Tree &, const Node *ptr)
+        {
+            return size_t(rank(ptr));
+        }
+
+        template <class Tree, class Subtree, class Node>
+        static size_t childRank(const Tree &, Subtree, const Node *child)
+        {
+            return size_t(rank(child));
+        }
+
+        template <class Tree, class Node> static void finishRoot(Tree &, Node *) {}
+
+        /**
+         * Taller tree is descended along its inner spine to subtree with rank at most one higher than other
+         * tree, node linked there can be 0-child which is fixed on way back like after insert. Node with two
+         * 1-children can appear only there, it is rotated up and promoted
+         */
+        template <class Tree, class Subtree, class Node>
+        static Subtree join(Tree &tree, Subtree left, Node *node, Subtree right)
+        {
+            Node *root = node;
+            if (rank(left.root) > rank(right.root) + 1)
+            {
+                root = joinSide<true>(tree, left.root, node, right.root);
+            }
+            else if (rank(right.root) > rank(left.root) + 1)
+            {
+                root = joinSide<false>(tree, right.root, node, left.root);
+            }
+            else
+            {
+                tree.setChildren(node, left.root, right.root);
+                node->setBalance(std::uint8_t(std::max(rank(left.root), rank(right.root)) + 1));
+            }
+            return {root, size_t(rank(root))};
+        }
+
+        // R is set when top is root of left tree and other is right tree
+        template <bool R, class Tree, class Node> static Node *joinSide(Tree &tree, Node *top, Node *node, Node *other)
+        {
+            auto inner = R ? top->getRight() : top->getLeft();
+            auto joined = node;
+            if (rank(inner) <= rank(other) + 1)
+            {
+                setSides<R>(tree, node, inner, other);
+                node->setBalance(std::uint8_t(std::max(rank(inner), rank(other)) + 1));
+            }
+            else
+            {
+                joined = joinSide<R>(tree, inner, node, other);
+            }
+            auto sibling = R ? top->getLeft() : top->getRight();
+            setSides<R>(tree, top, sibling, joined);
+            if (rank(top) != rank(joined))
+            {
+                return top;
+            }
+            if (difference(top, sibling) == 1)
+            {
+                promote(top);
+                return top;
+            }
+            auto joinedInner = R ? joined->getLeft() : joined->getRight();
+            auto joinedOuter = R ? joined->getRight() : joined->getLeft();
+            if (difference(joined, joinedInner) == 2)
+            {
+                demote(top);
+                return rotateDetached<R>(tree, top);
+            }
+            if (difference(joined, joinedOuter) == 1)
+            {
+                promote(joined);
+                return rotateDetached<R>(tree, top);
+            }
+            setSides<R>(tree, top, sibling, rotateDetached<!R>(tree, joined));
+            promote(joinedInner);
+            demote(joined);
+            demote(top);
+            return rotateDetached<R>(tree, top);
+        }
+
+        // links near and far child, far child is right one when R is set
+        template <bool R, class Tree, class Node> static void setSides(Tree &tree, Node *node, Node *near, Node *far)
+        {
+            if constexpr (R)
+            {
+                tree.setChildren(node, near, far);
+            }
+            else
+            {
+                tree.setChildren(node, far, near);
+            }
+        }
+
+        // far child of node takes its place
+        template <bool R, class Tree, class Node> static Node *rotateDetached(Tree &tree, Node *node)
+        {
+            if constexpr (R)
+            {
+                return tree.rotateLeftDetached(node);
+            }
+            else
+            {
+                return tree.rotateRightDetached(node);
+            }
+        }
+    };
+
+    /**
+     * Treap, tree is heap ordered by node priorities which are derived from node addresses, so no balance data is
+     * kept and shape is random with expected search path 1.39 log n. Join and split are short and simple, both
+     * walk spines of trees only, expected O(log n)
+     */
+    struct TreapBalance
+    {
+        static constexpr unsigned Bits = 0;
+        static constexpr size_t ParallelMinRank = 12;
+        // priorities of copied nodes differ, so copy is built again from sorted items
+        static constexpr bool CopyableShape = false;
+
+        // murmur finalizer of address, it is bijection so different nodes never have equal priorities
+        template <class Node> static std::uint64_t priority(const Node *node)
+        {
+            auto value = std::uint64_t(reinterpret_cast<std::uintptr_t>(node));
+            value ^= value >> 33;
+            value *= 0xff51afd7ed558ccdULL;
+            value ^= value >> 33;
+            value *= 0xc4ceb9fe1a85ec53ULL;
+            value ^= value >> 33;
+            return value;
+        }
+
+        // guard is below every node
+        template <class Tree, class Node> static bool above(const Tree &tree, const Node *lhs, const Node *rhs)
+        {
+            return !tree.isGuard(lhs) && (tree.isGuard(rhs) || priority(lhs) > priority(rhs));
+        }
+
+        template <class Tree, class Node> static void attached(Tree &tree, Node *node)
+        {
+            while (!tree.isGuard(node->getParent()) && above(tree, node, node->getParent()))
+            {
+                tree.rotateUp(node);
+            }
+        }
+
+        // node is rotated down until one of its children is empty, then it is spliced out
+        template <class Tree, class Node> static void unlink(Tree &tree, Node *node)
+        {
+            while (!tree.isGuard(node->getLeft()) && !tree.isGuard(node->getRight()))
+            {
+                tree.rotateUp(above(tree, node->getLeft(), node->getRight()) ? node->getLeft() : node->getRight());
+            }
+            tree.spliceNode(node);
+        }
+
+        /**
+         * Cartesian tree built in linear time, right spine is kept on stack and every next node takes nodes of
+         * lower priority from its bottom as left subtree
+         */
+        template <class Tree, class InputIt> static auto build(Tree &tree, InputIt &it, size_t count)
+        {
+            auto root = tree._guardPtr;
+            std::vector<decltype(root)> spine;
+            try
+            {
+                // every made node is linked under root before anything else can throw
+                for (size_t i = 0; i < count; ++i, ++it)
+                {
+                    auto node = tree.makeNode(*it);
+                    auto left = tree._guardPtr;
+                    while (!spine.empty() && above(tree, node, spine.back()))
+                    {
+                        left = spine.back();
+                        spine.pop_back();
+                    }
+                    node->setLeft(left);
+                    node->setRight(tree._guardPtr);
+                    left->setParent(node);
+                    if (spine.empty())
+                    {
+                        root = node;
+                    }
+                    else
+                    {
+                        spine.back()->setRight(node);
+                        node->setParent(spine.back());
+                    }
+                    spine.push_back(node);
+                }
+            }
+            catch (...)
+            {
+                tree.removeAllNodes(root);
+                throw;
+            }
+            tree.updateSubtree(root);
+            return root;
+        }
+
+        // priority of root of random treap with n nodes has about log n leading ones
+        template <class Tree, class Node> static size_t subtreeRank(const Tree &tree, const Node *ptr)
+        {
+            return tree.isGuard(ptr) ? 0 : size_t(std::countl_one(priority(ptr)));
+        }
+
+        template <class Tree, class Subtree, class Node>
+        static size_t childRank(const Tree &tree, Subtree, const Node *child)
+        {
+            return subtreeRank(tree, child);
+        }
+
+        template <class Tree, class Node> static void finishRoot(Tree &, Node *) {}
+
+        // root with highest priority stays on top, node sinks along inner spines to its place
+        template <class Tree, class Subtree, class Node>
+        static Subtree join(Tree &tree, Subtree left, Node *node, Subtree right)
+        {
+            auto root = joinNodes(tree, left.root, node, right.root);
+            return {root, subtreeRank(tree, root)};
+        }
+
+        template <class Tree, class Node> static Node *joinNodes(Tree &tree, Node *left, Node *node, Node *right)
+        {
+            if (above(tree, left, node) && above(tree, left, right))
+            {
+                tree.setChildren(left, left->getLeft(), joinNodes(tree, left->getRight(), node, right));
+                return left;
+            }
+            if (above(tree, right, node))
+            {
+                tree.setChildren(right, joinNodes(tree, left, node, right->getLeft()), right->getRight());
+                return right;
+            }
+            tree.setChildren(node, left, right);
+            return node;
+        }
+    };
+
+    /**
+     * Ordered map implemented as balanced binary search tree. Augment policy (NoAugmentation, OrderStatistics,
+     * MaxEndpoint) lets nodes carry additional data derived from their subtrees, it is recomputed after every
+     * rotation and structural change. NodeLinks selects node layout, MapNodeLinks or CompactMapNodeLinks.
+     * Balance selects tree kind, RedBlackBalance, AvlBalance, WavlBalance or TreapBalance. Stats set to MapStats
+     * counts comparisons, rotations and node visits of operations, default NoMapStats costs nothing
+     */
+    template <class K, class T, class Compare = std::less<K>, template <class> class Allocator = HeapNodeAllocator,
+              class Augment = NoAugmentation, template <class, class> class NodeLinks = MapNodeLinks,
+              class Balance = RedBlackBalance, class Stats = NoMapStats>
+    class Map
+    {
+      private:
+        using Node = MapNode<K, T, Augment, NodeLinks>;
+        using Links = NodeLinks<Node, Augment>;
+
+        static_assert(Balance::Bits <= Links::BalanceBits, "Node links have no room for data of balancing policy");
+        // tree pointers can point to guard, so they are typed as links and cast to Node only to free real node
+        using MapNodePtr = Links *;
+        using ConstMapNodePtr = const Links *;
+        using NodeAllocator = Allocator<Node>;
+
+        using Pair = std::pair<const K, T>;
+
+        MapNodePtr _guardPtr = makeGuard();
+        MapNodePtr _root = _guardPtr;
+        MapNodePtr _leftmost = _guardPtr;
+        MapNodePtr _rightmost = _guardPtr;
+        size_t _size = 0;
+        NodeAllocator _allocator;
+        [[no_unique_address]] Compare _compare;
+        // counters describe work of this instance, so they are not copied or swapped with tree
+        [[no_unique_address]] mutable Stats _stats;
+
+      public:
+        using Iterator = MapIterator<Node, false, false>;
+        using ConstIterator = MapIterator<Node, true, false>;
+
+        using ReverseIterator = MapIterator<Node, false, true>;
+        using ConstReverseIterator = MapIterator<Node, true, true>;
+
+        // node handles need allocator which can free nodes of any map instance
+        using NodeHandle = MapNodeHandle<Node, NodeAllocator>;
+
+        // Constructors
+        Map() = default;
+
+        explicit Map(const Compare &compare) : _compare(compare) {}
+
+        template <class InputIt> Map(InputIt first, InputIt last) { insert(first, last); }
+
+        template <std::forward_iterator InputIt> Map(SortedUniqueTag, InputIt first, InputIt last)
+        {
+            buildSorted(first, std::distance(first, last));
+        }
+
+        Map(const Map &other) : _compare(other._compare) { cloneTree(other); }
+
+        Map(Map &&other) { swap(other); }
+
+        Map(std::initializer_list<Pair> init) { insert(init); }
+
+        ~Map()
+        {
+            clear();
+            deleteGuard(_guardPtr);
+        }
+
+        // Assign
+        Map &operator=(const Map &other)
+        {
+            if (this != &other)
+            {
+                clear();
+                _compare = other._compare;
+                cloneTree(other);
+            }
+            return *this;
+        }
+
+        Map &operator=(Map &&other)
+        {
+            if (this != &other)
+            {
+                clear();
+                swap(other);
+            }
+            return *this;
+        }
+
+        Map &operator=(std::initializer_list<Pair> ilist)
+        {
+            clear();
+            insert(ilist);
+            return *this;
+        }
+
+        // Element access
+        T &at(const K &key)
+        {
+            auto node = findNode(key);
+            assertNode(node);
+            return node->getItem();
+        }
+
+        const T &at(const K &key) const
+        {
+            auto node = findConstNode(key);
+            assertNode(node);
+            return node->getItem();
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        T &at(const Key &key)
+        {
+            auto node = findNode(key);
+            assertNode(node);
+            return node->getItem();
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        const T &at(const Key &key) const
+        {
+            auto node = findConstNode(key);
+            assertNode(node);
+            return node->getItem();
+        }
+
+        T &operator[](const K &key) { return at(key); }
+
+        const T &operator[](const K &key) const { return at(key); }
+
+        Pair &front()
+        {
+            assertEmpty();
+            return _leftmost->getPair();
+        }
+
+        const Pair &front() const
+        {
+            assertEmpty();
+            return _leftmost->getPair();
+        }
+
+        Pair &back()
+        {
+            assertEmpty();
+            return _rightmost->getPair();
+        }
+
+        const Pair &back() const
+        {
+            assertEmpty();
+            return _rightmost->getPair();
+        }
+
+        // Modifiers
+        std::pair<Iterator, bool> insert(const Pair &value) { return insertNode(makeNode(value)); }
+        std::pair<Iterator, bool> insert(Pair &&value) { return insertNode(makeNode(std::move(value))); }
+
+        /**
+         * Inserts value as close as possible before hint, when hint points to element right after
+         * value position (or end for appends) search from root is skipped and value is attached directly
+         */
+        Iterator insert(ConstIterator hint, const Pair &value) { return insertHint(hint, value); }
+        Iterator insert(ConstIterator hint, Pair &&value) { return insertHint(hint, std::move(value)); }
+
+        /**
+         * Inserts range, if map is empty and range is sorted by key with unique keys,
+         * tree is built directly in linear time instead of inserting elements one by one
+         */
+        template <class InputIt> void insert(InputIt first, InputIt last)
+        {
+            if constexpr (std::forward_iterator<InputIt>)
+            {
+                if (empty() && isSortedUnique(first, last))
+                {
+                    buildSorted(first, std::distance(first, last));
+                    return;
+                }
+            }
+            for (auto it = first; it != last; ++it)
+            {
+                insertNode(makeNode(*it));
+            }
+        }
+
+        void insert(const std::initializer_list<Pair> &ilist) { insert(ilist.begin(), ilist.end()); }
+
+        /**
+         * Constructs element in place from args, key is known only after construction so node is always
+         * created, and destroyed when key is already present. Use tryEmplace when key is at hand
+         */
+        template <class... Args> std::pair<Iterator, bool> emplace(Args &&...args)
+        {
+            return insertNode(makeNode(std::in_place, std::forward<Args>(args)...));
+        }
+
+        /**
+         * Constructs element in place using hint like insert(hint, value), returns iterator to inserted
+         * element or to element with same key
+         */
+        template <class... Args> Iterator emplaceHint(ConstIterator hint, Args &&...args)
+        {
+            auto node = makeNode(std::in_place, std::forward<Args>(args)...);
+            auto position = findHintPosition(mutableNode(hint._ptr), node->getKey());
+            if (position.found)
+            {
+                deleteNode(node);
+                return Iterator{position.parent};
+            }
+            attachNode(node, position.parent, position.left);
+            return Iterator{node};
+        }
+
+        /**
+         * Constructs item from args only when key is not present, otherwise args are left untouched
+         */
+        template <class... Args> std::pair<Iterator, bool> tryEmplace(const K &key, Args &&...args)
+        {
+            return tryEmplaceKey(key, std::forward<Args>(args)...);
+        }
+
+        template <class... Args> std::pair<Iterator, bool> tryEmplace(K &&key, Args &&...args)
+        {
+            return tryEmplaceKey(std::move(key), std::forward<Args>(args)...);
+        }
+
+        /**
+         * Assigns item to element with key, or inserts new element when key is not present
+         */
+        template <class M> std::pair<Iterator, bool> insertOrAssign(const K &key, M &&item)
+        {
+            return insertOrAssignKey(key, std::forward<M>(item));
+        }
+
+        template <class M> std::pair<Iterator, bool> insertOrAssign(K &&key, M &&item)
+        {
+            return insertOrAssignKey(std::move(key), std::forward<M>(item));
+        }
+
+        void remove(const K &key)
+        {
+            auto node = findNode(key);
+            assertNode(node);
+            removeNode(node);
+        }
+
+        /**
+         * Removes element at position without searching for it and returns iterator to element which followed it.
+         * Removal relinks remaining nodes without moving them, so iterators to other elements stay valid
+         */
+        Iterator erase(ConstIterator position)
+        {
+            _stats.operation();
+            auto node = mutableNode(position._ptr);
+            auto next = node == _rightmost ? _guardPtr : succesor(node);
+            removeNode(node);
+            return Iterator{next};
+        }
+
+        Iterator erase(Iterator position) { return erase(ConstIterator(position)); }
+
+        // removes elements in [first, last) walking from first, whole map is cleared at once
+        Iterator erase(ConstIterator first, ConstIterator last)
+        {
+            if (first == cBegin() && last == cEnd())
+            {
+                clear();
+                return end();
+            }
+            while (first != last)
+            {
+                first = erase(first);
+            }
+            return Iterator{mutableNode(last._ptr)};
+        }
+
+        /**
+         * Removes elements for which predicate holds in single in order walk and returns their count,
+         * predicate gets element as const pair
+         */
+        template <class Predicate> size_t eraseIf(Predicate predicate)
+        {
+            _stats.operation();
+            size_t removed = 0;
+            for (auto node = _leftmost; !isGuard(node);)
+            {
+                auto next = node == _rightmost ? _guardPtr : succesor(node);
+                if (predicate(std::as_const(node->getPair())))
+                {
+                    removeNode(node);
+                    ++removed;
+                }
+                node = next;
+            }
+            return removed;
+        }
+
+        /**
+         * Takes node with key out of map, returned handle owns it. Throws when key is not present
+         */
+        NodeHandle extract(const K &key)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            return extractNode(findNode(key));
+        }
+
+        // takes out node at position without searching for it
+        NodeHandle extract(Iterator position)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            return extractNode(position._ptr);
+        }
+
+        NodeHandle extract(ConstIterator position)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            return extractNode(mutableNode(position._ptr));
+        }
+
+        /**
+         * Links node owned by handle into map, when key is already present node stays in handle
+         * and iterator to present element is returned
+         */
+        std::pair<Iterator, bool> insert(NodeHandle &&handle)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            if (handle.empty())
+            {
+                return {end(), false};
+            }
+            auto result = linkNode(handle._node);
+            if (result.second)
+            {
+                handle.release();
+            }
+            return result;
+        }
+
+        /**
+         * Moves nodes with keys not present in this map from source, nodes are relinked without
+         * allocation or copying, elements with already present keys stay in source. Iterators to moved
+         * elements stay valid and now refer to this map
+         */
+        template <class OtherCompare, class OtherStats>
+            requires NodeAllocator::isAlwaysEqual
+        void merge(Map<K, T, OtherCompare, Allocator, Augment, NodeLinks, Balance, OtherStats> &source)
+        {
+            auto node = source._leftmost;
+            while (!source.isGuard(node))
+            {
+                auto next = source.succesor(node);
+                // position in this tree does not change when node is unlinked from source
+                auto position = findInsertPosition(node->getKey());
+                if (!position.found)
+                {
+                    source.unlinkNode(node);
+                    attachNode(node, position.parent, position.left);
+                }
+                node = next;
+            }
+        }
+
+        template <class OtherCompare, class OtherStats>
+            requires NodeAllocator::isAlwaysEqual
+        void merge(Map<K, T, OtherCompare, Allocator, Augment, NodeLinks, Balance, OtherStats> &&source)
+        {
+            merge(source);
+        }
+
+        /**
+         * Set operations built on join and split of balancing policy, other map is consumed and left empty.
+         * Nodes are relinked, not copied, for maps of sizes m <= n work is O(m log(n/m + 1))
+         * instead of O(m log n) of element by element insert or remove. Iterators to kept elements stay valid,
+         * also ones taken from other map
+         */
+
+        // adds elements of other, for keys present in both maps element of this map is kept
+        void unionWith(Map &&other)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            // for m <= sqrt(n) O(m log n) insertion is within bound and has lower constant than split and join
+            if (this != &other && other._size * other._size <= _size)
+            {
+                insertSubtree(other, other._root);
+                other.resetTree();
+                return;
+            }
+            setOperation(other, [&](Subtree mine, Subtree theirs, size_t &removed) {
+                return uniteTrees(theirs, mine, false, removed, 0);
+            });
+        }
+
+        // keeps only elements with keys present in other
+        void intersectWith(Map &&other)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            setOperation(other, [&](Subtree mine, Subtree theirs, size_t &removed) {
+                return intersectTrees(mine, theirs, removed, 0);
+            });
+        }
+
+        // removes elements with keys present in other
+        void differenceWith(Map &&other)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            if (this == &other)
+            {
+                clear();
+                return;
+            }
+            setOperation(other, [&](Subtree mine, Subtree theirs, size_t &removed) {
+                return subtractTrees(mine, theirs, removed, 0);
+            });
+        }
+
+        /**
+         * Fork join variants for large maps, top levels of recursion run on separate threads.
+         * Node allocator has to be thread safe, like default heap one
+         */
+        void unionWith(ParallelTag, Map &&other)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            setOperation(other, [&](Subtree mine, Subtree theirs, size_t &removed) {
+                return uniteTrees(theirs, mine, false, removed, forkDepth());
+            });
+        }
+
+        void intersectWith(ParallelTag, Map &&other)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            setOperation(other, [&](Subtree mine, Subtree theirs, size_t &removed) {
+                return intersectTrees(mine, theirs, removed, forkDepth());
+            });
+        }
+
+        void differenceWith(ParallelTag, Map &&other)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            if (this == &other)
+            {
+                clear();
+                return;
+            }
+            setOperation(other, [&](Subtree mine, Subtree theirs, size_t &removed) {
+                return subtractTrees(mine, theirs, removed, forkDepth());
+            });
+        }
+
+        /**
+         * Appends other map which keys are all greater than keys of this map in O(log n) plus linear
+         * relinking of smaller map, throws std::invalid_argument when key ranges overlap
+         */
+        void join(Map &&other)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            if (this == &other || other.empty())
+            {
+                return;
+            }
+            if (!empty() && compareKeys(_rightmost->getKey(), other._leftmost->getKey()) >= 0)
+            {
+                throw std::invalid_argument("Joined map keys must be greater than keys of this map");
+            }
+            setOperation(other, [&](Subtree mine, Subtree theirs, size_t &) { return joinTrees(mine, theirs); });
+        }
+
+        /**
+         * Moves elements with keys not less than key to returned map, split itself is O(log n)
+         * but one of parts has to be relinked and counted, so it is linear in size of smaller part.
+         * Iterators stay valid, moved elements are reached from returned map
+         */
+        Map splitAt(const K &key)
+            requires NodeAllocator::isAlwaysEqual
+        {
+            Map result;
+            result._compare = _compare;
+            auto parts = splitTree({_root, Balance::subtreeRank(*this, _root)}, key);
+            if (!isGuard(parts.middle))
+            {
+                parts.right = joinTrees({_guardPtr, 0}, parts.middle, parts.right);
+            }
+            auto left = finishTree(parts.left), right = finishTree(parts.right);
+            auto leftEmpty = isGuard(left), rightEmpty = isGuard(right);
+
+            // walk both parts together until smaller one ends, that gives sizes of both
+            auto l = minimum(left), r = minimum(right);
+            size_t steps = 0;
+            while (!isGuard(l) && !isGuard(r))
+            {
+                l = succesor(l);
+                r = succesor(r);
+                ++steps;
+            }
+            auto leftSmaller = isGuard(l);
+            auto leftSize = leftSmaller ? steps : _size - steps;
+
+            // smaller part moves to guard of result, guards are swapped when it is part staying in this map
+            rebaseSubtree(leftSmaller ? left : right, _guardPtr, result._guardPtr);
+            if (leftSmaller)
+            {
+                std::swap(_guardPtr, result._guardPtr);
+            }
+            _root = leftEmpty ? _guardPtr : left;
+            result._root = rightEmpty ? result._guardPtr : right;
+            _root->setParent(_guardPtr);
+            result._root->setParent(result._guardPtr);
+            result._size = _size - leftSize;
+            _size = leftSize;
+            updateExtremes();
+            result.updateExtremes();
+            return result;
+        }
+
+        void swap(Map &other)
+        {
+            std::swap(_guardPtr, other._guardPtr);
+            std::swap(_root, other._root);
+            std::swap(_leftmost, other._leftmost);
+            std::swap(_rightmost, other._rightmost);
+            std::swap(_size, other._size);
+            std::swap(_compare, other._compare);
+            _allocator.swap(other._allocator);
+        }
+
+        void clear()
+        {
+            if constexpr (NodeAllocator::canReleaseAll)
+            {
+                destroyAllNodes(_root);
+                _allocator.releaseAll();
+            }
+            else
+            {
+                removeAllNodes(_root);
+            }
+            _root = _guardPtr;
+            _leftmost = _guardPtr;
+            _rightmost = _guardPtr;
+            _size = 0;
+        }
+
+        void popFront()
+        {
+            assertEmpty();
+            _stats.operation();
+            removeNode(_leftmost);
+        }
+
+        void popBack()
+        {
+            assertEmpty();
+            _stats.operation();
+            removeNode(_rightmost);
+        }
+
+        // LookUp
+        Iterator find(const K &key) { return Iterator{findNode(key)}; }
+
+        ConstIterator find(const K &key) const { return ConstIterator{findConstNode(key)}; }
+
+        bool contains(const K &key) const { return !isGuard(findConstNode(key)); }
+
+        /**
+         * Looks up batch of keys, results[i] is set to element with keys[i] or to end. Searches are
+         * interleaved level by level with child nodes prefetched, so cache misses of separate walks overlap
+         */
+        void findMany(std::span<const K> keys, std::span<Iterator> results)
+        {
+            assertBatchSize(keys.size(), results.size());
+            findManyNodes(keys, [&](size_t index, ConstMapNodePtr node) {
+                results[index] = Iterator{mutableNode(node)};
+            });
+        }
+
+        void findMany(std::span<const K> keys, std::span<ConstIterator> results) const
+        {
+            assertBatchSize(keys.size(), results.size());
+            findManyNodes(keys, [&](size_t index, ConstMapNodePtr node) {
+                results[index] = ConstIterator{node};
+            });
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        Iterator find(const Key &key)
+        {
+            return Iterator{findNode(key)};
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        ConstIterator find(const Key &key) const
+        {
+            return ConstIterator{findConstNode(key)};
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        bool contains(const Key &key) const
+        {
+            return !isGuard(findConstNode(key));
+        }
+
+        // Bounds, first element not less than key
+        Iterator lowerBound(const K &key) { return Iterator{mutableNode(lowerBoundNode(key))}; }
+
+        ConstIterator lowerBound(const K &key) const { return ConstIterator{lowerBoundNode(key)}; }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        Iterator lowerBound(const Key &key)
+        {
+            return Iterator{mutableNode(lowerBoundNode(key))};
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        ConstIterator lowerBound(const Key &key) const
+        {
+            return ConstIterator{lowerBoundNode(key)};
+        }
+
+        // first element greater than key
+        Iterator upperBound(const K &key) { return Iterator{mutableNode(upperBoundNode(key))}; }
+
+        ConstIterator upperBound(const K &key) const { return ConstIterator{upperBoundNode(key)}; }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        Iterator upperBound(const Key &key)
+        {
+            return Iterator{mutableNode(upperBoundNode(key))};
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        ConstIterator upperBound(const Key &key) const
+        {
+            return ConstIterator{upperBoundNode(key)};
+        }
+
+        // elements equal to key, at most one as keys are unique
+        std::pair<Iterator, Iterator> equalRange(const K &key) { return makeEqualRange<Iterator>(key); }
+
+        std::pair<ConstIterator, ConstIterator> equalRange(const K &key) const
+        {
+            return makeEqualRange<ConstIterator>(key);
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        std::pair<Iterator, Iterator> equalRange(const Key &key)
+        {
+            return makeEqualRange<Iterator>(key);
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K>
+        std::pair<ConstIterator, ConstIterator> equalRange(const Key &key) const
+        {
+            return makeEqualRange<ConstIterator>(key);
+        }
+
+        // elements with keys in [low, high)
+        MapRange<Iterator> range(const K &low, const K &high) { return makeRange<Iterator>(low, high); }
+
+        MapRange<ConstIterator> range(const K &low, const K &high) const
+        {
+            return makeRange<ConstIterator>(low, high);
+        }
+
+        template <class Low, class High>
+            requires TransparentKey<Compare, Low, K> && TransparentKey<Compare, High, K>
+        MapRange<Iterator> range(const Low &low, const High &high)
+        {
+            return makeRange<Iterator>(low, high);
+        }
+
+        template <class Low, class High>
+            requires TransparentKey<Compare, Low, K> && TransparentKey<Compare, High, K>
+        MapRange<ConstIterator> range(const Low &low, const High &high) const
+        {
+            return makeRange<ConstIterator>(low, high);
+        }
+
+        // Order statistics, available with OrderStatistics augmentation
+        // element at index in key order or end
+        Iterator nth(size_t index)
+            requires std::same_as<Augment, OrderStatistics>
+        {
+            return Iterator{mutableNode(nthNode(index))};
+        }
+
+        ConstIterator nth(size_t index) const
+            requires std::same_as<Augment, OrderStatistics>
+        {
+            return ConstIterator{nthNode(index)};
+        }
+
+        // number of keys less than key
+        size_t rank(const K &key) const
+            requires std::same_as<Augment, OrderStatistics>
+        {
+            return rankOf(key);
+        }
+
+        template <class Key>
+            requires TransparentKey<Compare, Key, K> && std::same_as<Augment, OrderStatistics>
+        size_t rank(const Key &key) const
+        {
+            return rankOf(key);
+        }
+
+        // Parallel traversal
+        /**
+         * Calls function with every item. Top levels of tree are cut into disjoint subtrees which threads take one
+         * by one until none is left, so function runs concurrently and in no particular order. Zero threads means
+         * hardware concurrency, small maps are walked on calling thread
+         */
+        template <class Function> void parallelForEach(Function function, size_t threads = 0)
+        {
+            forEachParallel(_root, function, threads);
+        }
+
+        template <class Function> void parallelForEach(Function function, size_t threads = 0) const
+        {
+            forEachParallel(ConstMapNodePtr(_root), function, threads);
+        }
+
+        /**
+         * Folds combine(init, transform(item)) over all items like sequential loop would, subtrees are reduced
+         * on separate threads and their results combined in key order, so combine has to be associative only
+         */
+        template <class R, class Transform, class Combine>
+        R parallelReduce(R init, Transform transform, Combine combine, size_t threads = 0) const
+        {
+            threads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+            if (threads == 1 || _size < ParallelMinSize)
+            {
+                for (auto &pair : *this)
+                {
+                    init = combine(std::move(init), transform(pair));
+                }
+                return init;
+            }
+            ConstMapNodePtr root = _root;
+            auto depth = taskDepth(threads);
+            std::vector<ConstMapNodePtr> subtrees;
+            collectSubtrees(root, depth, subtrees);
+            std::vector<std::optional<R>> results(subtrees.size());
+            runTasks(subtrees.size(), threads, [&](size_t index) {
+                visitSubtree(subtrees[index], [&](const Pair &pair) {
+                    auto &result = results[index];
+                    result = result ? combine(std::move(*result), transform(pair)) : R(transform(pair));
+                });
+            });
+            size_t index = 0;
+            auto total = combineTop(root, depth, results, index, transform, combine);
+            return total ? combine(std::move(init), std::move(*total)) : init;
+        }
+
+        // Interval queries, available with MaxEndpoint augmentation
+        /**
+         * Calls visitor with every item whose interval overlaps closed interval [low, high], in key order. Visitor
+         * returning bool can stop query by returning false. Subtrees ending before low and everything starting
+         * after high are skipped, nothing is allocated
+         */
+        template <class Visitor, class A = Augment>
+            requires IntervalAugmentation<A>
+        void visitOverlapping(const typename A::Endpoint &low, const typename A::Endpoint &high, Visitor visitor)
+        {
+            visitOverlappingNodes(_root, low, high, visitor);
+        }
+
+        template <class Visitor, class A = Augment>
+            requires IntervalAugmentation<A>
+        void visitOverlapping(const typename A::Endpoint &low, const typename A::Endpoint &high,
+                              Visitor visitor) const
+        {
+            visitOverlappingNodes(ConstMapNodePtr(_root), low, high, visitor);
+        }
+
+        // calls visitor with every item whose interval contains point
+        template <class Visitor, class A = Augment>
+            requires IntervalAugmentation<A>
+        void visitStabbing(const typename A::Endpoint &point, Visitor visitor)
+        {
+            visitOverlappingNodes(_root, point, point, visitor);
+        }
+
+        template <class Visitor, class A = Augment>
+            requires IntervalAugmentation<A>
+        void visitStabbing(const typename A::Endpoint &point, Visitor visitor) const
+        {
+            visitOverlappingNodes(ConstMapNodePtr(_root), point, point, visitor);
+        }
+
+        // Snapshot
+        /**
+         * Writes elements to file in sorted page aligned layout, MappedMap::open serves it in place without
+         * reading it, so restarting process does not need to insert elements again
+         */
+        void saveSnapshot(const std::string &path) const
+            requires std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<T>
+        {
+            writeMapSnapshot<K, T>(path, begin(), _size);
+        }
+
+        // Stats
+        /**
+         * Counters gathered by Stats policy, all zero with default NoMapStats, size and black height. Black height
+         * is counted along left spine in O(log n), so stats are cheap enough for every metrics scrape
+         */
+        MapStatistics stats() const
+        {
+            auto stats = _stats.counters();
+            stats.size = _size;
+            stats.height = stats.maxOperationVisits;
+            if constexpr (std::is_same_v<Balance, RedBlackBalance>)
+            {
+                stats.blackHeight = spineBlackHeight();
+            }
+            return stats;
+        }
+
+        void resetStats() { _stats.reset(); }
+
+        /**
+         * Measures height of tree and checks red black invariants, walks whole tree, so it is meant for
+         * diagnostics rather than periodic export
+         */
+        MapShape checkShape() const
+        {
+            MapShape shape;
+            shape.height = subtreeHeight(_root);
+            if constexpr (std::is_same_v<Balance, RedBlackBalance>)
+            {
+                auto blackHeight = checkRedBlack(_root);
+                shape.blackHeight = blackHeight.value_or(0);
+                shape.balanced = blackHeight.has_value() && !isRed(_root);
+            }
+            return shape;
+        }
+
+        // Capacity
+        size_t size() const { return _size; }
+
+        bool empty() const { return size() == 0; }
+
+        // Iterators
+        Iterator begin() { return Iterator{_leftmost}; }
+        Iterator end() { return Iterator{_guardPtr}; }
+
+        ConstIterator begin() const { return ConstIterator{_leftmost}; }
+        ConstIterator end() const { return ConstIterator{_guardPtr}; }
+
+        ConstIterator cBegin() const { return ConstIterator{_leftmost}; }
+        ConstIterator cEnd() const { return ConstIterator{_guardPtr}; }
+
+        ReverseIterator rBegin() { return ReverseIterator{_rightmost}; }
+        ReverseIterator rEnd() { return ReverseIterator{_guardPtr}; }
+
+        ConstReverseIterator rBegin() const { return ConstReverseIterator{_rightmost}; }
+        ConstReverseIterator rEnd() const { return ConstReverseIterator{_guardPtr}; }
+
+        ConstReverseIterator crBegin() const { return ConstReverseIterator{_rightmost}; }
+        ConstReverseIterator crEnd() const { return ConstReverseIterator{_guardPtr}; }
+
+      private:
+        template <class, class, class, template <class> class, class, template <class, class> class, class, class>
+        friend class Map;
+        friend Balance;
+        // indexed map links nodes it made and keeps pointers to them in its hash index
+        template <class, class, class, class, template <class> class> friend class IndexedMap;
+
+        template <class Key> MapNodePtr findNode(const Key &key) { return const_cast<MapNodePtr>(findConstNode(key)); }
+
+        template <class Key> ConstMapNodePtr findConstNode(const Key &key) const
+        {
+            _stats.operation();
+            auto ptr = _root;
+            while (!isGuard(ptr))
+            {
+                _stats.visited();
+                auto order = compareKeys(key, ptr->getKey());
+                if (order < 0)
+                {
+                    ptr = ptr->getLeft();
+                }
+                else if (order > 0)
+                {
+                    ptr = ptr->getRight();
+                }
+                else
+                {
+                    return ptr;
+                }
+            }
+            return _guardPtr;
+        }
+
+        // number of searches walked together by findMany, enough to hide memory latency behind comparisons
+        static constexpr size_t FindManyLanes = 16;
+
+        template <class Visit> void findManyNodes(std::span<const K> keys, Visit visit) const
+        {
+            ConstMapNodePtr lanes[FindManyLanes];
+            for (size_t first = 0; first < keys.size(); first += FindManyLanes)
+            {
+                auto count = std::min(FindManyLanes, keys.size() - first);
+                std::fill_n(lanes, count, _root);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    _stats.operation();
+                }
+                auto active = count;
+                while (active)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        auto ptr = lanes[i];
+                        if (!ptr)
+                        {
+                            continue;
+                        }
+                        _stats.visited();
+                        auto order = isGuard(ptr) ? std::weak_ordering::equivalent
+                                                  : compareKeys(keys[first + i], ptr->getKey());
+                        if (order == 0)
+                        {
+                            visit(first + i, ptr);
+                            lanes[i] = nullptr;
+                            --active;
+                            continue;
+                        }
+                        ptr = order < 0 ? ptr->getLeft() : ptr->getRight();
+#if defined(__GNUC__)
+                        __builtin_prefetch(ptr);
+#endif
+                        lanes[i] = ptr;
+                    }
+                }
+            }
+        }
+
+        template <class Key> ConstMapNodePtr lowerBoundNode(const Key &key) const
+        {
+            _stats.operation();
+            ConstMapNodePtr result = _guardPtr;
+            ConstMapNodePtr ptr = _root;
+            while (!isGuard(ptr))
+            {
+                _stats.visited();
+                if (compareKeys(ptr->getKey(), key) < 0)
+                {
+                    ptr = ptr->getRight();
+                }
+                else
+                {
+                    result = ptr;
+                    ptr = ptr->getLeft();
+                }
+            }
+            return result;
+        }
+
+        template <class Key> ConstMapNodePtr upperBoundNode(const Key &key) const
+        {
+            _stats.operation();
+            ConstMapNodePtr result = _guardPtr;
+            ConstMapNodePtr ptr = _root;
+            while (!isGuard(ptr))
+            {
+                _stats.visited();
+                if (compareKeys(key, ptr->getKey()) < 0)
+                {
+                    result = ptr;
+                    ptr = ptr->getLeft();
+                }
+                else
+                {
+                    ptr = ptr->getRight();
+                }
+            }
+            return result;
+        }
+
+        template <class It, class Key> std::pair<It, It> makeEqualRange(const Key &key) const
+        {
+            auto lower = mutableNode(lowerBoundNode(key));
+            It first{lower};
+            if (isGuard(lower) || compareKeys(key, lower->getKey()) != 0)
+            {
+                return {first, first};
+            }
+            return {first, std::next(first)};
+        }
+
+        template <class It, class Low, class High> MapRange<It> makeRange(const Low &low, const High &high) const
+        {
+            It last{mutableNode(lowerBoundNode(high))};
+            if (compareKeys(low, high) >= 0)
+            {
+                return {last, last};
+            }
+            return {It{mutableNode(lowerBoundNode(low))}, last};
+        }
+
+        MapNodePtr mutableNode(ConstMapNodePtr ptr) const { return const_cast<MapNodePtr>(ptr); }
+
+        NodeHandle extractNode(MapNodePtr node)
+        {
+            assertNode(node);
+            unlinkNode(node);
+            return NodeHandle{static_cast<Node *>(node)};
+        }
+
+        ConstMapNodePtr nthNode(size_t index) const
+        {
+            if (index >= _size)
+            {
+                return _guardPtr;
+            }
+            ConstMapNodePtr ptr = _root;
+            while (true)
+            {
+                auto leftSize = ptr->getLeft()->getAugment();
+                if (index < leftSize)
+                {
+                    ptr = ptr->getLeft();
+                }
+                else if (index > leftSize)
+                {
+                    index -= leftSize + 1;
+                    ptr = ptr->getRight();
+                }
+                else
+                {
+                    return ptr;
+                }
+            }
+        }
+
+        // in order walk pruned by max endpoint, returns false when visitor stopped it
+        template <class Ptr, class E, class Visitor>
+        bool visitOverlappingNodes(Ptr ptr, const E &low, const E &high, Visitor &visitor) const
+        {
+            while (!isGuard(ptr) && !(*ptr->getAugment() < low))
+            {
+                if (!visitOverlappingNodes(ptr->getLeft(), low, high, visitor))
+                {
+                    return false;
+                }
+                auto &interval = ptr->getKey();
+                if (high < interval.low)
+                {
+                    // keys to the right start even later
+                    return true;
+                }
+                if (!(interval.high < low))
+                {
+                    if constexpr (std::is_same_v<std::invoke_result_t<Visitor &, decltype(ptr->getPair())>, bool>)
+                    {
+                        if (!visitor(ptr->getPair()))
+                        {
+                            return false;
+                        }
+                    }
+                    else
+                    {
+                        visitor(ptr->getPair());
+                    }
+                }
+                ptr = ptr->getRight();
+            }
+            return true;
+        }
+
+        template <class Key> size_t rankOf(const Key &key) const
+        {
+            size_t rank = 0;
+            ConstMapNodePtr ptr = _root;
+            while (!isGuard(ptr))
+            {
+                if (compareKeys(ptr->getKey(), key) < 0)
+                {
+                    rank += ptr->getLeft()->getAugment() + 1;
+                    ptr = ptr->getRight();
+                }
+                else
+                {
+                    ptr = ptr->getLeft();
+                }
+            }
+            return rank;
+        }
+
+        /**
+         * Compares keys with single three way comparison, if Compare is default std::less and keys support
+         * operator<=> it is used directly, otherwise falls back to two Compare calls
+         */
+        template <class L, class R> std::weak_ordering compareKeys(const L &lhs, const R &rhs) const
+        {
+            _stats.compared();
+            if constexpr (ThreeWayComparator<Compare, L, R>)
+            {
+                return _compare(lhs, rhs);
+            }
+            else if constexpr ((std::is_same_v<Compare, std::less<K>> || std::is_same_v<Compare, std::less<>>) &&
+                               std::three_way_comparable_with<L, R, std::weak_ordering>)
+            {
+                return lhs <=> rhs;
+            }
+            else
+            {
+                if (_compare(lhs, rhs))
+                {
+                    return std::weak_ordering::less;
+                }
+                if (_compare(rhs, lhs))
+                {
+                    return std::weak_ordering::greater;
+                }
+                return std::weak_ordering::equivalent;
+            }
+        }
+
+        MapNodePtr minimum(MapNodePtr ptr) const
+        {
+            if (!isGuard(ptr))
+            {
+                while (!isGuard(ptr->getLeft()))
+                {
+                    ptr = ptr->getLeft();
+                }
+            }
+            return ptr;
+        }
+
+        MapNodePtr maximum(MapNodePtr ptr) const
+        {
+            if (!isGuard(ptr))
+            {
+                while (!isGuard(ptr->getRight()))
+                {
+                    ptr = ptr->getRight();
+                }
+            }
+            return ptr;
+        }
+
+        MapNodePtr succesor(MapNodePtr ptr)
+        {
+            MapNodePtr r;
+
+            if (!isGuard(ptr))
+            {
+                if (!isGuard(ptr->getRight()))
+                    return minimum(ptr->getRight());
+                else
+                {
+                    r = ptr->getParent();
+                    while (!isGuard(r) && (ptr == r->getRight()))
+                    {
+                        ptr = r;
+                        r = r->getParent();
+                    }
+                    return r;
+                }
+            }
+            return _guardPtr;
+        }
+
+        MapNodePtr predecessor(MapNodePtr ptr)
+        {
+            MapNodePtr r;
+
+            if (!isGuard(ptr))
+            {
+                if (!isGuard(ptr->getLeft()))
+                    return maximum(ptr->getLeft());
+                else
+                {
+                    r = ptr->getParent();
+                    while (!isGuard(r) && (ptr == r->getLeft()))
+                    {
+                        ptr = r;
+                        r = r->getParent();
+                    }
+                    return r;
+                }
+            }
+            return _guardPtr;
+        }
+
+        // recomputes augmentation data on path from ptr up to root
+        void updatePath(MapNodePtr ptr)
+        {
+            if constexpr (Augment::enabled)
+            {
+                while (!isGuard(ptr))
+                {
+                    Augment::update(ptr);
+                    ptr = ptr->getParent();
+                }
+            }
+        }
+
+        void updateExtremes()
+        {
+            _leftmost = minimum(_root);
+            _rightmost = maximum(_root);
+        }
+
+        void rotateLeft(MapNodePtr A)
+        {
+            MapNodePtr B, p;
+
+            B = A->getRight();
+            if (!isGuard(B))
+            {
+                p = A->getParent();
+                A->setRight(B->getLeft());
+                if (!isGuard(A->getRight()))
+                {
+                    A->getRight()->setParent(A);
+                }
+
+                B->setLeft(A);
+                B->setParent(p);
+                A->setParent(B);
+
+                if (!isGuard(p))
+                {
+                    if (p->getLeft() == A)
+                    {
+
+                        p->setLeft(B);
+                    }
+                    else
+                    {
+
+                        p->setRight(B);
+                    }
+                }
+                else
+                {
+
+                    _root = B;
+                }
+                // A is child of B now, so it has to be updated first
+                Augment::update(A);
+                Augment::update(B);
+                _stats.rotated();
+            }
+        }
+
+        void rotateRight(MapNodePtr A)
+        {
+            MapNodePtr B, p;
+
+            B = A->getLeft();
+            if (!isGuard(B))
+            {
+                p = A->getParent();
+                A->setLeft(B->getRight());
+                if (!isGuard(A->getLeft()))
+                {
+                    A->getLeft()->setParent(A);
+                }
+
+                B->setRight(A);
+                B->setParent(p);
+                A->setParent(B);
+
+                if (!isGuard(p))
+                {
+                    if (p->getLeft() == A)
+                    {
+
+                        p->setLeft(B);
+                    }
+                    else
+                    {
+
+                        p->setRight(B);
+                    }
+                }
+                else
+                {
+
+                    _root = B;
+                }
+                // A is child of B now, so it has to be updated first
+                Augment::update(A);
+                Augment::update(B);
+                _stats.rotated();
+            }
+        }
+
+        // rotates parent of node, so node takes its place
+        void rotateUp(MapNodePtr node)
+        {
+            auto parent = node->getParent();
+            if (parent->getLeft() == node)
+            {
+                rotateRight(parent);
+            }
+            else
+            {
+                rotateLeft(parent);
+            }
+        }
+
+        // rotations of subtree which root parent link is not maintained, new root of subtree is returned
+        MapNodePtr rotateLeftDetached(MapNodePtr node)
+        {
+            auto right = node->getRight();
+            setChildren(node, node->getLeft(), right->getLeft());
+            setChildren(right, node, right->getRight());
+            _stats.rotated();
+            return right;
+        }
+
+        MapNodePtr rotateRightDetached(MapNodePtr node)
+        {
+            auto left = node->getLeft();
+            setChildren(node, left->getRight(), node->getRight());
+            setChildren(left, left->getLeft(), node);
+            _stats.rotated();
+            return left;
+        }
+
+        static void updateNode(MapNodePtr ptr) { Augment::update(ptr); }
+
+        std::pair<Iterator, bool> insertNode(MapNodePtr node)
+        {
+            auto result = linkNode(node);
+            if (!result.second)
+            {
+                deleteNode(node);
+            }
+            return result;
+        }
+
+        template <class Key, class... Args> std::pair<Iterator, bool> tryEmplaceKey(Key &&key, Args &&...args)
+        {
+            auto position = findInsertPosition(key);
+            if (position.found)
+            {
+                return {Iterator{position.parent}, false};
+            }
+            auto node = makeNode(std::in_place, std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+            attachNode(node, position.parent, position.left);
+            return {Iterator{node}, true};
+        }
+
+        // key is known before construction, so node is made only when it will be attached
+        template <class Value> Iterator insertHint(ConstIterator hint, Value &&value)
+        {
+            auto position = findHintPosition(mutableNode(hint._ptr), value.first);
+            if (position.found)
+            {
+                return Iterator{position.parent};
+            }
+            auto node = makeNode(std::forward<Value>(value));
+            attachNode(node, position.parent, position.left);
+            return Iterator{node};
+        }
+
+        template <class Key, class M> std::pair<Iterator, bool> insertOrAssignKey(Key &&key, M &&item)
+        {
+            auto position = findInsertPosition(key);
+            if (position.found)
+            {
+                position.parent->getItem() = std::forward<M>(item);
+                return {Iterator{position.parent}, false};
+            }
+            auto node = makeNode(std::in_place, std::forward<Key>(key), std::forward<M>(item));
+            attachNode(node, position.parent, position.left);
+            return {Iterator{node}, true};
+        }
+
+        // links node into tree, when key is already present tree is not changed and existing node is returned
+        std::pair<Iterator, bool> linkNode(MapNodePtr node)
+        {
+            auto position = findInsertPosition(node->getKey());
+            if (position.found)
+            {
+                return {Iterator{position.parent}, false};
+            }
+            attachNode(node, position.parent, position.left);
+            return {Iterator{node}, true};
+        }
+
+        struct InsertPosition
+        {
+            // node with same key when found, otherwise parent of new node (guard for empty tree)
+            MapNodePtr parent;
+            bool left;
+            bool found;
+        };
+
+        // checks in constant time if key belongs right before hint, otherwise falls back to search from root
+        InsertPosition findHintPosition(MapNodePtr hint, const K &key)
+        {
+            _stats.operation();
+            if (isGuard(_root))
+            {
+                return {_guardPtr, false, false};
+            }
+            if (isGuard(hint))
+            {
+                // appending after greatest key
+                if (compareKeys(key, _rightmost->getKey()) > 0)
+                {
+                    return {_rightmost, false, false};
+                }
+                return searchInsertPosition(key);
+            }
+            auto order = compareKeys(key, hint->getKey());
+            if (order == 0)
+            {
+                return {hint, false, true};
+            }
+            if (order < 0)
+            {
+                if (hint == _leftmost)
+                {
+                    return {hint, true, false};
+                }
+                auto previous = predecessor(hint);
+                if (compareKeys(key, previous->getKey()) > 0)
+                {
+                    // one of them has empty slot between them
+                    if (isGuard(previous->getRight()))
+                    {
+                        return {previous, false, false};
+                    }
+                    return {hint, true, false};
+                }
+            }
+            else
+            {
+                auto next = hint == _rightmost ? _guardPtr : succesor(hint);
+                if (isGuard(next) || compareKeys(key, next->getKey()) < 0)
+                {
+                    if (isGuard(hint->getRight()))
+                    {
+                        return {hint, false, false};
+                    }
+                    return {next, true, false};
+                }
+            }
+            return searchInsertPosition(key);
+        }
+
+        InsertPosition findInsertPosition(const K &key)
+        {
+            _stats.operation();
+            return searchInsertPosition(key);
+        }
+
+        InsertPosition searchInsertPosition(const K &key)
+        {
+            auto parent = _root;
+            if (isGuard(parent))
+            {
+                return {parent, false, false};
+            }
+            while (true)
+            {
+                _stats.visited();
+                auto order = compareKeys(key, parent->getKey());
+                if (order < 0)
+                {
+                    if (isGuard(parent->getLeft()))
+                    {
+                        return {parent, true, false};
+                    }
+                    parent = parent->getLeft();
+                }
+                else if (order > 0)
+                {
+                    if (isGuard(parent->getRight()))
+                    {
+                        return {parent, false, false};
+                    }
+                    parent = parent->getRight();
+                }
+                else
+                {
+                    return {parent, false, true};
+                }
+            }
+        }
+
+        /**
+         * Attaches node as left or right child of parent (guard for empty tree), that child has to be empty,
+         * and rebalances tree
+         */
+        void attachNode(MapNodePtr node, MapNodePtr parent, bool left)
+        {
+            node->setLeft(_guardPtr);
+            node->setRight(_guardPtr);
+            node->setParent(parent);
+            if (isGuard(parent))
+            {
+                _root = node;
+            }
+            else if (left)
+            {
+                parent->setLeft(node);
+            }
+            else
+            {
+                parent->setRight(node);
+            }
+            updatePath(node);
+            if (isGuard(_leftmost) || _leftmost->getLeft() == node)
+            {
+                _leftmost = node;
+            }
+            if (isGuard(_rightmost) || _rightmost->getRight() == node)
+            {
+                _rightmost = node;
+            }
+            Balance::attached(*this, node);
+            ++_size;
+        }
+
+        void removeNode(MapNodePtr node)
+        {
+            unlinkNode(node);
+            deleteNode(node);
+        }
+
+        // takes node out of tree and rebalances it, node itself is left untouched
+        void unlinkNode(MapNodePtr node)
+        {
+            // extreme nodes have at most one child, so their neighbour is found in constant time
+            if (node == _leftmost)
+            {
+                _leftmost = succesor(node);
+            }
+            if (node == _rightmost)
+            {
+                _rightmost = predecessor(node);
+            }
+            Balance::unlink(*this, node);
+            --_size;
+        }
+
+        struct Splice
+        {
+            // node which took place of removed one or of its successor, can be guard with parent link set
+            MapNodePtr child;
+            MapNodePtr parent;
+            // balance data of node which left its place, successor moved to place of removed node takes over its data
+            std::uint8_t balance;
+        };
+
+        // unlinks node without rebalancing, node with two children is replaced by its successor
+        Splice spliceNode(MapNodePtr node)
+        {
+            MapNodePtr Y, Z;
+            auto balance = node->getBalance();
+
+            if (isGuard(node->getLeft()))
+            {
+                Z = node->getRight();
+                transplant(node, Z);
+            }
+            else if (isGuard(node->getRight()))
+            {
+                Z = node->getLeft();
+                transplant(node, Z);
+            }
+            else
+            {
+                Y = minimum(node->getRight());
+                balance = Y->getBalance();
+                Z = Y->getRight();
+                if (Y->getParent() == node)
+                {
+                    Z->setParent(Y);
+                }
+                else
+                {
+                    transplant(Y, Z);
+                    Y->setRight(node->getRight());
+                    Y->getRight()->setParent(Y);
+                }
+                transplant(node, Y);
+                Y->setLeft(node->getLeft());
+                Y->getLeft()->setParent(Y);
+                Y->setBalance(node->getBalance());
+            }
+            // Z took place of removed node (or of moved successor), so only path above it changed
+            updatePath(Z->getParent());
+            return {Z, Z->getParent(), balance};
+        }
+
+        // replaces subtree rooted at A with subtree rooted at B
+        void transplant(MapNodePtr A, MapNodePtr B)
+        {
+            if (isGuard(A->getParent()))
+            {
+                _root = B;
+            }
+            else if (A == A->getParent()->getLeft())
+            {
+                A->getParent()->setLeft(B);
+            }
+            else
+            {
+                A->getParent()->setRight(B);
+            }
+            B->setParent(A->getParent());
+        }
+
+        template <class InputIt> bool isSortedUnique(InputIt first, InputIt last) const
+        {
+            if (first == last)
+            {
+                return true;
+            }
+            for (auto next = std::next(first); next != last; first = next++)
+            {
+                if (compareKeys((*first).first, (*next).first) >= 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // builds tree from sorted unique range in linear time, shape is chosen by balancing policy
+        template <class InputIt> void buildSorted(InputIt first, size_t count)
+        {
+            _root = Balance::build(*this, first, count);
+            _root->setParent(_guardPtr);
+            _size = count;
+            updateExtremes();
+        }
+
+        /**
+         * Builds perfectly balanced subtree, all levels except the deepest one are full. Finish sets balance data
+         * of node at depth once both its children are built
+         */
+        template <class InputIt, class Finish>
+        MapNodePtr buildBalanced(InputIt &it, size_t count, size_t depth, Finish &finish)
+        {
+            if (count == 0)
+            {
+                return _guardPtr;
+            }
+            auto leftCount = count / 2;
+            auto left = buildBalanced(it, leftCount, depth + 1, finish);
+            MapNodePtr node;
+            try
+            {
+                node = makeNode(*it);
+            }
+            catch (...)
+            {
+                removeAllNodes(left);
+                throw;
+            }
+            ++it;
+            node->setLeft(left);
+            node->setRight(_guardPtr);
+            left->setParent(node);
+            try
+            {
+                node->setRight(buildBalanced(it, count - leftCount - 1, depth + 1, finish));
+            }
+            catch (...)
+            {
+                removeAllNodes(node);
+                throw;
+            }
+            node->getRight()->setParent(node);
+            finish(node, depth);
+            Augment::update(node);
+            return node;
+        }
+
+        // recomputes augmentation data of whole subtree, children first
+        void updateSubtree(MapNodePtr ptr)
+        {
+            if constexpr (Augment::enabled)
+            {
+                if (!isGuard(ptr))
+                {
+                    updateSubtree(ptr->getLeft());
+                    updateSubtree(ptr->getRight());
+                    Augment::update(ptr);
+                }
+            }
+        }
+
+        /**
+         * Subtree of valid tree, its parent link is not maintained and for red black tree its root can be red.
+         * Rank is defined by balancing policy, black height for red black tree or height for AVL tree
+         */
+        struct Subtree
+        {
+            MapNodePtr root;
+            size_t rank;
+        };
+
+        struct SplitResult
+        {
+            Subtree left;
+            // node with split key, or guard
+            MapNodePtr middle;
+            Subtree right;
+        };
+
+        static size_t forkDepth() { return std::bit_width(std::max(1u, std::thread::hardware_concurrency())); }
+
+        /**
+         * Runs set operation on trees of both maps, both trees are moved under one guard first,
+         * operation returns resulting tree and counts nodes it deleted
+         */
+        template <class Operation> void setOperation(Map &other, Operation operation)
+        {
+            if (this == &other)
+            {
+                return;
+            }
+            auto total = _size + other._size;
+            shareGuard(other);
+            Subtree mine{_root, Balance::subtreeRank(*this, _root)};
+            Subtree theirs{other._root, Balance::subtreeRank(*this, other._root)};
+            other.resetTree();
+
+            size_t removed = 0;
+            _root = finishTree(operation(mine, theirs, removed));
+            _size = total - removed;
+            updateExtremes();
+        }
+
+        // forgets nodes, they have to be owned by other map already
+        void resetTree()
+        {
+            _root = _guardPtr;
+            _leftmost = _guardPtr;
+            _rightmost = _guardPtr;
+            _size = 0;
+        }
+
+        // moves nodes of other map subtree one by one, nodes with present keys are deleted
+        void insertSubtree(Map &other, MapNodePtr ptr)
+        {
+            if (other.isGuard(ptr))
+            {
+                return;
+            }
+            auto left = ptr->getLeft(), right = ptr->getRight();
+            insertSubtree(other, left);
+            insertSubtree(other, right);
+            insertNode(ptr);
+        }
+
+        // relinks leafs of smaller tree to guard of bigger one, this map takes over that guard
+        void shareGuard(Map &other)
+        {
+            auto mineEmpty = empty(), theirsEmpty = other.empty();
+            if (_size < other._size)
+            {
+                rebaseSubtree(_root, _guardPtr, other._guardPtr);
+                std::swap(_guardPtr, other._guardPtr);
+            }
+            else
+            {
+                rebaseSubtree(other._root, other._guardPtr, _guardPtr);
+            }
+            _root = mineEmpty ? _guardPtr : _root;
+            other._root = theirsEmpty ? _guardPtr : other._root;
+        }
+
+        void rebaseSubtree(MapNodePtr ptr, MapNodePtr from, MapNodePtr to)
+        {
+            if (ptr == from)
+            {
+                return;
+            }
+            if (ptr->getParent() == from)
+            {
+                ptr->setParent(to);
+            }
+            if (ptr->getLeft() == from)
+            {
+                ptr->setLeft(to);
+            }
+            else
+            {
+                rebaseSubtree(ptr->getLeft(), from, to);
+            }
+            if (ptr->getRight() == from)
+            {
+                ptr->setRight(to);
+            }
+            else
+            {
+                rebaseSubtree(ptr->getRight(), from, to);
+            }
+        }
+
+        MapNodePtr finishTree(Subtree tree)
+        {
+            if (!isGuard(tree.root))
+            {
+                tree.root->setParent(_guardPtr);
+                Balance::finishRoot(*this, tree.root);
+            }
+            return tree.root;
+        }
+
+        Subtree leftSubtree(Subtree tree) const
+        {
+            return {tree.root->getLeft(), Balance::childRank(*this, tree, tree.root->getLeft())};
+        }
+
+        Subtree rightSubtree(Subtree tree) const
+        {
+            return {tree.root->getRight(), Balance::childRank(*this, tree, tree.root->getRight())};
+        }
+
+        void setChildren(MapNodePtr node, MapNodePtr left, MapNodePtr right)
+        {
+            node->setLeft(left);
+            node->setRight(right);
+            if (!isGuard(left))
+            {
+                left->setParent(node);
+            }
+            if (!isGuard(right))
+            {
+                right->setParent(node);
+            }
+            Augment::update(node);
+        }
+
+        // joins trees with node which key is between keys of left and right tree
+        Subtree joinTrees(Subtree left, MapNodePtr node, Subtree right)
+        {
+            return Balance::join(*this, left, node, right);
+        }
+
+        // joins trees without middle node, greatest node of left tree takes its place
+        Subtree joinTrees(Subtree left, Subtree right)
+        {
+            if (isGuard(left.root))
+            {
+                return right;
+            }
+            auto [rest, last] = splitLast(left);
+            return joinTrees(rest, last, right);
+        }
+
+        std::pair<Subtree, MapNodePtr> splitLast(Subtree tree)
+        {
+            auto node = tree.root;
+            auto left = leftSubtree(tree);
+            if (isGuard(node->getRight()))
+            {
+                return {left, node};
+            }
+            auto [rest, last] = splitLast(rightSubtree(tree));
+            return {joinTrees(left, node, rest), last};
+        }
+
+        // splits tree to nodes with keys less and greater than key, node with key itself is returned as middle
+        SplitResult splitTree(Subtree tree, const K &key)
+        {
+            auto node = tree.root;
+            if (isGuard(node))
+            {
+                return {tree, _guardPtr, tree};
+            }
+            auto left = leftSubtree(tree), right = rightSubtree(tree);
+            auto order = compareKeys(key, node->getKey());
+            if (order < 0)
+            {
+                auto result = splitTree(left, key);
+                result.right = joinTrees(result.right, node, right);
+                return result;
+            }
+            if (order > 0)
+            {
+                auto result = splitTree(right, key);
+                result.left = joinTrees(left, node, result.left);
+                return result;
+            }
+            return {left, node, right};
+        }
+
+        /**
+         * Runs both recursive calls of set operation, on separate threads while fork depth lasts
+         * and both subtrees are big enough, each call counts its deleted nodes separately
+         */
+        template <class Left, class Right>
+        std::pair<Subtree, Subtree> forkJoin(Subtree mine, Subtree theirs, size_t &removed, size_t forks, Left left,
+                                             Right right)
+        {
+            size_t leftRemoved = 0, rightRemoved = 0;
+            std::pair<Subtree, Subtree> result;
+            if (forks > 0 && std::min(mine.rank, theirs.rank) >= Balance::ParallelMinRank)
+            {
+                auto future = std::async(std::launch::async, [&] { return left(leftRemoved, forks - 1); });
+                result.second = right(rightRemoved, forks - 1);
+                result.first = future.get();
+            }
+            else
+            {
+                result = {left(leftRemoved, 0), right(rightRemoved, 0)};
+            }
+            removed += leftRemoved + rightRemoved;
+            return result;
+        }
+
+        // parallel traversal of smaller maps costs more in thread start than it saves
+        static constexpr size_t ParallelMinSize = 1 << 14;
+
+        // deep enough for about eight subtrees per thread, so threads finishing early take over remaining work
+        static size_t taskDepth(size_t threads) { return std::bit_width(threads) + 3; }
+
+        template <class Ptr> void collectSubtrees(Ptr ptr, size_t depth, std::vector<Ptr> &subtrees) const
+        {
+            if (depth == 0 || isGuard(ptr))
+            {
+                subtrees.push_back(ptr);
+                return;
+            }
+            collectSubtrees(ptr->getLeft(), depth - 1, subtrees);
+            collectSubtrees(ptr->getRight(), depth - 1, subtrees);
+        }
+
+        template <class Ptr, class Function> void visitSubtree(Ptr ptr, Function &&function) const
+        {
+            while (!isGuard(ptr))
+            {
+                visitSubtree(ptr->getLeft(), function);
+                function(ptr->getPair());
+                ptr = ptr->getRight();
+            }
+        }
+
+        /**
+         * Runs task for every index below count, calling thread works too. Each thread takes next index
+         * when it is done with previous one, exception of task is rethrown after all threads finish
+         */
+        template <class Task> static void runTasks(size_t count, size_t threads, Task task)
+        {
+            std::atomic<size_t> next = 0;
+            auto worker = [&] {
+                for (auto index = next++; index < count; index = next++)
+                {
+                    task(index);
+                }
+            };
+            std::vector<std::future<void>> workers;
+            for (size_t i = 1; i < std::min(threads, count); ++i)
+            {
+                workers.push_back(std::async(std::launch::async, worker));
+            }
+            worker();
+            for (auto &future : workers)
+            {
+                future.get();
+            }
+        }
+
+        template <class Ptr, class Function> void forEachParallel(Ptr root, Function &function, size_t threads) const
+        {
+            threads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+            if (threads == 1 || _size < ParallelMinSize)
+            {
+                visitSubtree(root, function);
+                return;
+            }
+            auto depth = taskDepth(threads);
+            std::vector<Ptr> subtrees;
+            collectSubtrees(root, depth, subtrees);
+            runTasks(subtrees.size(), threads, [&](size_t index) { visitSubtree(subtrees[index], function); });
+            visitTop(root, depth, function);
+        }
+
+        // nodes above subtrees collected at depth
+        template <class Ptr, class Function> void visitTop(Ptr ptr, size_t depth, Function &function) const
+        {
+            if (depth > 0 && !isGuard(ptr))
+            {
+                visitTop(ptr->getLeft(), depth - 1, function);
+                function(ptr->getPair());
+                visitTop(ptr->getRight(), depth - 1, function);
+            }
+        }
+
+        // combines subtree results with nodes above them in key order, consumes results from index
+        template <class R, class Transform, class Combine>
+        std::optional<R> combineTop(ConstMapNodePtr ptr, size_t depth, std::vector<std::optional<R>> &results,
+                                    size_t &index, Transform &transform, Combine &combine) const
+        {
+            if (depth == 0 || isGuard(ptr))
+            {
+                return std::move(results[index++]);
+            }
+            auto result = combineTop(ptr->getLeft(), depth - 1, results, index, transform, combine);
+            result = result ? combine(std::move(*result), transform(ptr->getPair())) : R(transform(ptr->getPair()));
+            if (auto right = combineTop(ptr->getRight(), depth - 1, results, index, transform, combine))
+            {
+                result = combine(std::move(*result), std::move(*right));
+            }
+            return result;
+        }
+
+        size_t deleteSubtree(MapNodePtr ptr)
+        {
+            if (isGuard(ptr))
+            {
+                return 0;
+            }
+            auto count = deleteSubtree(ptr->getLeft()) + deleteSubtree(ptr->getRight()) + 1;
+            deleteNode(ptr);
+            return count;
+        }
+
+        /**
+         * Roots of splitter tree split other tree, splitter should be the smaller one so recursion visits
+         * its nodes only. For duplicated keys node of splitter tree is kept when keepSplitter is set
+         */
+        Subtree uniteTrees(Subtree splitter, Subtree other, bool keepSplitter, size_t &removed, size_t forks)
+        {
+            if (isGuard(splitter.root))
+            {
+                return other;
+            }
+            if (isGuard(other.root))
+            {
+                return splitter;
+            }
+            auto node = splitter.root;
+            auto splitterLeft = leftSubtree(splitter), splitterRight = rightSubtree(splitter);
+            auto parts = splitTree(other, node->getKey());
+            auto [left, right] = forkJoin(
+                splitter, other, removed, forks,
+                [&](size_t &count, size_t childForks) {
+                    return uniteTrees(splitterLeft, parts.left, keepSplitter, count, childForks);
+                },
+                [&](size_t &count, size_t childForks) {
+                    return uniteTrees(splitterRight, parts.right, keepSplitter, count, childForks);
+                });
+            if (!isGuard(parts.middle))
+            {
+                ++removed;
+                if (!keepSplitter)
+                {
+                    std::swap(node, parts.middle);
+                }
+                deleteNode(parts.middle);
+            }
+            return joinTrees(left, node, right);
+        }
+
+        Subtree intersectTrees(Subtree mine, Subtree theirs, size_t &removed, size_t forks)
+        {
+            if (isGuard(mine.root) || isGuard(theirs.root))
+            {
+                removed += deleteSubtree(mine.root) + deleteSubtree(theirs.root);
+                return {_guardPtr, 0};
+            }
+            auto node = mine.root;
+            auto mineLeft = leftSubtree(mine), mineRight = rightSubtree(mine);
+            auto parts = splitTree(theirs, node->getKey());
+            auto [left, right] = forkJoin(
+                mine, theirs, removed, forks,
+                [&](size_t &count, size_t childForks) {
+                    return intersectTrees(mineLeft, parts.left, count, childForks);
+                },
+                [&](size_t &count, size_t childForks) {
+                    return intersectTrees(mineRight, parts.right, count, childForks);
+                });
+            ++removed;
+            if (!isGuard(parts.middle))
+            {
+                deleteNode(parts.middle);
+                return joinTrees(left, node, right);
+            }
+            deleteNode(node);
+            return joinTrees(left, right);
+        }
+
+        // theirs root splits mine tree, it is deleted together with matching node of mine tree
+        Subtree subtractTrees(Subtree mine, Subtree theirs, size_t &removed, size_t forks)
+        {
+            if (isGuard(mine.root) || isGuard(theirs.root))
+            {
+                removed += deleteSubtree(theirs.root);
+                return mine;
+            }
+            auto node = theirs.root;
+            auto theirsLeft = leftSubtree(theirs), theirsRight = rightSubtree(theirs);
+            auto parts = splitTree(mine, node->getKey());
+            auto [left, right] = forkJoin(
+                mine, theirs, removed, forks,
+                [&](size_t &count, size_t childForks) {
+                    return subtractTrees(parts.left, theirsLeft, count, childForks);
+                },
+                [&](size_t &count, size_t childForks) {
+                    return subtractTrees(parts.right, theirsRight, count, childForks);
+                });
+            deleteNode(node);
+            ++removed;
+            if (!isGuard(parts.middle))
+            {
+                deleteNode(parts.middle);
+                ++removed;
+            }
+            return joinTrees(left, right);
+        }
+
+        void cloneTree(const Map &other)
+        {
+            if constexpr (Balance::CopyableShape)
+            {
+                _root = cloneSubtree(other, other._root, _guardPtr);
+                _size = other._size;
+                updateExtremes();
+            }
+            else
+            {
+                buildSorted(other.begin(), other._size);
+            }
+        }
+
+        MapNodePtr cloneSubtree(const Map &other, ConstMapNodePtr ptr, MapNodePtr parent)
+        {
+            if (other.isGuard(ptr))
+            {
+                return _guardPtr;
+            }
+            auto node = makeNode(ptr->getPair());
+            node->setBalance(ptr->getBalance());
+            node->getAugment() = ptr->getAugment();
+            node->setParent(parent);
+            node->setLeft(_guardPtr);
+            node->setRight(_guardPtr);
+            try
+            {
+                node->setLeft(cloneSubtree(other, ptr->getLeft(), node));
+                node->setRight(cloneSubtree(other, ptr->getRight(), node));
+            }
+            catch (...)
+            {
+                removeAllNodes(node);
+                throw;
+            }
+            return node;
+        }
+
+        void removeAllNodes(MapNodePtr ptr)
+        {
+            if (!isGuard(ptr))
+            {
+                removeAllNodes(ptr->getLeft());
+                removeAllNodes(ptr->getRight());
+                deleteNode(ptr);
+            }
+        }
+
+        // runs only node destructors, memory is given back by allocator releaseAll
+        void destroyAllNodes(MapNodePtr ptr)
+        {
+            if constexpr (!std::is_trivially_destructible_v<Node>)
+            {
+                if (!isGuard(ptr))
+                {
+                    destroyAllNodes(ptr->getLeft());
+                    destroyAllNodes(ptr->getRight());
+                    std::destroy_at(ptr);
+                }
+            }
+        }
+
+        void assertNode(ConstMapNodePtr ptr) const
+        {
+            if (isGuard(ptr))
+            {
+                throw std::out_of_range("Item was not found");
+            }
+        }
+
+        void assertBatchSize(size_t keys, size_t results) const
+        {
+            if (results < keys)
+            {
+                throw std::invalid_argument("Results span is smaller than keys span");
+            }
+        }
+
+        void assertEmpty() const
+        {
+            if (empty())
+            {
+                throw std::runtime_error("Map is empty");
+            }
+        }
+
+        bool isGuard(ConstMapNodePtr const ptr) const { return ptr == _guardPtr; }
+
+        size_t subtreeHeight(ConstMapNodePtr ptr) const
+        {
+            return isGuard(ptr) ? 0 : 1 + std::max(subtreeHeight(ptr->getLeft()), subtreeHeight(ptr->getRight()));
+        }
+
+        bool isRed(ConstMapNodePtr ptr) const { return !isGuard(ptr) && ptr->getColor() == Color::Red; }
+
+        size_t spineBlackHeight() const
+        {
+            size_t height = 0;
+            for (auto ptr = _root; !isGuard(ptr); ptr = ptr->getLeft())
+            {
+                height += !isRed(ptr);
+            }
+            return height;
+        }
+
+        // black height of subtree, empty when its paths differ in black nodes or some red node has red child
+        std::optional<size_t> checkRedBlack(ConstMapNodePtr ptr) const
+        {
+            if (isGuard(ptr))
+            {
+                return 0;
+            }
+            auto left = checkRedBlack(ptr->getLeft());
+            auto right = checkRedBlack(ptr->getRight());
+            auto redChild = isRed(ptr->getLeft()) || isRed(ptr->getRight());
+            if (!left || !right || *left != *right || (isRed(ptr) && redChild))
+            {
+                return std::nullopt;
+            }
+            return *left + !isRed(ptr);
+        }
+
+        template <class... Args> MapNodePtr makeNode(Args &&...args)
+        {
+            auto ptr = _allocator.allocate();
+            try
+            {
+                return new (ptr) Node(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                _allocator.deallocate(ptr);
+                throw;
+            }
+        }
+
+        void deleteNode(MapNodePtr ptr)
+        {
+            auto node = static_cast<Node *>(ptr);
+            std::destroy_at(node);
+            _allocator.deallocate(node);
+        }
+
+        // guard is only links part of node, it is used as sentinel for leafs and root parent
+        static MapNodePtr makeGuard()
+        {
+            auto guard = new Links;
+            guard->setParent(guard);
+            guard->setLeft(guard);
+            guard->setRight(guard);
+            return guard;
+        }
+
+        static void deleteGuard(MapNodePtr guard) { delete guard; }
+    };
+
+    /**
+     * Map from closed intervals to items, answers which intervals overlap given interval or contain given point
+     * through visitOverlapping and visitStabbing
+     */
+    template <class E, class T, template <class> class Allocator = HeapNodeAllocator>
+    using IntervalMap = Map<Interval<E>, T, std::less<Interval<E>>, Allocator, MaxEndpoint<E>>;
+
+    template <class K, class T, class C, template <class> class A, class G, template <class, class> class L,
+              class B, class S>
+    bool operator==(const Map<K, T, C, A, G, L, B, S> &lhs, const Map<K, T, C, A, G, L, B, S> &rhs)
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    template <class K, class T, class C, template <class> class A, class G, template <class, class> class L,
+              class B, class S>
+    bool operator!=(const Map<K, T, C, A, G, L, B, S> &lhs, const Map<K, T, C, A, G, L, B, S> &rhs)
+    {
+        return !(lhs == rhs);
+    }
 
-    template <class K, class T> bool operator<(const Map<K, T> &lhs, const Map<K, T> &rhs)
+    template <class K, class T, class C, template <class> class A, class G, template <class, class> class L,
+              class B, class S>
+    bool operator<(const Map<K, T, C, A, G, L, B, S> &lhs, const Map<K, T, C, A, G, L, B, S> &rhs)
     {
         return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
 
-    template <class K, class T> bool operator<=(const Map<K, T> &lhs, const Map<K, T> &rhs)
+    template <class K, class T, class C, template <class> class A, class G, template <class, class> class L,
+              class B, class S>
+    bool operator<=(const Map<K, T, C, A, G, L, B, S> &lhs, const Map<K, T, C, A, G, L, B, S> &rhs)
     {
         return lhs < rhs || lhs == rhs;
     }
 
-    template <class K, class T> bool operator>(const Map<K, T> &lhs, const Map<K, T> &rhs)
+    template <class K, class T, class C, template <class> class A, class G, template <class, class> class L,
+              class B, class S>
+    bool operator>(const Map<K, T, C, A, G, L, B, S> &lhs, const Map<K, T, C, A, G, L, B, S> &rhs)
     {
         return std::lexicographical_compare(rhs.begin(), rhs.end(), lhs.begin(), lhs.end());
     }
 
-    template <class K, class T> bool operator>=(const Map<K, T> &lhs, const Map<K, T> &rhs)
+    template <class K, class T, class C, template <class> class A, class G, template <class, class> class L,
+              class B, class S>
+    bool operator>=(const Map<K, T, C, A, G, L, B, S> &lhs, const Map<K, T, C, A, G, L, B, S> &rhs)
     {
         return lhs > rhs || lhs == rhs;
     }
@@ -0,0 +1,143 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace sd
+{
+    /**
+     * Header of map snapshot file. Sections follow it at page boundaries, so mapped file is used in place:
+     * sorted keys, items in order of keys and levels of implicit B+ tree index. Entry i of level l + 1 is greatest
+     * key of block i of level l (level 0 being keys), block has BlockKeys entries, highest level fits in one block.
+     * Values are stored in byte order of machine which wrote the file
+     */
+    struct MapSnapshotHeader
+    {
+        static constexpr char Magic[8] = {'s', 'd', 'M', 'a', 'p', 'S', 'n', 'p'};
+        static constexpr std::uint32_t CurrentVersion = 1;
+        static constexpr std::uint32_t ByteOrderMark = 0x01020304;
+        static constexpr size_t PageSize = 4096;
+        static constexpr size_t BlockKeys = 16;
+        static constexpr size_t MaxLevels = 16;
+
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint64_t keySize;
+        std::uint64_t keyAlign;
+        std::uint64_t itemSize;
+        std::uint64_t itemAlign;
+        std::uint64_t blockKeys;
+        std::uint64_t count;
+        std::uint64_t keysOffset;
+        std::uint64_t itemsOffset;
+        std::uint64_t levelCount;
+        std::uint64_t levelOffsets[MaxLevels];
+        std::uint64_t levelSizes[MaxLevels];
+        std::uint64_t fileSize;
+
+        bool operator==(const MapSnapshotHeader &other) const = default;
+
+        static std::uint64_t alignToPage(std::uint64_t offset) { return (offset + PageSize - 1) / PageSize * PageSize; }
+
+        // header of snapshot with count elements, file of any other layout is rejected when opened
+        template <class K, class T> static MapSnapshotHeader make(size_t count)
+        {
+            MapSnapshotHeader header{};
+            std::copy(std::begin(Magic), std::end(Magic), header.magic);
+            header.version = CurrentVersion;
+            header.byteOrder = ByteOrderMark;
+            header.keySize = sizeof(K);
+            header.keyAlign = alignof(K);
+            header.itemSize = sizeof(T);
+            header.itemAlign = alignof(T);
+            header.blockKeys = BlockKeys;
+            header.count = count;
+            header.keysOffset = alignToPage(sizeof(MapSnapshotHeader));
+            header.itemsOffset = alignToPage(header.keysOffset + count * sizeof(K));
+            header.fileSize = header.itemsOffset + count * sizeof(T);
+            for (auto size = count; size > BlockKeys; ++header.levelCount)
+            {
+                size = (size + BlockKeys - 1) / BlockKeys;
+                header.levelOffsets[header.levelCount] = alignToPage(header.fileSize);
+                header.levelSizes[header.levelCount] = size;
+                header.fileSize = header.levelOffsets[header.levelCount] + size * sizeof(K);
+            }
+            return header;
+        }
+    };
+
+    /**
+     * Writes count elements from sorted range of unique keys as snapshot served by MappedMap. Range is read twice,
+     * so it has to be multipass, keys and items are streamed to file and only first index level, 1/16 of keys,
+     * is kept in memory
+     */
+    template <class K, class T, class InputIt>
+    void writeMapSnapshot(const std::string &path, InputIt first, size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<T>,
+                      "Snapshot stores keys and items as raw bytes");
+        using Header = MapSnapshotHeader;
+
+        auto header = Header::make<K, T>(count);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            throw std::runtime_error("Cannot write map snapshot " + path);
+        }
+        std::uint64_t position = 0;
+        auto write = [&](const void *data, size_t size) {
+            file.write(static_cast<const char *>(data), std::streamsize(size));
+            position += size;
+        };
+        auto padTo = [&](std::uint64_t offset) {
+            static constexpr char zeros[Header::PageSize] = {};
+            write(zeros, offset - position);
+        };
+
+        write(&header, sizeof(header));
+        padTo(header.keysOffset);
+        std::vector<K> level;
+        level.reserve(count / Header::BlockKeys + 1);
+        auto it = first;
+        for (size_t i = 0; i < count; ++i, ++it)
+        {
+            const K &key = (*it).first;
+            write(&key, sizeof(K));
+            if (i % Header::BlockKeys == Header::BlockKeys - 1 || i == count - 1)
+            {
+                level.push_back(key);
+            }
+        }
+        padTo(header.itemsOffset);
+        it = first;
+        for (size_t i = 0; i < count; ++i, ++it)
+        {
+            const T &item = (*it).second;
+            write(&item, sizeof(T));
+        }
+        for (size_t l = 0; l < header.levelCount; ++l)
+        {
+            padTo(header.levelOffsets[l]);
+            write(level.data(), level.size() * sizeof(K));
+            std::vector<K> next;
+            for (size_t i = Header::BlockKeys - 1; i < level.size() + Header::BlockKeys - 1; i += Header::BlockKeys)
+            {
+                next.push_back(level[std::min(i, level.size() - 1)]);
+            }
+            level.swap(next);
+        }
+        padTo(header.fileSize);
+        file.close();
+        if (!file)
+        {
+            throw std::runtime_error("Cannot write map snapshot " + path);
+        }
+    }
+} // namespace sd
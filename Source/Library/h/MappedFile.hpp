@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace sd
+{
+    /**
+     * Read only memory mapping of whole file. Mapping itself costs the same for any file size, pages are read by
+     * system on first access. Throws std::runtime_error when file cannot be opened or mapped
+     */
+    class MappedFile
+    {
+      private:
+        const std::byte *_data = nullptr;
+        size_t _size = 0;
+
+      public:
+        MappedFile() = default;
+        explicit MappedFile(const std::string &path);
+        MappedFile(const MappedFile &other) = delete;
+        MappedFile(MappedFile &&other);
+        ~MappedFile();
+
+        MappedFile &operator=(const MappedFile &other) = delete;
+        MappedFile &operator=(MappedFile &&other);
+
+        const std::byte *data() const { return _data; }
+
+        size_t size() const { return _size; }
+
+        void swap(MappedFile &other);
+
+        void close();
+    };
+} // namespace sd
@@ -0,0 +1,230 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "FlatMap.hpp"
+#include "MapSnapshot.hpp"
+#include "MappedFile.hpp"
+
+namespace sd
+{
+    /**
+     * Read only ordered map served in place from snapshot file written by Map::saveSnapshot. Opening maps the file
+     * and checks its header, so it takes same time for any number of elements and nothing is parsed or copied,
+     * pages are read when first touched. Lookups descend implicit B+ tree with one block of 16 keys per level,
+     * iteration walks sorted key and item arrays. Compare has to order keys same way as map which wrote the file
+     */
+    template <class K, class T, class Compare = std::less<K>> class MappedMap
+    {
+        static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<T>,
+                      "Snapshot stores keys and items as raw bytes");
+
+      private:
+        using Header = MapSnapshotHeader;
+
+        static constexpr size_t BlockKeys = Header::BlockKeys;
+
+        MappedFile _file;
+        const K *_keys = nullptr;
+        const T *_items = nullptr;
+        size_t _size = 0;
+        // index levels, last one fits in single block
+        std::array<const K *, Header::MaxLevels> _levels = {};
+        std::array<size_t, Header::MaxLevels> _levelSizes = {};
+        size_t _levelCount = 0;
+        [[no_unique_address]] Compare _compare;
+
+      public:
+        using Iterator = FlatMapIterator<K, T, true, false>;
+        using ConstIterator = Iterator;
+
+        using ReverseIterator = FlatMapIterator<K, T, true, true>;
+        using ConstReverseIterator = ReverseIterator;
+
+        // Constructors
+        MappedMap() = default;
+
+        MappedMap(const MappedMap &other) = delete;
+
+        MappedMap(MappedMap &&other) { swap(other); }
+
+        /**
+         * Maps snapshot file, throws std::runtime_error when file cannot be mapped or was written for other key
+         * or item type
+         */
+        static MappedMap open(const std::string &path)
+        {
+            MappedMap map;
+            map._file = MappedFile(path);
+            Header header;
+            if (map._file.size() < sizeof(header))
+            {
+                throwInvalid(path);
+            }
+            std::memcpy(&header, map._file.data(), sizeof(header));
+            // count is checked first, so layout computed from it cannot overflow
+            if (header.count > map._file.size() || header != Header::make<K, T>(header.count) ||
+                header.fileSize > map._file.size())
+            {
+                throwInvalid(path);
+            }
+            auto data = map._file.data();
+            map._keys = reinterpret_cast<const K *>(data + header.keysOffset);
+            map._items = reinterpret_cast<const T *>(data + header.itemsOffset);
+            map._size = header.count;
+            map._levelCount = header.levelCount;
+            for (size_t l = 0; l < map._levelCount; ++l)
+            {
+                map._levels[l] = reinterpret_cast<const K *>(data + header.levelOffsets[l]);
+                map._levelSizes[l] = header.levelSizes[l];
+            }
+            return map;
+        }
+
+        // Assign
+        MappedMap &operator=(const MappedMap &other) = delete;
+
+        MappedMap &operator=(MappedMap &&other)
+        {
+            if (this != &other)
+            {
+                MappedMap{}.swap(*this);
+                swap(other);
+            }
+            return *this;
+        }
+
+        // Element access
+        const T &at(const K &key) const
+        {
+            auto index = findIndex(key);
+            if (index == _size)
+            {
+                throw std::out_of_range("Item was not found");
+            }
+            return _items[index];
+        }
+
+        const T &operator[](const K &key) const { return at(key); }
+
+        // sorted keys and items stored at matching positions
+        std::span<const K> keys() const { return {_keys, _size}; }
+
+        std::span<const T> items() const { return {_items, _size}; }
+
+        // LookUp
+        ConstIterator find(const K &key) const { return makeIterator(findIndex(key)); }
+
+        bool contains(const K &key) const { return findIndex(key) != _size; }
+
+        // Bounds, first element not less than key
+        ConstIterator lowerBound(const K &key) const { return makeIterator(lowerBoundIndex(key)); }
+
+        // first element greater than key
+        ConstIterator upperBound(const K &key) const { return makeIterator(upperBoundIndex(key)); }
+
+        // elements with keys in [low, high)
+        MapRange<ConstIterator> range(const K &low, const K &high) const
+        {
+            auto last = lowerBoundIndex(high);
+            return {makeIterator(_compare(low, high) ? lowerBoundIndex(low) : last), makeIterator(last)};
+        }
+
+        // Capacity
+        size_t size() const { return _size; }
+
+        bool empty() const { return _size == 0; }
+
+        // Iterators
+        ConstIterator begin() const { return makeIterator(0); }
+        ConstIterator end() const { return makeIterator(_size); }
+
+        ConstIterator cBegin() const { return begin(); }
+        ConstIterator cEnd() const { return end(); }
+
+        ConstReverseIterator rBegin() const { return ConstReverseIterator{_keys, _items, ssize() - 1, ssize()}; }
+        ConstReverseIterator rEnd() const { return ConstReverseIterator{_keys, _items, -1, ssize()}; }
+
+        ConstReverseIterator crBegin() const { return rBegin(); }
+        ConstReverseIterator crEnd() const { return rEnd(); }
+
+        void swap(MappedMap &other)
+        {
+            _file.swap(other._file);
+            std::swap(_keys, other._keys);
+            std::swap(_items, other._items);
+            std::swap(_size, other._size);
+            std::swap(_levels, other._levels);
+            std::swap(_levelSizes, other._levelSizes);
+            std::swap(_levelCount, other._levelCount);
+            std::swap(_compare, other._compare);
+        }
+
+      private:
+        std::ptrdiff_t ssize() const { return std::ptrdiff_t(_size); }
+
+        ConstIterator makeIterator(size_t index) const
+        {
+            return ConstIterator{_keys, _items, std::ptrdiff_t(index), ssize()};
+        }
+
+        /**
+         * Counts keys of block starting at first for which before holds, keys are sorted, so that is position of
+         * first key for which it does not. Counting has no branches and vectorizes for arithmetic keys
+         */
+        template <class Before> static size_t searchBlock(const K *keys, size_t size, size_t first, Before before)
+        {
+            auto last = std::min(first + BlockKeys, size);
+            auto index = first;
+            for (auto i = first; i < last; ++i)
+            {
+                index += before(keys[i]);
+            }
+            return index;
+        }
+
+        // block chosen on each level ends with key for which before does not hold, so only top level can miss
+        template <class Before> size_t boundIndex(Before before) const
+        {
+            size_t index = 0;
+            for (auto level = _levelCount; level > 0; --level)
+            {
+                index = searchBlock(_levels[level - 1], _levelSizes[level - 1], index * BlockKeys, before);
+                if (index == _levelSizes[level - 1])
+                {
+                    return _size;
+                }
+            }
+            return searchBlock(_keys, _size, index * BlockKeys, before);
+        }
+
+        size_t lowerBoundIndex(const K &key) const
+        {
+            return boundIndex([&](const K &other) { return _compare(other, key); });
+        }
+
+        size_t upperBoundIndex(const K &key) const
+        {
+            return boundIndex([&](const K &other) { return !_compare(key, other); });
+        }
+
+        size_t findIndex(const K &key) const
+        {
+            auto index = lowerBoundIndex(key);
+            return index != _size && !_compare(key, _keys[index]) ? index : _size;
+        }
+
+        [[noreturn]] static void throwInvalid(const std::string &path)
+        {
+            throw std::runtime_error("Invalid map snapshot " + path);
+        }
+    };
+} // namespace sd
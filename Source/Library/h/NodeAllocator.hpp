@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace sd
+{
+    /**
+     * Default node allocation policy, every node gets its own heap allocation
+     */
+    template <class Node> class HeapNodeAllocator
+    {
+      public:
+        // nodes have to be freed one by one, releaseAll is not supported
+        static constexpr bool canReleaseAll = false;
+        // any instance can free node allocated by other one, so nodes can move between maps
+        static constexpr bool isAlwaysEqual = true;
+
+        HeapNodeAllocator() = default;
+        HeapNodeAllocator(const HeapNodeAllocator &) = delete;
+        HeapNodeAllocator(HeapNodeAllocator &&) = default;
+
+        HeapNodeAllocator &operator=(const HeapNodeAllocator &) = delete;
+        HeapNodeAllocator &operator=(HeapNodeAllocator &&) = default;
+
+        Node *allocate() { return std::allocator<Node>{}.allocate(1); }
+
+        void deallocate(Node *ptr) { std::allocator<Node>{}.deallocate(ptr, 1); }
+
+        void releaseAll() {}
+
+        void swap(HeapNodeAllocator &) {}
+    };
+
+    /**
+     * Slab node allocation policy, nodes are carved out of contiguous chunks of ChunkSize nodes,
+     * freed nodes are reused through free list and all chunks can be released at once with releaseAll
+     */
+    template <class Node, size_t ChunkSize = 1024> class PoolNodeAllocator
+    {
+        static_assert(ChunkSize > 0, "Chunk size must be greater than zero");
+
+      private:
+        union Slot {
+            Slot *next;
+            alignas(Node) std::byte storage[sizeof(Node)];
+        };
+
+        std::vector<std::unique_ptr<Slot[]>> _chunks;
+        Slot *_freeList = nullptr;
+        size_t _chunkUsed = ChunkSize;
+
+      public:
+        static constexpr bool canReleaseAll = true;
+        static constexpr bool isAlwaysEqual = false;
+
+        PoolNodeAllocator() = default;
+        PoolNodeAllocator(const PoolNodeAllocator &) = delete;
+        PoolNodeAllocator(PoolNodeAllocator &&other) { swap(other); }
+
+        PoolNodeAllocator &operator=(const PoolNodeAllocator &) = delete;
+        PoolNodeAllocator &operator=(PoolNodeAllocator &&other)
+        {
+            releaseAll();
+            swap(other);
+            return *this;
+        }
+
+        ~PoolNodeAllocator() = default;
+
+        Node *allocate()
+        {
+            if (_freeList)
+            {
+                auto slot = _freeList;
+                _freeList = slot->next;
+                return reinterpret_cast<Node *>(slot->storage);
+            }
+            if (_chunkUsed == ChunkSize)
+            {
+                _chunks.emplace_back(new Slot[ChunkSize]);
+                _chunkUsed = 0;
+            }
+            return reinterpret_cast<Node *>(_chunks.back()[_chunkUsed++].storage);
+        }
+
+        void deallocate(Node *ptr)
+        {
+            auto slot = reinterpret_cast<Slot *>(ptr);
+            slot->next = _freeList;
+            _freeList = slot;
+        }
+
+        /**
+         * Frees all chunks at once, every node allocated from this pool becomes invalid
+         */
+        void releaseAll()
+        {
+            _chunks.clear();
+            _freeList = nullptr;
+            _chunkUsed = ChunkSize;
+        }
+
+        void swap(PoolNodeAllocator &other)
+        {
+            std::swap(_chunks, other._chunks);
+            std::swap(_freeList, other._freeList);
+            std::swap(_chunkUsed, other._chunkUsed);
+        }
+
+        size_t chunksCount() const { return _chunks.size(); }
+    };
+} // namespace sd
@@ -0,0 +1,558 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "EpochReclaimer.hpp"
+
+namespace sd
+{
+    /**
+     * Immutable node shared between map versions, only reference count changes after construction
+     */
+    template <class K, class T> class PersistentMapNode
+    {
+      public:
+        using Pair = std::pair<const K, T>;
+
+      private:
+        mutable std::atomic<size_t> _references{1};
+        const PersistentMapNode *_left;
+        const PersistentMapNode *_right;
+        int _height;
+        Pair _keyItem;
+
+      public:
+        // takes over references to children
+        template <class... Args>
+        PersistentMapNode(const PersistentMapNode *left, const PersistentMapNode *right, Args &&...args)
+            : _left(left), _right(right), _height(std::max(height(left), height(right)) + 1),
+              _keyItem(std::forward<Args>(args)...)
+        {
+        }
+
+        ~PersistentMapNode()
+        {
+            release(_left);
+            release(_right);
+        }
+
+        static int height(const PersistentMapNode *node) { return node ? node->_height : 0; }
+
+        static const PersistentMapNode *acquire(const PersistentMapNode *node)
+        {
+            if (node)
+            {
+                node->_references.fetch_add(1, std::memory_order_relaxed);
+            }
+            return node;
+        }
+
+        static void release(const PersistentMapNode *node)
+        {
+            if (node && node->_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete node;
+            }
+        }
+
+        const PersistentMapNode *getLeft() const { return _left; }
+
+        const PersistentMapNode *getRight() const { return _right; }
+
+        const K &getKey() const { return _keyItem.first; }
+
+        const T &getItem() const { return _keyItem.second; }
+
+        const Pair &getPair() const { return _keyItem; }
+    };
+
+    /**
+     * In order iterator, nodes have no parent links because they are shared by many versions,
+     * so path of ancestors still to visit is kept in iterator
+     */
+    template <class Node> class PersistentMapIterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename Node::Pair;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+
+      private:
+        std::vector<const Node *> _path;
+
+      public:
+        PersistentMapIterator() = default;
+        explicit PersistentMapIterator(std::vector<const Node *> path) : _path(std::move(path)) {}
+
+        operator bool() const { return !_path.empty(); }
+
+        bool operator==(const PersistentMapIterator &other) const { return current() == other.current(); }
+        bool operator!=(const PersistentMapIterator &other) const { return current() != other.current(); }
+
+        PersistentMapIterator &operator++()
+        {
+            auto node = _path.back();
+            _path.pop_back();
+            for (auto ptr = node->getRight(); ptr; ptr = ptr->getLeft())
+            {
+                _path.push_back(ptr);
+            }
+            return *this;
+        }
+
+        PersistentMapIterator operator++(int)
+        {
+            auto temp(*this);
+            ++*this;
+            return temp;
+        }
+
+        reference operator*() const { return _path.back()->getPair(); }
+
+        pointer operator->() const { return &_path.back()->getPair(); }
+
+      private:
+        const Node *current() const { return _path.empty() ? nullptr : _path.back(); }
+    };
+
+    /**
+     * Immutable ordered map, modifiers return new version and leave this one untouched. Versions share
+     * all subtrees except O(log n) nodes on modified path (AVL tree with path copying), so copying version
+     * is O(1) and keeping old versions costs only nodes they do not share. Reading one version from many
+     * threads is safe, use AtomicPersistentMap to publish new versions to concurrent readers
+     */
+    template <class K, class T, class Compare = std::less<K>> class PersistentMap
+    {
+      public:
+        using Node = PersistentMapNode<K, T>;
+        using Pair = typename Node::Pair;
+        using ConstIterator = PersistentMapIterator<Node>;
+
+      private:
+        const Node *_root = nullptr;
+        size_t _size = 0;
+        [[no_unique_address]] Compare _compare;
+
+      public:
+        // Constructors
+        PersistentMap() = default;
+
+        explicit PersistentMap(const Compare &compare) : _compare(compare) {}
+
+        template <class InputIt> PersistentMap(InputIt first, InputIt last)
+        {
+            for (; first != last; ++first)
+            {
+                *this = insert(*first);
+            }
+        }
+
+        PersistentMap(std::initializer_list<Pair> init) : PersistentMap(init.begin(), init.end()) {}
+
+        // shares whole tree
+        PersistentMap(const PersistentMap &other)
+            : _root(Node::acquire(other._root)), _size(other._size), _compare(other._compare)
+        {
+        }
+
+        PersistentMap(PersistentMap &&other)
+            : _root(std::exchange(other._root, nullptr)), _size(std::exchange(other._size, 0)),
+              _compare(other._compare)
+        {
+        }
+
+        ~PersistentMap() { Node::release(_root); }
+
+        // Assign
+        PersistentMap &operator=(const PersistentMap &other)
+        {
+            PersistentMap copy(other);
+            swap(copy);
+            return *this;
+        }
+
+        PersistentMap &operator=(PersistentMap &&other)
+        {
+            PersistentMap moved(std::move(other));
+            swap(moved);
+            return *this;
+        }
+
+        // Element access
+        const T &at(const K &key) const
+        {
+            auto node = findNode(key);
+            if (!node)
+            {
+                throw std::out_of_range("Item was not found");
+            }
+            return node->getItem();
+        }
+
+        const T &operator[](const K &key) const { return at(key); }
+
+        // Modifiers, each returns new version
+        /**
+         * Returns version with value added, when key is already present returned version shares this tree
+         */
+        [[nodiscard]] PersistentMap insert(const Pair &value) const
+        {
+            if (contains(value.first))
+            {
+                return *this;
+            }
+            return PersistentMap{insertNode(_root, value.first, value.second), _size + 1, _compare};
+        }
+
+        // returns version where key maps to item
+        [[nodiscard]] PersistentMap insertOrAssign(const K &key, const T &item) const
+        {
+            auto present = contains(key);
+            return PersistentMap{insertNode(_root, key, item), _size + !present, _compare};
+        }
+
+        /**
+         * Returns version without key, throws when key is not present
+         */
+        [[nodiscard]] PersistentMap remove(const K &key) const
+        {
+            if (!contains(key))
+            {
+                throw std::out_of_range("Item was not found");
+            }
+            return PersistentMap{removeNode(_root, key), _size - 1, _compare};
+        }
+
+        void swap(PersistentMap &other)
+        {
+            std::swap(_root, other._root);
+            std::swap(_size, other._size);
+            std::swap(_compare, other._compare);
+        }
+
+        // LookUp
+        ConstIterator find(const K &key) const
+        {
+            std::vector<const Node *> path;
+            for (auto node = _root; node;)
+            {
+                if (_compare(key, node->getKey()))
+                {
+                    path.push_back(node);
+                    node = node->getLeft();
+                }
+                else if (_compare(node->getKey(), key))
+                {
+                    node = node->getRight();
+                }
+                else
+                {
+                    path.push_back(node);
+                    return ConstIterator{std::move(path)};
+                }
+            }
+            return end();
+        }
+
+        bool contains(const K &key) const { return findNode(key); }
+
+        // first element not less than key
+        ConstIterator lowerBound(const K &key) const
+        {
+            std::vector<const Node *> path;
+            for (auto node = _root; node;)
+            {
+                if (_compare(node->getKey(), key))
+                {
+                    node = node->getRight();
+                }
+                else
+                {
+                    path.push_back(node);
+                    node = node->getLeft();
+                }
+            }
+            return ConstIterator{std::move(path)};
+        }
+
+        // Capacity
+        size_t size() const { return _size; }
+
+        bool empty() const { return _size == 0; }
+
+        // true when both versions are same tree, so they are equal without comparing elements
+        bool sharesTree(const PersistentMap &other) const { return _root == other._root; }
+
+        // Iterators
+        ConstIterator begin() const
+        {
+            std::vector<const Node *> path;
+            for (auto node = _root; node; node = node->getLeft())
+            {
+                path.push_back(node);
+            }
+            return ConstIterator{std::move(path)};
+        }
+
+        ConstIterator end() const { return ConstIterator{}; }
+
+        ConstIterator cBegin() const { return begin(); }
+
+        ConstIterator cEnd() const { return end(); }
+
+      private:
+        PersistentMap(const Node *root, size_t size, const Compare &compare)
+            : _root(root), _size(size), _compare(compare)
+        {
+        }
+
+        const Node *findNode(const K &key) const
+        {
+            auto node = _root;
+            while (node)
+            {
+                if (_compare(key, node->getKey()))
+                {
+                    node = node->getLeft();
+                }
+                else if (_compare(node->getKey(), key))
+                {
+                    node = node->getRight();
+                }
+                else
+                {
+                    break;
+                }
+            }
+            return node;
+        }
+
+        /**
+         * Path copying helpers, every returned node pointer carries one reference owned by caller
+         * and node pointers passed as children are consumed, also when helper throws
+         */
+        template <class... Args> static const Node *makeNode(const Node *left, const Node *right, Args &&...args)
+        {
+            try
+            {
+                return new Node(left, right, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                Node::release(left);
+                Node::release(right);
+                throw;
+            }
+        }
+
+        // makes node with pair copied from source, rotating when children heights differ by two
+        static const Node *balance(const Node *left, const Node &source, const Node *right)
+        {
+            auto leftHeight = Node::height(left), rightHeight = Node::height(right);
+            if (leftHeight > rightHeight + 1)
+            {
+                return replace(left, [&] { return rotateRight(left, source, right); });
+            }
+            if (rightHeight > leftHeight + 1)
+            {
+                return replace(right, [&] { return rotateLeft(left, source, right); });
+            }
+            return makeNode(left, right, source.getPair());
+        }
+
+        // old node is released once rebuilt subtree is made from its parts, or when making it fails
+        template <class Rebuild> static const Node *replace(const Node *old, Rebuild rebuild)
+        {
+            try
+            {
+                auto rebuilt = rebuild();
+                Node::release(old);
+                return rebuilt;
+            }
+            catch (...)
+            {
+                Node::release(old);
+                throw;
+            }
+        }
+
+        // node owned by caller is released when make throws, otherwise it stays owned
+        template <class Make> static const Node *releaseOnThrow(const Node *owned, Make make)
+        {
+            try
+            {
+                return make();
+            }
+            catch (...)
+            {
+                Node::release(owned);
+                throw;
+            }
+        }
+
+        // left is too high, it is released by caller
+        static const Node *rotateRight(const Node *left, const Node &source, const Node *right)
+        {
+            auto outer = left->getLeft(), inner = left->getRight();
+            if (Node::height(outer) >= Node::height(inner))
+            {
+                auto newRight = makeNode(Node::acquire(inner), right, source.getPair());
+                return makeNode(Node::acquire(outer), newRight, left->getPair());
+            }
+            auto newLeft = releaseOnThrow(right, [&] {
+                return makeNode(Node::acquire(outer), Node::acquire(inner->getLeft()), left->getPair());
+            });
+            auto newRight = releaseOnThrow(
+                newLeft, [&] { return makeNode(Node::acquire(inner->getRight()), right, source.getPair()); });
+            return makeNode(newLeft, newRight, inner->getPair());
+        }
+
+        // right is too high, it is released by caller
+        static const Node *rotateLeft(const Node *left, const Node &source, const Node *right)
+        {
+            auto outer = right->getRight(), inner = right->getLeft();
+            if (Node::height(outer) >= Node::height(inner))
+            {
+                auto newLeft = makeNode(left, Node::acquire(inner), source.getPair());
+                return makeNode(newLeft, Node::acquire(outer), right->getPair());
+            }
+            auto newLeft = makeNode(left, Node::acquire(inner->getLeft()), source.getPair());
+            auto newRight = releaseOnThrow(newLeft, [&] {
+                return makeNode(Node::acquire(inner->getRight()), Node::acquire(outer), right->getPair());
+            });
+            return makeNode(newLeft, newRight, inner->getPair());
+        }
+
+        // copies path to key, node with same key is replaced
+        const Node *insertNode(const Node *node, const K &key, const T &item) const
+        {
+            if (!node)
+            {
+                return makeNode(nullptr, nullptr, key, item);
+            }
+            if (_compare(key, node->getKey()))
+            {
+                auto left = insertNode(node->getLeft(), key, item);
+                return balance(left, *node, Node::acquire(node->getRight()));
+            }
+            if (_compare(node->getKey(), key))
+            {
+                auto right = insertNode(node->getRight(), key, item);
+                return balance(Node::acquire(node->getLeft()), *node, right);
+            }
+            return makeNode(Node::acquire(node->getLeft()), Node::acquire(node->getRight()), key, item);
+        }
+
+        // copies path to key, which has to be present
+        const Node *removeNode(const Node *node, const K &key) const
+        {
+            if (_compare(key, node->getKey()))
+            {
+                auto left = removeNode(node->getLeft(), key);
+                return balance(left, *node, Node::acquire(node->getRight()));
+            }
+            if (_compare(node->getKey(), key))
+            {
+                auto right = removeNode(node->getRight(), key);
+                return balance(Node::acquire(node->getLeft()), *node, right);
+            }
+            if (!node->getLeft())
+            {
+                return Node::acquire(node->getRight());
+            }
+            if (!node->getRight())
+            {
+                return Node::acquire(node->getLeft());
+            }
+            // successor takes place of removed node
+            auto successor = node->getRight();
+            while (successor->getLeft())
+            {
+                successor = successor->getLeft();
+            }
+            auto right = removeMinimum(node->getRight());
+            return balance(Node::acquire(node->getLeft()), *successor, right);
+        }
+
+        static const Node *removeMinimum(const Node *node)
+        {
+            if (!node->getLeft())
+            {
+                return Node::acquire(node->getRight());
+            }
+            auto left = removeMinimum(node->getLeft());
+            return balance(left, *node, Node::acquire(node->getRight()));
+        }
+    };
+
+    template <class K, class T, class C>
+    bool operator==(const PersistentMap<K, T, C> &lhs, const PersistentMap<K, T, C> &rhs)
+    {
+        return lhs.sharesTree(rhs) ||
+               (lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()));
+    }
+
+    template <class K, class T, class C>
+    bool operator!=(const PersistentMap<K, T, C> &lhs, const PersistentMap<K, T, C> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    /**
+     * Publishes PersistentMap versions to concurrent readers. Readers never lock, they pin reclaimer epoch
+     * only for time needed to take reference to current version. Writers replace whole version, so
+     * concurrent writers have to be serialized by caller. Replaced versions are freed by epoch reclaimer
+     * in batches, so few of them can outlive their last reader for a while
+     */
+    template <class K, class T, class Compare = std::less<K>> class AtomicPersistentMap
+    {
+      public:
+        using Version = PersistentMap<K, T, Compare>;
+
+      private:
+        mutable EpochReclaimer _reclaimer;
+        std::atomic<const Version *> _current;
+
+      public:
+        AtomicPersistentMap() : _current(new Version{}) {}
+
+        explicit AtomicPersistentMap(Version version) : _current(new Version{std::move(version)}) {}
+
+        AtomicPersistentMap(const AtomicPersistentMap &) = delete;
+        AtomicPersistentMap &operator=(const AtomicPersistentMap &) = delete;
+
+        ~AtomicPersistentMap() { delete _current.load(); }
+
+        // snapshot of current version, it stays valid and unchanged however long it is kept
+        Version load() const
+        {
+            EpochGuard guard(_reclaimer);
+            return *_current.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Calls reader with current version without taking reference to it, cheaper than load for short reads,
+         * version must not escape reader
+         */
+        template <class Reader> decltype(auto) read(Reader reader) const
+        {
+            EpochGuard guard(_reclaimer);
+            return reader(*_current.load(std::memory_order_acquire));
+        }
+
+        void store(Version version)
+        {
+            auto previous = _current.exchange(new Version{std::move(version)}, std::memory_order_acq_rel);
+            _reclaimer.retire(const_cast<Version *>(previous), [](void *ptr) { delete static_cast<Version *>(ptr); });
+        }
+    };
+} // namespace sd
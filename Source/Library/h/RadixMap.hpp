@@ -0,0 +1,1200 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sd
+{
+    /**
+     * Turns key into sequence of bytes, order of byte sequences compared as unsigned bytes has to match order of keys
+     */
+    template <class K> struct RadixKeyTraits;
+
+    // big endian with flipped sign bit, so negative numbers come before positive ones
+    template <std::integral K> struct RadixKeyTraits<K>
+    {
+        using Bytes = std::array<unsigned char, sizeof(K)>;
+
+        static Bytes encode(K key)
+        {
+            using Unsigned = std::make_unsigned_t<K>;
+            auto value = Unsigned(key);
+            if constexpr (std::is_signed_v<K>)
+            {
+                value ^= Unsigned(Unsigned(1) << (sizeof(K) * 8 - 1));
+            }
+            Bytes bytes;
+            for (size_t i = sizeof(K); i-- > 0;)
+            {
+                bytes[i] = static_cast<unsigned char>(value);
+                value = Unsigned(value >> 8);
+            }
+            return bytes;
+        }
+    };
+
+    template <> struct RadixKeyTraits<std::string>
+    {
+        using Bytes = std::string_view;
+
+        static Bytes encode(const std::string &key) { return key; }
+    };
+
+    enum class RadixNodeType : unsigned char
+    {
+        Leaf,
+        Node4,
+        Node16,
+        Node48,
+        Node256
+    };
+
+    struct RadixNode
+    {
+        RadixNodeType type;
+
+        explicit RadixNode(RadixNodeType nodeType) : type(nodeType) {}
+    };
+
+    /**
+     * Common part of inner nodes. Only first MaxPrefix bytes of compressed path are stored, rest of longer prefix
+     * is read from key of any leaf below node when needed
+     */
+    struct RadixInner : RadixNode
+    {
+        static constexpr size_t MaxPrefix = 8;
+
+        unsigned short count = 0;
+        unsigned prefixLength = 0;
+        unsigned char prefix[MaxPrefix] = {};
+        // leaf with key ending right after prefix, its key is prefix of all other keys below node
+        RadixNode *terminal = nullptr;
+
+        explicit RadixInner(RadixNodeType nodeType) : RadixNode(nodeType) {}
+
+        // takes prefix and terminal of node being replaced by bigger or smaller one
+        RadixInner(RadixNodeType nodeType, const RadixInner &other)
+            : RadixNode(nodeType), prefixLength(other.prefixLength), terminal(other.terminal)
+        {
+            std::copy_n(other.prefix, MaxPrefix, prefix);
+        }
+    };
+
+    /**
+     * Inner node with up to Capacity children kept sorted by key byte, Node4 and Node16
+     */
+    template <size_t Capacity> struct RadixSortedNode : RadixInner
+    {
+        static_assert(Capacity == 4 || Capacity == 16, "Sorted node holds 4 or 16 children");
+
+        static constexpr RadixNodeType Type = Capacity == 4 ? RadixNodeType::Node4 : RadixNodeType::Node16;
+
+        unsigned char keys[Capacity] = {};
+        RadixNode *children[Capacity] = {};
+
+        RadixSortedNode() : RadixInner(Type) {}
+
+        template <class Other> explicit RadixSortedNode(const Other &other) : RadixInner(Type, other)
+        {
+            other.forEach([this](unsigned char byte, RadixNode *child) { add(byte, child); });
+        }
+
+        RadixNode **find(unsigned char byte)
+        {
+#if defined(__SSE2__)
+            if constexpr (Capacity == 16)
+            {
+                // compares all 16 keys at once, bits of unused slots are masked out
+                auto matches = _mm_cmpeq_epi8(_mm_set1_epi8(char(byte)),
+                                              _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys)));
+                auto mask = unsigned(_mm_movemask_epi8(matches)) & ((1u << count) - 1);
+                return mask ? &children[std::countr_zero(mask)] : nullptr;
+            }
+#endif
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (keys[i] == byte)
+                {
+                    return &children[i];
+                }
+            }
+            return nullptr;
+        }
+
+        bool isFull() const { return count == Capacity; }
+
+        bool isSparse() const { return Capacity == 16 && count <= 3; }
+
+        void add(unsigned char byte, RadixNode *child)
+        {
+            auto index = size_t(std::lower_bound(keys, keys + count, byte) - keys);
+            std::copy_backward(keys + index, keys + count, keys + count + 1);
+            std::copy_backward(children + index, children + count, children + count + 1);
+            keys[index] = byte;
+            children[index] = child;
+            ++count;
+        }
+
+        void remove(unsigned char byte)
+        {
+            auto index = size_t(std::find(keys, keys + count, byte) - keys);
+            std::copy(keys + index + 1, keys + count, keys + index);
+            std::copy(children + index + 1, children + count, children + index);
+            --count;
+        }
+
+        RadixNode *first() const { return children[0]; }
+
+        RadixNode *last() const { return children[count - 1]; }
+
+        // child with biggest key byte smaller than byte
+        RadixNode *before(unsigned char byte) const
+        {
+            for (size_t i = count; i-- > 0;)
+            {
+                if (keys[i] < byte)
+                {
+                    return children[i];
+                }
+            }
+            return nullptr;
+        }
+
+        // child with smallest key byte bigger than byte
+        RadixNode *after(unsigned char byte) const
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (keys[i] > byte)
+                {
+                    return children[i];
+                }
+            }
+            return nullptr;
+        }
+
+        template <class Function> void forEach(Function function) const
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                function(keys[i], children[i]);
+            }
+        }
+    };
+
+    using RadixNode4 = RadixSortedNode<4>;
+    using RadixNode16 = RadixSortedNode<16>;
+
+    /**
+     * Inner node with up to 48 children, key byte indexes slot of child directly
+     */
+    struct RadixNode48 : RadixInner
+    {
+        // slot of child plus one for every key byte, zero when byte has no child
+        unsigned char index[256] = {};
+        RadixNode *children[48] = {};
+
+        RadixNode48() : RadixInner(RadixNodeType::Node48) {}
+
+        template <class Other> explicit RadixNode48(const Other &other) : RadixInner(RadixNodeType::Node48, other)
+        {
+            other.forEach([this](unsigned char byte, RadixNode *child) { add(byte, child); });
+        }
+
+        RadixNode **find(unsigned char byte) { return index[byte] ? &children[index[byte] - 1] : nullptr; }
+
+        bool isFull() const { return count == 48; }
+
+        bool isSparse() const { return count <= 12; }
+
+        void add(unsigned char byte, RadixNode *child)
+        {
+            size_t slot = 0;
+            while (children[slot])
+            {
+                ++slot;
+            }
+            children[slot] = child;
+            index[byte] = static_cast<unsigned char>(slot + 1);
+            ++count;
+        }
+
+        void remove(unsigned char byte)
+        {
+            children[index[byte] - 1] = nullptr;
+            index[byte] = 0;
+            --count;
+        }
+
+        RadixNode *first() const { return index[0] ? children[index[0] - 1] : after(0); }
+
+        RadixNode *last() const { return index[255] ? children[index[255] - 1] : before(255); }
+
+        RadixNode *before(unsigned char byte) const
+        {
+            for (size_t key = byte; key-- > 0;)
+            {
+                if (index[key])
+                {
+                    return children[index[key] - 1];
+                }
+            }
+            return nullptr;
+        }
+
+        RadixNode *after(unsigned char byte) const
+        {
+            for (size_t key = size_t(byte) + 1; key < 256; ++key)
+            {
+                if (index[key])
+                {
+                    return children[index[key] - 1];
+                }
+            }
+            return nullptr;
+        }
+
+        template <class Function> void forEach(Function function) const
+        {
+            for (size_t key = 0; key < 256; ++key)
+            {
+                if (index[key])
+                {
+                    function(static_cast<unsigned char>(key), children[index[key] - 1]);
+                }
+            }
+        }
+    };
+
+    /**
+     * Inner node with child pointer for every possible key byte
+     */
+    struct RadixNode256 : RadixInner
+    {
+        RadixNode *children[256] = {};
+
+        RadixNode256() : RadixInner(RadixNodeType::Node256) {}
+
+        template <class Other> explicit RadixNode256(const Other &other) : RadixInner(RadixNodeType::Node256, other)
+        {
+            other.forEach([this](unsigned char byte, RadixNode *child) { add(byte, child); });
+        }
+
+        RadixNode **find(unsigned char byte) { return children[byte] ? &children[byte] : nullptr; }
+
+        bool isFull() const { return false; }
+
+        bool isSparse() const { return count <= 37; }
+
+        void add(unsigned char byte, RadixNode *child)
+        {
+            children[byte] = child;
+            ++count;
+        }
+
+        void remove(unsigned char byte)
+        {
+            children[byte] = nullptr;
+            --count;
+        }
+
+        RadixNode *first() const { return children[0] ? children[0] : after(0); }
+
+        RadixNode *last() const { return children[255] ? children[255] : before(255); }
+
+        RadixNode *before(unsigned char byte) const
+        {
+            for (size_t key = byte; key-- > 0;)
+            {
+                if (children[key])
+                {
+                    return children[key];
+                }
+            }
+            return nullptr;
+        }
+
+        RadixNode *after(unsigned char byte) const
+        {
+            for (size_t key = size_t(byte) + 1; key < 256; ++key)
+            {
+                if (children[key])
+                {
+                    return children[key];
+                }
+            }
+            return nullptr;
+        }
+
+        template <class Function> void forEach(Function function) const
+        {
+            for (size_t key = 0; key < 256; ++key)
+            {
+                if (children[key])
+                {
+                    function(static_cast<unsigned char>(key), children[key]);
+                }
+            }
+        }
+    };
+
+    template <class K, class T> struct RadixLeaf : RadixNode
+    {
+        using Pair = std::pair<const K, T>;
+
+        Pair keyItem;
+        // leafs are linked in key order, iteration does not walk tree
+        RadixLeaf *prev = nullptr;
+        RadixLeaf *next = nullptr;
+
+        template <class... Args>
+        explicit RadixLeaf(Args &&...args) : RadixNode(RadixNodeType::Leaf), keyItem(std::forward<Args>(args)...)
+        {
+        }
+
+        Pair &getPair() { return keyItem; }
+
+        const Pair &getPair() const { return keyItem; }
+    };
+
+    template <class Leaf, bool C, bool R> // C= const, R = Reverse
+    class RadixMapIterator
+    {
+      public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename Leaf::Pair;
+        using difference_type = std::ptrdiff_t;
+        using LeafPtr = std::conditional_t<C, const Leaf *, Leaf *>;
+        using Pair = std::conditional_t<C, const typename Leaf::Pair, typename Leaf::Pair>;
+        using PairRef = Pair &;
+        using PairPtr = Pair *;
+
+      protected:
+        LeafPtr _leaf = nullptr;
+
+      public:
+        RadixMapIterator(LeafPtr leaf = nullptr) : _leaf(leaf) {}
+        RadixMapIterator(const RadixMapIterator &rawIterator) = default;
+        ~RadixMapIterator() = default;
+
+        RadixMapIterator &operator=(const RadixMapIterator &rawIterator) = default;
+
+        operator bool() const { return _leaf; }
+
+        bool operator==(const RadixMapIterator &rawIterator) const { return _leaf == rawIterator._leaf; }
+        bool operator!=(const RadixMapIterator &rawIterator) const { return !(*this == rawIterator); }
+
+        RadixMapIterator &operator++()
+        {
+            _leaf = R ? _leaf->prev : _leaf->next;
+            return *this;
+        }
+
+        RadixMapIterator &operator--()
+        {
+            _leaf = R ? _leaf->next : _leaf->prev;
+            return *this;
+        }
+
+        RadixMapIterator operator++(int)
+        {
+            auto temp(*this);
+            ++*this;
+            return temp;
+        }
+
+        RadixMapIterator operator--(int)
+        {
+            auto temp(*this);
+            --*this;
+            return temp;
+        }
+
+        PairRef operator*() const { return _leaf->getPair(); }
+
+        PairPtr operator->() const { return &_leaf->getPair(); }
+    };
+
+    /**
+     * Half open range of radix map iterators, usable in range based for loop
+     */
+    template <class Iterator> class RadixMapRange
+    {
+      private:
+        Iterator _begin;
+        Iterator _end;
+
+      public:
+        RadixMapRange(Iterator begin, Iterator end) : _begin(begin), _end(end) {}
+
+        Iterator begin() const { return _begin; }
+        Iterator end() const { return _end; }
+
+        bool empty() const { return _begin == _end; }
+    };
+
+    /**
+     * Ordered map stored as adaptive radix tree. KeyTraits turn keys into byte strings and tree branches on one byte
+     * per level, so lookup costs O(key length) byte steps instead of O(log n) key comparisons. Inner nodes grow
+     * from 4 to 16, 48 and 256 children as needed, chains of single child nodes are compressed into prefixes and
+     * leafs are linked in key order
+     */
+    template <class K, class T, class KeyTraits = RadixKeyTraits<K>> class RadixMap
+    {
+      private:
+        using Leaf = RadixLeaf<K, T>;
+        using Bytes = typename KeyTraits::Bytes;
+        using Pair = std::pair<const K, T>;
+
+        static constexpr size_t MaxPrefix = RadixInner::MaxPrefix;
+
+        RadixNode *_root = nullptr;
+        Leaf *_first = nullptr;
+        Leaf *_last = nullptr;
+        size_t _size = 0;
+
+      public:
+        using Iterator = RadixMapIterator<Leaf, false, false>;
+        using ConstIterator = RadixMapIterator<Leaf, true, false>;
+
+        using ReverseIterator = RadixMapIterator<Leaf, false, true>;
+        using ConstReverseIterator = RadixMapIterator<Leaf, true, true>;
+
+        // Constructors
+        RadixMap() = default;
+
+        template <class InputIt> RadixMap(InputIt first, InputIt last) { insert(first, last); }
+
+        RadixMap(const RadixMap &other) { insert(other.begin(), other.end()); }
+
+        RadixMap(RadixMap &&other) { swap(other); }
+
+        RadixMap(std::initializer_list<Pair> init) { insert(init); }
+
+        ~RadixMap() { clear(); }
+
+        // Assign
+        RadixMap &operator=(const RadixMap &other)
+        {
+            if (this != &other)
+            {
+                clear();
+                insert(other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        RadixMap &operator=(RadixMap &&other)
+        {
+            if (this != &other)
+            {
+                clear();
+                swap(other);
+            }
+            return *this;
+        }
+
+        RadixMap &operator=(std::initializer_list<Pair> ilist)
+        {
+            clear();
+            insert(ilist);
+            return *this;
+        }
+
+        // Element access
+        T &at(const K &key)
+        {
+            auto leaf = findLeaf(KeyTraits::encode(key));
+            assertLeaf(leaf);
+            return leaf->getPair().second;
+        }
+
+        const T &at(const K &key) const
+        {
+            auto leaf = findLeaf(KeyTraits::encode(key));
+            assertLeaf(leaf);
+            return leaf->getPair().second;
+        }
+
+        T &operator[](const K &key) { return at(key); }
+
+        const T &operator[](const K &key) const { return at(key); }
+
+        // Modifiers
+        std::pair<Iterator, bool> insert(const Pair &value) { return insertValue(value); }
+        std::pair<Iterator, bool> insert(Pair &&value) { return insertValue(std::move(value)); }
+
+        template <class InputIt> void insert(InputIt first, InputIt last)
+        {
+            for (auto it = first; it != last; ++it)
+            {
+                insertValue(*it);
+            }
+        }
+
+        void insert(const std::initializer_list<Pair> &ilist) { insert(ilist.begin(), ilist.end()); }
+
+        void remove(const K &key) { removeKey(KeyTraits::encode(key)); }
+
+        void swap(RadixMap &other)
+        {
+            std::swap(_root, other._root);
+            std::swap(_first, other._first);
+            std::swap(_last, other._last);
+            std::swap(_size, other._size);
+        }
+
+        void clear()
+        {
+            if (_root)
+            {
+                deleteSubtree(_root);
+            }
+            _root = nullptr;
+            _first = nullptr;
+            _last = nullptr;
+            _size = 0;
+        }
+
+        // LookUp
+        Iterator find(const K &key) { return Iterator{findLeaf(KeyTraits::encode(key))}; }
+
+        ConstIterator find(const K &key) const { return ConstIterator{findLeaf(KeyTraits::encode(key))}; }
+
+        bool contains(const K &key) const { return findLeaf(KeyTraits::encode(key)); }
+
+        Iterator lowerBound(const K &key) { return Iterator{lowerBoundLeaf(KeyTraits::encode(key))}; }
+
+        ConstIterator lowerBound(const K &key) const
+        {
+            return ConstIterator{lowerBoundLeaf(KeyTraits::encode(key))};
+        }
+
+        Iterator upperBound(const K &key)
+        {
+            auto it = lowerBound(key);
+            return it && it->first == key ? ++it : it;
+        }
+
+        ConstIterator upperBound(const K &key) const
+        {
+            auto it = lowerBound(key);
+            return it && it->first == key ? ++it : it;
+        }
+
+        /**
+         * All items with key starting with bytes of prefix, in key order. Found by walking prefix only once,
+         * whole matching subtree is then contiguous run of leafs
+         */
+        RadixMapRange<Iterator> prefixRange(const K &prefix)
+        {
+            auto [first, last] = prefixLeafs(KeyTraits::encode(prefix));
+            return {Iterator{first}, Iterator{last}};
+        }
+
+        RadixMapRange<ConstIterator> prefixRange(const K &prefix) const
+        {
+            auto [first, last] = prefixLeafs(KeyTraits::encode(prefix));
+            return {ConstIterator{first}, ConstIterator{last}};
+        }
+
+        // Capacity
+        size_t size() const { return _size; }
+
+        bool empty() const { return size() == 0; }
+
+        // Iterators
+        Iterator begin() { return Iterator{_first}; }
+        Iterator end() { return Iterator{}; }
+
+        ConstIterator begin() const { return ConstIterator{_first}; }
+        ConstIterator end() const { return ConstIterator{}; }
+
+        ConstIterator cBegin() const { return ConstIterator{_first}; }
+        ConstIterator cEnd() const { return ConstIterator{}; }
+
+        ReverseIterator rBegin() { return ReverseIterator{_last}; }
+        ReverseIterator rEnd() { return ReverseIterator{}; }
+
+        ConstReverseIterator rBegin() const { return ConstReverseIterator{_last}; }
+        ConstReverseIterator rEnd() const { return ConstReverseIterator{}; }
+
+        ConstReverseIterator crBegin() const { return rBegin(); }
+        ConstReverseIterator crEnd() const { return ConstReverseIterator{}; }
+
+      private:
+        static bool isLeaf(const RadixNode *node) { return node->type == RadixNodeType::Leaf; }
+
+        static Leaf *asLeaf(RadixNode *node) { return static_cast<Leaf *>(node); }
+
+        static RadixInner *asInner(RadixNode *node) { return static_cast<RadixInner *>(node); }
+
+        static Bytes keyBytes(const Leaf *leaf) { return KeyTraits::encode(leaf->keyItem.first); }
+
+        static unsigned char byteAt(const Bytes &bytes, size_t index)
+        {
+            return static_cast<unsigned char>(bytes[index]);
+        }
+
+        // compares as unsigned bytes, shorter sequence goes first when it is prefix of longer one
+        static std::strong_ordering compareBytes(const Bytes &lhs, const Bytes &rhs)
+        {
+            auto common = std::min(lhs.size(), rhs.size());
+            for (size_t i = 0; i < common; ++i)
+            {
+                if (auto order = byteAt(lhs, i) <=> byteAt(rhs, i); order != 0)
+                {
+                    return order;
+                }
+            }
+            return lhs.size() <=> rhs.size();
+        }
+
+        template <class Function> static decltype(auto) visitInner(RadixNode *node, Function &&function)
+        {
+            switch (node->type)
+            {
+            case RadixNodeType::Node4:
+                return function(static_cast<RadixNode4 *>(node));
+            case RadixNodeType::Node16:
+                return function(static_cast<RadixNode16 *>(node));
+            case RadixNodeType::Node48:
+                return function(static_cast<RadixNode48 *>(node));
+            default:
+                return function(static_cast<RadixNode256 *>(node));
+            }
+        }
+
+        static RadixNode **findChild(RadixNode *node, unsigned char byte)
+        {
+            return visitInner(node, [byte](auto node) { return node->find(byte); });
+        }
+
+        // every inner node has at least one child, node with single child has also terminal
+        static Leaf *minLeaf(RadixNode *node)
+        {
+            while (!isLeaf(node))
+            {
+                if (auto terminal = asInner(node)->terminal)
+                {
+                    return asLeaf(terminal);
+                }
+                node = visitInner(node, [](auto node) { return node->first(); });
+            }
+            return asLeaf(node);
+        }
+
+        static Leaf *maxLeaf(RadixNode *node)
+        {
+            while (!isLeaf(node))
+            {
+                node = visitInner(node, [](auto node) { return node->last(); });
+            }
+            return asLeaf(node);
+        }
+
+        // number of prefix bytes of inner matching bytes from depth on, stops early at end of bytes
+        static size_t prefixMismatch(RadixInner *inner, const Bytes &bytes, size_t depth)
+        {
+            auto length = std::min<size_t>(inner->prefixLength, bytes.size() - depth);
+            auto stored = std::min(length, MaxPrefix);
+            size_t matched = 0;
+            for (; matched < stored; ++matched)
+            {
+                if (inner->prefix[matched] != byteAt(bytes, depth + matched))
+                {
+                    return matched;
+                }
+            }
+            if (matched < length)
+            {
+                auto leafBytes = keyBytes(minLeaf(inner));
+                for (; matched < length; ++matched)
+                {
+                    if (byteAt(leafBytes, depth + matched) != byteAt(bytes, depth + matched))
+                    {
+                        return matched;
+                    }
+                }
+            }
+            return matched;
+        }
+
+        static unsigned char prefixByte(RadixInner *inner, size_t depth, size_t index)
+        {
+            return index < MaxPrefix ? inner->prefix[index] : byteAt(keyBytes(minLeaf(inner)), depth + index);
+        }
+
+        static void setPrefix(RadixInner *inner, const Bytes &bytes, size_t from, size_t length)
+        {
+            inner->prefixLength = unsigned(length);
+            for (size_t i = 0; i < std::min(length, MaxPrefix); ++i)
+            {
+                inner->prefix[i] = byteAt(bytes, from + i);
+            }
+        }
+
+        // drops first count bytes of prefix, inner starts at depth
+        static void shortenPrefix(RadixInner *inner, size_t depth, size_t count)
+        {
+            if (inner->prefixLength <= MaxPrefix)
+            {
+                std::copy(inner->prefix + count, inner->prefix + inner->prefixLength, inner->prefix);
+                inner->prefixLength -= unsigned(count);
+                return;
+            }
+            auto leafBytes = keyBytes(minLeaf(inner));
+            setPrefix(inner, leafBytes, depth + count, inner->prefixLength - count);
+        }
+
+        // puts leaf under inner which branches at position of its key
+        static void attach(RadixNode4 *inner, Leaf *leaf, const Bytes &bytes, size_t position)
+        {
+            if (position == bytes.size())
+            {
+                inner->terminal = leaf;
+            }
+            else
+            {
+                inner->add(byteAt(bytes, position), leaf);
+            }
+        }
+
+        Leaf *findLeaf(const Bytes &bytes) const
+        {
+            auto node = _root;
+            size_t depth = 0;
+            while (node && !isLeaf(node))
+            {
+                // prefix bytes past MaxPrefix are skipped, key of reached leaf is compared as whole anyway
+                auto inner = asInner(node);
+                if (depth + inner->prefixLength > bytes.size())
+                {
+                    return nullptr;
+                }
+                for (size_t i = 0; i < std::min<size_t>(inner->prefixLength, MaxPrefix); ++i)
+                {
+                    if (inner->prefix[i] != byteAt(bytes, depth + i))
+                    {
+                        return nullptr;
+                    }
+                }
+                depth += inner->prefixLength;
+                if (depth == bytes.size())
+                {
+                    node = inner->terminal;
+                    break;
+                }
+                auto child = findChild(inner, byteAt(bytes, depth++));
+                node = child ? *child : nullptr;
+            }
+            return node && compareBytes(keyBytes(asLeaf(node)), bytes) == 0 ? asLeaf(node) : nullptr;
+        }
+
+        Leaf *lowerBoundLeaf(const Bytes &bytes) const
+        {
+            auto node = _root;
+            size_t depth = 0;
+            while (node)
+            {
+                if (isLeaf(node))
+                {
+                    auto leaf = asLeaf(node);
+                    return compareBytes(keyBytes(leaf), bytes) >= 0 ? leaf : leaf->next;
+                }
+                auto inner = asInner(node);
+                auto matched = prefixMismatch(inner, bytes, depth);
+                if (matched < inner->prefixLength)
+                {
+                    // whole subtree is either bigger or smaller than key
+                    auto bigger = depth + matched == bytes.size() ||
+                                  byteAt(bytes, depth + matched) < prefixByte(inner, depth, matched);
+                    return bigger ? minLeaf(inner) : maxLeaf(inner)->next;
+                }
+                depth += inner->prefixLength;
+                if (depth == bytes.size())
+                {
+                    return minLeaf(inner);
+                }
+                auto byte = byteAt(bytes, depth++);
+                if (auto child = findChild(inner, byte))
+                {
+                    node = *child;
+                    continue;
+                }
+                auto after = visitInner(inner, [byte](auto node) { return node->after(byte); });
+                return after ? minLeaf(after) : maxLeaf(inner)->next;
+            }
+            return nullptr;
+        }
+
+        std::pair<Leaf *, Leaf *> prefixLeafs(const Bytes &bytes) const
+        {
+            auto node = _root;
+            size_t depth = 0;
+            while (node)
+            {
+                if (isLeaf(node))
+                {
+                    auto leaf = asLeaf(node);
+                    auto leafBytes = keyBytes(leaf);
+                    if (leafBytes.size() >= bytes.size() &&
+                        std::equal(bytes.begin(), bytes.end(), leafBytes.begin()))
+                    {
+                        return {leaf, leaf->next};
+                    }
+                    break;
+                }
+                auto inner = asInner(node);
+                auto matched = prefixMismatch(inner, bytes, depth);
+                if (depth + matched == bytes.size())
+                {
+                    return {minLeaf(inner), maxLeaf(inner)->next};
+                }
+                if (matched < inner->prefixLength)
+                {
+                    break;
+                }
+                depth += inner->prefixLength;
+                auto child = findChild(inner, byteAt(bytes, depth++));
+                node = child ? *child : nullptr;
+            }
+            return {nullptr, nullptr};
+        }
+
+        template <class Arg> std::pair<Iterator, bool> insertValue(Arg &&value)
+        {
+            auto bytes = KeyTraits::encode(value.first);
+            // slot holding current node, so it can be replaced by bigger or split node
+            RadixNode **ref = &_root;
+            // subtree with closest keys smaller than current one, its biggest leaf is predecessor of new leaf
+            RadixNode *before = nullptr;
+            size_t depth = 0;
+            while (*ref)
+            {
+                if (isLeaf(*ref))
+                {
+                    return splitLeaf(ref, depth, before, bytes, std::forward<Arg>(value));
+                }
+                auto inner = asInner(*ref);
+                auto matched = prefixMismatch(inner, bytes, depth);
+                if (matched < inner->prefixLength)
+                {
+                    return splitPrefix(ref, depth, matched, before, std::forward<Arg>(value));
+                }
+                depth += inner->prefixLength;
+                if (depth == bytes.size())
+                {
+                    if (inner->terminal)
+                    {
+                        return {Iterator{asLeaf(inner->terminal)}, false};
+                    }
+                    auto added = new Leaf(std::forward<Arg>(value));
+                    inner->terminal = added;
+                    linkLeaf(added, before);
+                    return {Iterator{added}, true};
+                }
+                auto byte = byteAt(bytes, depth);
+                if (auto smaller = visitInner(inner, [byte](auto node) { return node->before(byte); }))
+                {
+                    before = smaller;
+                }
+                else if (inner->terminal)
+                {
+                    before = inner->terminal;
+                }
+                auto child = findChild(inner, byte);
+                if (!child)
+                {
+                    if (visitInner(inner, [](auto node) { return node->isFull(); }))
+                    {
+                        *ref = grow(inner);
+                    }
+                    auto added = new Leaf(std::forward<Arg>(value));
+                    visitInner(*ref, [&](auto node) { node->add(byte, added); });
+                    linkLeaf(added, before);
+                    return {Iterator{added}, true};
+                }
+                ref = child;
+                ++depth;
+            }
+            auto added = new Leaf(std::forward<Arg>(value));
+            *ref = added;
+            linkLeaf(added, before);
+            return {Iterator{added}, true};
+        }
+
+        // replaces leaf in slot by Node4 holding both leaf and new one, keys share bytes up to depth
+        template <class Arg>
+        std::pair<Iterator, bool> splitLeaf(RadixNode **ref, size_t depth, RadixNode *before, const Bytes &bytes,
+                                            Arg &&value)
+        {
+            auto leaf = asLeaf(*ref);
+            auto leafBytes = keyBytes(leaf);
+            auto order = compareBytes(bytes, leafBytes);
+            if (order == 0)
+            {
+                return {Iterator{leaf}, false};
+            }
+            std::unique_ptr<RadixNode4> inner(new RadixNode4);
+            auto added = new Leaf(std::forward<Arg>(value));
+            // value could have been moved from, key of new leaf is used from now on
+            auto addedBytes = keyBytes(added);
+            auto common = depth;
+            while (common < addedBytes.size() && common < leafBytes.size() &&
+                   byteAt(addedBytes, common) == byteAt(leafBytes, common))
+            {
+                ++common;
+            }
+            setPrefix(inner.get(), leafBytes, depth, common - depth);
+            attach(inner.get(), leaf, leafBytes, common);
+            attach(inner.get(), added, addedBytes, common);
+            *ref = inner.release();
+            linkLeaf(added, order < 0 ? before : leaf);
+            return {Iterator{added}, true};
+        }
+
+        // key differs from prefix of inner node in slot at matched byte, new Node4 takes common part of prefix
+        template <class Arg>
+        std::pair<Iterator, bool> splitPrefix(RadixNode **ref, size_t depth, size_t matched, RadixNode *before,
+                                              Arg &&value)
+        {
+            auto inner = asInner(*ref);
+            std::unique_ptr<RadixNode4> parent(new RadixNode4);
+            auto added = new Leaf(std::forward<Arg>(value));
+            auto addedBytes = keyBytes(added);
+            auto position = depth + matched;
+            auto innerByte = prefixByte(inner, depth, matched);
+            parent->prefixLength = unsigned(matched);
+            std::copy_n(inner->prefix, std::min(matched, MaxPrefix), parent->prefix);
+            shortenPrefix(inner, depth, matched + 1);
+            parent->add(innerByte, inner);
+            attach(parent.get(), added, addedBytes, position);
+            *ref = parent.release();
+            auto bigger = position < addedBytes.size() && byteAt(addedBytes, position) > innerByte;
+            linkLeaf(added, bigger ? maxLeaf(inner) : before);
+            return {Iterator{added}, true};
+        }
+
+        void removeKey(const Bytes &bytes)
+        {
+            RadixNode **ref = &_root;
+            size_t depth = 0;
+            while (*ref)
+            {
+                if (isLeaf(*ref))
+                {
+                    // only leaf at root gets here, other leafs are removed from their parent below
+                    auto leaf = asLeaf(*ref);
+                    if (compareBytes(keyBytes(leaf), bytes) != 0)
+                    {
+                        break;
+                    }
+                    *ref = nullptr;
+                    removeLeaf(leaf);
+                    return;
+                }
+                auto inner = asInner(*ref);
+                if (prefixMismatch(inner, bytes, depth) < inner->prefixLength)
+                {
+                    break;
+                }
+                depth += inner->prefixLength;
+                auto atEnd = depth == bytes.size();
+                auto byte = atEnd ? 0 : byteAt(bytes, depth);
+                auto slot = atEnd ? &inner->terminal : findChild(inner, byte);
+                if (!slot || !*slot)
+                {
+                    break;
+                }
+                if (!isLeaf(*slot))
+                {
+                    ref = slot;
+                    ++depth;
+                    continue;
+                }
+                auto leaf = asLeaf(*slot);
+                if (compareBytes(keyBytes(leaf), bytes) != 0)
+                {
+                    break;
+                }
+                if (atEnd)
+                {
+                    inner->terminal = nullptr;
+                }
+                else
+                {
+                    visitInner(inner, [byte](auto node) { node->remove(byte); });
+                }
+                compact(ref);
+                removeLeaf(leaf);
+                return;
+            }
+            throw std::out_of_range("Item was not found");
+        }
+
+        // restores invariants of inner node in slot after it lost child or terminal
+        void compact(RadixNode **ref)
+        {
+            auto inner = asInner(*ref);
+            if (inner->count == 0)
+            {
+                *ref = inner->terminal;
+                deleteInner(inner);
+            }
+            else if (inner->count == 1 && !inner->terminal)
+            {
+                *ref = collapse(inner);
+                deleteInner(inner);
+            }
+            else if (visitInner(inner, [](auto node) { return node->isSparse(); }))
+            {
+                *ref = shrink(inner);
+            }
+        }
+
+        // returns only child of inner, when it is inner node too it takes prefix of inner and its own key byte
+        static RadixNode *collapse(RadixInner *inner)
+        {
+            unsigned char byte = 0;
+            RadixNode *child = nullptr;
+            visitInner(inner, [&](auto node) {
+                node->forEach([&](unsigned char key, RadixNode *only) {
+                    byte = key;
+                    child = only;
+                });
+            });
+            if (isLeaf(child))
+            {
+                return child;
+            }
+            auto childInner = asInner(child);
+            unsigned char merged[MaxPrefix] = {};
+            auto stored = std::min<size_t>(inner->prefixLength, MaxPrefix);
+            std::copy_n(inner->prefix, stored, merged);
+            if (stored < MaxPrefix)
+            {
+                merged[stored++] = byte;
+                std::copy_n(childInner->prefix, std::min<size_t>(childInner->prefixLength, MaxPrefix - stored),
+                            merged + stored);
+            }
+            childInner->prefixLength += inner->prefixLength + 1;
+            std::copy_n(merged, MaxPrefix, childInner->prefix);
+            return child;
+        }
+
+        static RadixInner *grow(RadixInner *inner)
+        {
+            RadixInner *bigger;
+            switch (inner->type)
+            {
+            case RadixNodeType::Node4:
+                bigger = new RadixNode16(*static_cast<RadixNode4 *>(inner));
+                break;
+            case RadixNodeType::Node16:
+                bigger = new RadixNode48(*static_cast<RadixNode16 *>(inner));
+                break;
+            default:
+                bigger = new RadixNode256(*static_cast<RadixNode48 *>(inner));
+            }
+            deleteInner(inner);
+            return bigger;
+        }
+
+        static RadixInner *shrink(RadixInner *inner)
+        {
+            RadixInner *smaller;
+            switch (inner->type)
+            {
+            case RadixNodeType::Node16:
+                smaller = new RadixNode4(*static_cast<RadixNode16 *>(inner));
+                break;
+            case RadixNodeType::Node48:
+                smaller = new RadixNode16(*static_cast<RadixNode48 *>(inner));
+                break;
+            default:
+                smaller = new RadixNode48(*static_cast<RadixNode256 *>(inner));
+            }
+            deleteInner(inner);
+            return smaller;
+        }
+
+        static void deleteInner(RadixInner *inner)
+        {
+            visitInner(inner, [](auto node) { delete node; });
+        }
+
+        static void deleteSubtree(RadixNode *node)
+        {
+            if (isLeaf(node))
+            {
+                delete asLeaf(node);
+                return;
+            }
+            auto inner = asInner(node);
+            if (inner->terminal)
+            {
+                delete asLeaf(inner->terminal);
+            }
+            visitInner(inner, [](auto node) {
+                node->forEach([](unsigned char, RadixNode *child) { deleteSubtree(child); });
+            });
+            deleteInner(inner);
+        }
+
+        // links new leaf after biggest leaf of before subtree, or as first one
+        void linkLeaf(Leaf *leaf, RadixNode *before)
+        {
+            auto prev = before ? maxLeaf(before) : nullptr;
+            auto next = prev ? prev->next : _first;
+            leaf->prev = prev;
+            leaf->next = next;
+            (prev ? prev->next : _first) = leaf;
+            (next ? next->prev : _last) = leaf;
+            ++_size;
+        }
+
+        void removeLeaf(Leaf *leaf)
+        {
+            (leaf->prev ? leaf->prev->next : _first) = leaf->next;
+            (leaf->next ? leaf->next->prev : _last) = leaf->prev;
+            delete leaf;
+            --_size;
+        }
+
+        void assertLeaf(const Leaf *leaf) const
+        {
+            if (!leaf)
+            {
+                throw std::out_of_range("Item was not found");
+            }
+        }
+    };
+
+    template <class K, class T, class Traits>
+    bool operator==(const RadixMap<K, T, Traits> &lhs, const RadixMap<K, T, Traits> &rhs)
+    {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    template <class K, class T, class Traits>
+    bool operator!=(const RadixMap<K, T, Traits> &lhs, const RadixMap<K, T, Traits> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+} // namespace sd
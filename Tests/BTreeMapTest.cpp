@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+
+#include "BTreeMap.hpp"
+
+class BTreeMapTest : public ::testing::Test
+{
+  protected:
+    static void SetUpTestSuite() {}
+
+    BTreeMapTest() {}
+
+    void SetUp() override {}
+
+    void TearDown() override {}
+
+    ~BTreeMapTest() {}
+
+    static void TearDownTestSuite() {}
+};
+
+namespace
+{
+    // smallest nodes, forces deep trees with many splits and merges
+    template <class K, class T> using NarrowBTreeMap = sd::BTreeMap<K, T, std::less<K>, 0>;
+} // namespace
+
+TEST_F(BTreeMapTest, InsertTest)
+{
+    sd::BTreeMap<int, std::string> l;
+
+    EXPECT_TRUE(l.insert({2, "two"}).second);
+    EXPECT_TRUE(l.insert({1, "one"}).second);
+    EXPECT_TRUE(l.insert({3, "three"}).second);
+    EXPECT_FALSE(l.insert({2, "other"}).second);
+
+    EXPECT_EQ(l.size(), 3);
+    EXPECT_EQ(l[1], "one");
+    EXPECT_EQ(l[2], "two");
+    EXPECT_EQ(l[3], "three");
+}
+
+TEST_F(BTreeMapTest, InsertReturnsInsertedTest)
+{
+    NarrowBTreeMap<int, int> l;
+
+    for (int i = 0; i < 200; ++i)
+    {
+        auto key = (i * 37) % 200;
+        auto [it, inserted] = l.insert({key, i});
+        EXPECT_TRUE(inserted);
+        EXPECT_EQ(it->first, key);
+        EXPECT_EQ(it->second, i);
+    }
+}
+
+TEST_F(BTreeMapTest, AtTest)
+{
+    const sd::BTreeMap<int, int> l = {{1, 10}, {2, 20}};
+
+    EXPECT_EQ(l.at(1), 10);
+    EXPECT_EQ(l.at(2), 20);
+    EXPECT_THROW(l.at(3), std::out_of_range);
+}
+
+TEST_F(BTreeMapTest, FindTest)
+{
+    sd::BTreeMap<int, int> l = {{1, 10}, {3, 30}, {5, 50}};
+
+    EXPECT_EQ(l.find(3)->second, 30);
+    EXPECT_EQ(l.find(4), l.end());
+    EXPECT_TRUE(l.contains(5));
+    EXPECT_FALSE(l.contains(0));
+
+    l.find(1)->second = 11;
+    EXPECT_EQ(l.at(1), 11);
+}
+
+TEST_F(BTreeMapTest, RemoveTest)
+{
+    sd::BTreeMap<int, int> l = {{1, 10}, {2, 20}, {3, 30}};
+
+    l.remove(2);
+
+    EXPECT_EQ(l.size(), 2);
+    EXPECT_FALSE(l.contains(2));
+    EXPECT_THROW(l.remove(2), std::out_of_range);
+
+    l.remove(1);
+    l.remove(3);
+
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(l.begin(), l.end());
+    EXPECT_THROW(l.remove(3), std::out_of_range);
+}
+
+TEST_F(BTreeMapTest, IterationTest)
+{
+    NarrowBTreeMap<int, int> l;
+    for (int i = 999; i >= 0; --i)
+    {
+        l.insert({i, i * 2});
+    }
+
+    int expected = 0;
+    for (auto &[key, value] : l)
+    {
+        EXPECT_EQ(key, expected);
+        EXPECT_EQ(value, expected * 2);
+        ++expected;
+    }
+    EXPECT_EQ(expected, 1000);
+
+    for (auto it = l.rBegin(); it != l.rEnd(); ++it)
+    {
+        EXPECT_EQ(it->first, --expected);
+    }
+    EXPECT_EQ(expected, 0);
+}
+
+TEST_F(BTreeMapTest, LowerUpperBoundTest)
+{
+    NarrowBTreeMap<int, int> l;
+    for (int i = 0; i < 100; i += 2)
+    {
+        l.insert({i, i});
+    }
+
+    EXPECT_EQ(l.lowerBound(10)->first, 10);
+    EXPECT_EQ(l.lowerBound(11)->first, 12);
+    EXPECT_EQ(l.upperBound(10)->first, 12);
+    EXPECT_EQ(l.lowerBound(-5)->first, 0);
+    EXPECT_EQ(l.lowerBound(99), l.end());
+    EXPECT_EQ(l.upperBound(98), l.end());
+}
+
+TEST_F(BTreeMapTest, CopyMoveTest)
+{
+    NarrowBTreeMap<int, std::string> l = {{1, "one"}, {2, "two"}, {3, "three"}};
+
+    auto copy = l;
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), copy.begin(), copy.end()));
+
+    auto moved = std::move(l);
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(moved.size(), 3);
+    EXPECT_EQ(moved[2], "two");
+
+    copy = moved;
+    copy.remove(1);
+    EXPECT_EQ(copy.size(), 2);
+    EXPECT_EQ(moved.size(), 3);
+}
+
+TEST_F(BTreeMapTest, RandomInsertRemoveTest)
+{
+    NarrowBTreeMap<int, std::string> l;
+    std::map<int, std::string> expected;
+    std::mt19937 gen(123);
+    std::uniform_int_distribution<int> dist(0, 2000);
+
+    for (int i = 0; i < 30000; ++i)
+    {
+        auto key = dist(gen);
+        if (gen() % 3)
+        {
+            auto value = std::to_string(i);
+            EXPECT_EQ(l.insert({key, value}).second, expected.insert({key, value}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+    }
+
+    EXPECT_EQ(l.size(), expected.size());
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+    EXPECT_TRUE(std::equal(l.rBegin(), l.rEnd(), expected.rbegin(), expected.rend()));
+
+    for (auto &[key, value] : expected)
+    {
+        l.remove(key);
+    }
+    EXPECT_TRUE(l.empty());
+}
+
+TEST_F(BTreeMapTest, DefaultNodeRandomInsertRemoveTest)
+{
+    sd::BTreeMap<int, int> l;
+    std::map<int, int> expected;
+    std::mt19937 gen(321);
+    std::uniform_int_distribution<int> dist(0, 20000);
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        auto key = dist(gen);
+        if (gen() % 3)
+        {
+            EXPECT_EQ(l.insert({key, i}).second, expected.insert({key, i}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+    }
+
+    EXPECT_EQ(l.size(), expected.size());
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+}
+
+TEST_F(BTreeMapTest, StringKeyTest)
+{
+    NarrowBTreeMap<std::string, int> l;
+    std::map<std::string, int> expected;
+    std::mt19937 gen(42);
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        auto key = std::to_string(gen() % 1000);
+        if (gen() % 4)
+        {
+            EXPECT_EQ(l.insert({key, i}).second, expected.insert({key, i}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+    }
+
+    EXPECT_EQ(l.size(), expected.size());
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+    for (auto &[key, value] : expected)
+    {
+        EXPECT_EQ(l.at(key), value);
+    }
+}
@@ -369,3 +369,20 @@ TEST_F(CacheTest, WrapperGeneralUsage)
     cache.Remove<int>("dual");
     auto countAfter = cache.Count();
 }
+
+TEST_F(CacheTest, StringViewLookupTest)
+{
+    sd::Cache cache;
+
+    cache.Add("int", 12);
+    cache.Add("string", "hello"s);
+
+    std::string_view buffer = "int,string,bool";
+
+    EXPECT_EQ(*cache.Get<int>(buffer.substr(0, 3)), 12);
+    EXPECT_EQ(*cache.Get<std::string>(buffer.substr(4, 6)), "hello");
+    EXPECT_TRUE(cache.Contains(buffer.substr(4, 6)));
+    EXPECT_FALSE(cache.Contains(buffer.substr(11)));
+    EXPECT_TRUE(cache.Remove(buffer.substr(0, 3)));
+    EXPECT_FALSE(cache.Contains("int"));
+}
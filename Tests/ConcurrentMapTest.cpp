@@ -0,0 +1,232 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentMap.hpp"
+
+class ConcurrentMapTest : public ::testing::Test
+{
+  protected:
+    static void SetUpTestSuite() {}
+
+    ConcurrentMapTest() {}
+
+    void SetUp() override {}
+
+    void TearDown() override {}
+
+    ~ConcurrentMapTest() {}
+
+    static void TearDownTestSuite() {}
+};
+
+namespace
+{
+    template <class Function> void runThreads(size_t count, Function function)
+    {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < count; ++i)
+        {
+            threads.emplace_back(function, i);
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+} // namespace
+
+TEST_F(ConcurrentMapTest, InsertTest)
+{
+    sd::ConcurrentMap<int, std::string> l;
+
+    EXPECT_TRUE(l.insert({2, "two"}));
+    EXPECT_TRUE(l.insert({1, "one"}));
+    EXPECT_TRUE(l.insert({3, "three"}));
+    EXPECT_FALSE(l.insert({2, "other"}));
+
+    EXPECT_EQ(l.size(), 3);
+    EXPECT_EQ(l.get(1), "one");
+    EXPECT_EQ(l.get(2), "two");
+    EXPECT_EQ(l.get(3), "three");
+    EXPECT_EQ(l.get(4), std::nullopt);
+}
+
+TEST_F(ConcurrentMapTest, FindTest)
+{
+    sd::ConcurrentMap<int, int> l = {{1, 10}, {3, 30}, {5, 50}};
+
+    EXPECT_EQ(l.find(3)->second, 30);
+    EXPECT_EQ(l.find(4), l.end());
+    EXPECT_FALSE(l.find(4));
+    EXPECT_TRUE(l.contains(5));
+    EXPECT_FALSE(l.contains(0));
+}
+
+TEST_F(ConcurrentMapTest, RemoveTest)
+{
+    sd::ConcurrentMap<int, int> l = {{1, 10}, {2, 20}, {3, 30}};
+
+    EXPECT_TRUE(l.remove(2));
+    EXPECT_FALSE(l.remove(2));
+
+    EXPECT_EQ(l.size(), 2);
+    EXPECT_FALSE(l.contains(2));
+
+    EXPECT_TRUE(l.remove(1));
+    EXPECT_TRUE(l.remove(3));
+
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(l.begin(), l.end());
+
+    EXPECT_TRUE(l.insert({2, 22}));
+    EXPECT_EQ(l.get(2), 22);
+}
+
+TEST_F(ConcurrentMapTest, IterationTest)
+{
+    sd::ConcurrentMap<int, int> l;
+    for (int i = 999; i >= 0; --i)
+    {
+        l.insert({i, i * 2});
+    }
+
+    int expected = 0;
+    for (auto &[key, value] : l)
+    {
+        EXPECT_EQ(key, expected);
+        EXPECT_EQ(value, expected * 2);
+        ++expected;
+    }
+    EXPECT_EQ(expected, 1000);
+
+    std::vector<int> keys;
+    for (auto &[key, value] : l.range(10, 15))
+    {
+        keys.push_back(key);
+    }
+    EXPECT_EQ(keys, (std::vector<int>{10, 11, 12, 13, 14}));
+    EXPECT_TRUE(l.range(20, 10).empty());
+    EXPECT_EQ(l.lowerBound(2000), l.end());
+}
+
+TEST_F(ConcurrentMapTest, SequentialRandomTest)
+{
+    sd::ConcurrentMap<int, int> l;
+    std::map<int, int> expected;
+    std::mt19937 gen(123);
+    std::uniform_int_distribution<int> dist(0, 2000);
+
+    for (int i = 0; i < 30000; ++i)
+    {
+        auto key = dist(gen);
+        if (gen() % 3)
+        {
+            EXPECT_EQ(l.insert({key, i}), expected.insert({key, i}).second);
+        }
+        else
+        {
+            EXPECT_EQ(l.remove(key), expected.erase(key) == 1);
+        }
+    }
+
+    EXPECT_EQ(l.size(), expected.size());
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+}
+
+TEST_F(ConcurrentMapTest, ConcurrentInsertTest)
+{
+    const int threads = 8;
+    const int perThread = 5000;
+    sd::ConcurrentMap<int, int> l;
+
+    runThreads(threads, [&](size_t thread) {
+        for (int i = 0; i < perThread; ++i)
+        {
+            // interleaved keys, so threads keep contending for same predecessors
+            auto key = i * threads + int(thread);
+            EXPECT_TRUE(l.insert({key, key}));
+        }
+    });
+
+    EXPECT_EQ(l.size(), threads * perThread);
+    int expected = 0;
+    for (auto &[key, value] : l)
+    {
+        EXPECT_EQ(key, expected++);
+    }
+    EXPECT_EQ(expected, threads * perThread);
+}
+
+TEST_F(ConcurrentMapTest, ConcurrentSameKeyInsertTest)
+{
+    sd::ConcurrentMap<int, int> l;
+    std::atomic<int> inserted = 0;
+
+    runThreads(8, [&](size_t thread) {
+        for (int key = 0; key < 2000; ++key)
+        {
+            inserted += l.insert({key, int(thread)});
+        }
+    });
+
+    EXPECT_EQ(inserted, 2000);
+    EXPECT_EQ(l.size(), 2000);
+}
+
+TEST_F(ConcurrentMapTest, ConcurrentInsertRemoveTest)
+{
+    const int threads = 8;
+    const int keys = 512;
+    sd::ConcurrentMap<int, std::string> l;
+    std::atomic<int> balance[keys] = {};
+
+    runThreads(threads, [&](size_t thread) {
+        std::mt19937 gen{unsigned(thread)};
+        for (int i = 0; i < 20000; ++i)
+        {
+            auto key = int(gen() % keys);
+            switch (gen() % 4)
+            {
+            case 0:
+                if (l.insert({key, std::to_string(key)}))
+                {
+                    ++balance[key];
+                }
+                break;
+            case 1:
+                if (l.remove(key))
+                {
+                    --balance[key];
+                }
+                break;
+            case 2:
+                if (auto item = l.get(key))
+                {
+                    EXPECT_EQ(*item, std::to_string(key));
+                }
+                break;
+            default:
+                int previous = -1;
+                for (auto &[key, item] : l.range(key, key + 32))
+                {
+                    EXPECT_GT(key, previous);
+                    EXPECT_EQ(item, std::to_string(key));
+                    previous = key;
+                }
+            }
+        }
+    });
+
+    size_t present = 0;
+    for (int key = 0; key < keys; ++key)
+    {
+        EXPECT_EQ(balance[key], int(l.contains(key)));
+        present += l.contains(key);
+    }
+    EXPECT_EQ(l.size(), present);
+}
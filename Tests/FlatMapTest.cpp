@@ -0,0 +1,292 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FlatMap.hpp"
+
+class FlatMapTest : public ::testing::Test
+{
+  protected:
+    static void SetUpTestSuite() {}
+
+    FlatMapTest() {}
+
+    void SetUp() override {}
+
+    void TearDown() override {}
+
+    ~FlatMapTest() {}
+
+    static void TearDownTestSuite() {}
+};
+
+namespace
+{
+    template <class TMap, class TExpected> bool sameElements(const TMap &map, const TExpected &expected)
+    {
+        if (map.size() != expected.size())
+        {
+            return false;
+        }
+        auto it = map.begin();
+        for (auto &[key, value] : expected)
+        {
+            if (it->first != key || it->second != value)
+            {
+                return false;
+            }
+            ++it;
+        }
+        return it == map.end();
+    }
+} // namespace
+
+TEST_F(FlatMapTest, InsertTest)
+{
+    sd::FlatMap<int, std::string> l;
+
+    EXPECT_TRUE(l.insert({2, "two"}).second);
+    EXPECT_TRUE(l.insert({1, "one"}).second);
+    EXPECT_TRUE(l.insert({3, "three"}).second);
+    EXPECT_FALSE(l.insert({2, "other"}).second);
+
+    EXPECT_EQ(l.size(), 3);
+    EXPECT_EQ(l[1], "one");
+    EXPECT_EQ(l[2], "two");
+    EXPECT_EQ(l[3], "three");
+
+    auto [it, inserted] = l.insert({0, "zero"});
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(it->first, 0);
+    EXPECT_EQ(it->second, "zero");
+}
+
+TEST_F(FlatMapTest, AtTest)
+{
+    const sd::FlatMap<int, int> l = {{1, 10}, {2, 20}};
+
+    EXPECT_EQ(l.at(1), 10);
+    EXPECT_EQ(l.at(2), 20);
+    EXPECT_THROW(l.at(3), std::out_of_range);
+    EXPECT_THROW(
+        try { l.at(0); } catch (const std::out_of_range &e) {
+            EXPECT_STREQ("Item was not found", e.what());
+            throw;
+        },
+        std::out_of_range);
+}
+
+TEST_F(FlatMapTest, FindTest)
+{
+    sd::FlatMap<int, int> l = {{1, 10}, {3, 30}, {5, 50}};
+
+    EXPECT_EQ(l.find(3)->second, 30);
+    EXPECT_EQ(l.find(4), l.end());
+    EXPECT_FALSE(l.find(6));
+    EXPECT_TRUE(l.contains(5));
+    EXPECT_FALSE(l.contains(0));
+
+    l.find(1)->second = 11;
+    EXPECT_EQ(l.at(1), 11);
+}
+
+TEST_F(FlatMapTest, RemoveTest)
+{
+    sd::FlatMap<int, int> l = {{1, 10}, {2, 20}, {3, 30}};
+
+    l.remove(2);
+
+    EXPECT_EQ(l.size(), 2);
+    EXPECT_FALSE(l.contains(2));
+    EXPECT_THROW(l.remove(2), std::out_of_range);
+
+    l.remove(1);
+    l.remove(3);
+
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(l.begin(), l.end());
+}
+
+TEST_F(FlatMapTest, BulkBuildTest)
+{
+    std::vector<std::pair<int, std::string>> v = {{5, "a"}, {3, "b"}, {3, "c"}, {8, "d"}, {1, "e"}, {5, "f"}};
+    sd::FlatMap<int, std::string> l(v.begin(), v.end());
+
+    EXPECT_EQ(l.size(), 4);
+    EXPECT_EQ(l.keys(), (std::vector<int>{1, 3, 5, 8}));
+    // first occurrence wins, same as inserting one by one
+    EXPECT_EQ(l[3], "b");
+    EXPECT_EQ(l[5], "a");
+
+    std::vector<std::pair<int, std::string>> more = {{4, "g"}, {3, "h"}, {9, "i"}, {0, "j"}};
+    l.insert(more.begin(), more.end());
+
+    EXPECT_EQ(l.keys(), (std::vector<int>{0, 1, 3, 4, 5, 8, 9}));
+    EXPECT_EQ(l[3], "b");
+    EXPECT_EQ(l[4], "g");
+}
+
+TEST_F(FlatMapTest, SortedUniqueConstructorTest)
+{
+    std::vector<std::pair<int, int>> v;
+    for (int i = 0; i < 100; ++i)
+    {
+        v.push_back({i * 2, i});
+    }
+    sd::FlatMap<int, int> l(sd::sortedUnique, v.begin(), v.end());
+
+    EXPECT_TRUE(sameElements(l, v));
+    EXPECT_EQ(l.at(42), 21);
+}
+
+TEST_F(FlatMapTest, IterationTest)
+{
+    sd::FlatMap<int, int> l;
+    for (int i = 999; i >= 0; --i)
+    {
+        l.insert({i, i * 2});
+    }
+
+    int expected = 0;
+    for (auto [key, value] : l)
+    {
+        EXPECT_EQ(key, expected);
+        EXPECT_EQ(value, expected * 2);
+        ++expected;
+    }
+    EXPECT_EQ(expected, 1000);
+
+    for (auto it = l.rBegin(); it != l.rEnd(); ++it)
+    {
+        EXPECT_EQ(it->first, --expected);
+    }
+    EXPECT_EQ(expected, 0);
+    EXPECT_FALSE(l.rEnd());
+
+    for (auto [key, value] : l)
+    {
+        value = key;
+    }
+    EXPECT_EQ(l[10], 10);
+}
+
+TEST_F(FlatMapTest, LowerUpperBoundTest)
+{
+    sd::FlatMap<int, int> l;
+    for (int i = 0; i < 100; i += 2)
+    {
+        l.insert({i, i});
+    }
+    const auto &cl = l;
+
+    EXPECT_EQ(l.lowerBound(10)->first, 10);
+    EXPECT_EQ(l.lowerBound(11)->first, 12);
+    EXPECT_EQ(l.upperBound(10)->first, 12);
+    EXPECT_EQ(cl.lowerBound(-5)->first, 0);
+    EXPECT_EQ(l.lowerBound(99), l.end());
+    EXPECT_EQ(cl.upperBound(98), cl.end());
+}
+
+TEST_F(FlatMapTest, RangeTest)
+{
+    sd::FlatMap<int, int> l;
+    for (int i = 0; i < 100; i += 2)
+    {
+        l.insert({i, i});
+    }
+
+    std::vector<int> keys;
+    for (auto [key, value] : l.range(10, 20))
+    {
+        keys.push_back(key);
+    }
+    EXPECT_EQ(keys, (std::vector<int>{10, 12, 14, 16, 18}));
+    EXPECT_TRUE(l.range(11, 12).empty());
+    EXPECT_TRUE(l.range(20, 10).empty());
+    EXPECT_TRUE(l.range(200, 300).empty());
+}
+
+TEST_F(FlatMapTest, TransparentLookupTest)
+{
+    sd::FlatMap<std::string, int, std::less<>> l = {{"hey", 1}, {"may", 2}, {"bay", 3}};
+    std::string_view key = "may";
+
+    EXPECT_EQ(l.at(key), 2);
+    EXPECT_EQ(l.find("bay")->second, 3);
+    EXPECT_TRUE(l.contains(key));
+    EXPECT_FALSE(l.contains(std::string_view{"yay"}));
+    EXPECT_THROW(l.at(std::string_view{"yay"}), std::out_of_range);
+}
+
+TEST_F(FlatMapTest, CopyMoveTest)
+{
+    sd::FlatMap<int, std::string> l = {{1, "one"}, {2, "two"}, {3, "three"}};
+
+    auto copy = l;
+    EXPECT_EQ(copy, l);
+
+    auto moved = std::move(l);
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(moved.size(), 3);
+    EXPECT_EQ(moved[2], "two");
+
+    copy.remove(1);
+    EXPECT_NE(copy, moved);
+    EXPECT_EQ(moved.size(), 3);
+}
+
+TEST_F(FlatMapTest, RandomLookupTest)
+{
+    std::mt19937 gen(123);
+    for (int size : {0, 1, 15, 16, 17, 100, 1000, 4097})
+    {
+        std::map<int, int> expected;
+        std::uniform_int_distribution<int> dist(-size * 4, size * 4);
+        while (expected.size() < size_t(size))
+        {
+            expected.insert({dist(gen), int(expected.size())});
+        }
+        sd::FlatMap<int, int> l(expected.begin(), expected.end());
+
+        EXPECT_TRUE(sameElements(l, expected));
+        for (int key = -size * 4 - 1; key <= size * 4 + 1; ++key)
+        {
+            auto lower = expected.lower_bound(key);
+            auto it = l.lowerBound(key);
+            if (lower == expected.end())
+            {
+                EXPECT_EQ(it, l.end());
+            }
+            else
+            {
+                EXPECT_EQ(it->first, lower->first);
+            }
+            EXPECT_EQ(l.contains(key), expected.count(key) == 1);
+        }
+    }
+}
+
+TEST_F(FlatMapTest, RandomInsertRemoveTest)
+{
+    sd::FlatMap<std::string, int> l;
+    std::map<std::string, int> expected;
+    std::mt19937 gen(42);
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        auto key = std::to_string(gen() % 1000);
+        if (gen() % 4)
+        {
+            EXPECT_EQ(l.insert({key, i}).second, expected.insert({key, i}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+    }
+
+    EXPECT_TRUE(sameElements(l, expected));
+}
@@ -0,0 +1,276 @@
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "IndexedMap.hpp"
+
+class IndexedMapTest : public ::testing::Test
+{
+  protected:
+    static void SetUpTestSuite() {}
+
+    IndexedMapTest() {}
+
+    void SetUp() override {}
+
+    void TearDown() override {}
+
+    ~IndexedMapTest() {}
+
+    static void TearDownTestSuite() {}
+};
+
+namespace
+{
+    template <class Map, class Expected> void expectSameItems(Map &map, const Expected &expected)
+    {
+        ASSERT_EQ(map.size(), expected.size());
+        EXPECT_TRUE(std::equal(map.begin(), map.end(), expected.begin(), expected.end()));
+        for (auto &[key, value] : expected)
+        {
+            auto it = map.find(key);
+            ASSERT_NE(it, map.end()) << key;
+            EXPECT_EQ(it->first, key);
+            EXPECT_EQ(it->second, value);
+        }
+    }
+
+    // every key lands in same slot, so removals have to shift whole run back
+    struct CollidingHash
+    {
+        size_t operator()(int) const { return 7; }
+    };
+} // namespace
+
+TEST_F(IndexedMapTest, InsertTest)
+{
+    sd::IndexedMap<int, std::string> l;
+
+    EXPECT_TRUE(l.insert({2, "two"}).second);
+    EXPECT_TRUE(l.insert({1, "one"}).second);
+    EXPECT_TRUE(l.insert({3, "three"}).second);
+    EXPECT_FALSE(l.insert({2, "other"}).second);
+
+    EXPECT_EQ(l.size(), 3);
+    EXPECT_EQ(l[1], "one");
+    EXPECT_EQ(l[2], "two");
+    EXPECT_EQ(l[3], "three");
+    EXPECT_THROW(l.at(4), std::out_of_range);
+
+    auto [it, inserted] = l.insert({-5, "minus five"});
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(it->second, "minus five");
+    EXPECT_EQ(l.begin()->first, -5);
+    EXPECT_EQ(l.front().first, -5);
+    EXPECT_EQ(l.back().first, 3);
+}
+
+TEST_F(IndexedMapTest, TryEmplaceInsertOrAssignTest)
+{
+    sd::IndexedMap<std::string, std::string> l;
+
+    EXPECT_TRUE(l.tryEmplace("a", 3, 'x').second);
+    EXPECT_FALSE(l.tryEmplace("a", 2, 'y').second);
+    EXPECT_EQ(l.at("a"), "xxx");
+
+    std::string key = "b";
+    EXPECT_TRUE(l.tryEmplace(std::move(key), "bee").second);
+    EXPECT_EQ(l.at("b"), "bee");
+
+    EXPECT_FALSE(l.insertOrAssign("a", "new").second);
+    EXPECT_TRUE(l.insertOrAssign("c", "cee").second);
+    EXPECT_EQ(l.at("a"), "new");
+    EXPECT_EQ(l.at("c"), "cee");
+    EXPECT_EQ(l.size(), 3);
+}
+
+TEST_F(IndexedMapTest, FindTest)
+{
+    sd::IndexedMap<int, int> l = {{1, 10}, {3, 30}, {1 << 20, 50}};
+    const auto &c = l;
+
+    EXPECT_EQ(l.find(3)->second, 30);
+    EXPECT_EQ(c.find(1 << 20)->second, 50);
+    EXPECT_EQ(l.find(4), l.end());
+    EXPECT_EQ(c.find(4), c.end());
+    EXPECT_TRUE(l.contains(1));
+    EXPECT_FALSE(l.contains(0));
+
+    // found iterator walks tree in order
+    auto it = l.find(3);
+    EXPECT_EQ((++it)->first, 1 << 20);
+    EXPECT_EQ((--it)->first, 3);
+    EXPECT_EQ((--it)->first, 1);
+
+    l.find(3)->second = 33;
+    EXPECT_EQ(l.at(3), 33);
+
+    sd::IndexedMap<int, int> empty;
+    EXPECT_FALSE(empty.contains(1));
+    EXPECT_EQ(empty.find(1), empty.end());
+}
+
+TEST_F(IndexedMapTest, RemoveTest)
+{
+    sd::IndexedMap<int, int> l = {{1, 10}, {2, 20}, {3, 30}, {4, 40}};
+
+    l.remove(2);
+    EXPECT_THROW(l.remove(2), std::out_of_range);
+    EXPECT_EQ(l.size(), 3);
+    EXPECT_FALSE(l.contains(2));
+
+    l.popFront();
+    l.popBack();
+    EXPECT_EQ(l.size(), 1);
+    EXPECT_FALSE(l.contains(1));
+    EXPECT_FALSE(l.contains(4));
+    EXPECT_EQ(l.at(3), 30);
+
+    l.remove(3);
+    EXPECT_TRUE(l.empty());
+    EXPECT_THROW(l.popFront(), std::runtime_error);
+
+    l.insert({2, 22});
+    EXPECT_EQ(l[2], 22);
+}
+
+TEST_F(IndexedMapTest, RangeTest)
+{
+    sd::IndexedMap<int, int> l;
+    for (int i = 0; i < 1000; i += 10)
+    {
+        l.insert({i, i});
+    }
+
+    EXPECT_EQ(l.lowerBound(5)->first, 10);
+    EXPECT_EQ(l.upperBound(10)->first, 20);
+    EXPECT_EQ(l.lowerBound(991), l.end());
+
+    std::vector<int> found;
+    for (auto &[key, value] : l.range(95, 140))
+    {
+        found.push_back(key);
+    }
+    EXPECT_EQ(found, std::vector<int>({100, 110, 120, 130}));
+}
+
+TEST_F(IndexedMapTest, GrowAndClearTest)
+{
+    sd::IndexedMap<int, int> l;
+    EXPECT_EQ(l.bucketCount(), 0);
+
+    l.reserve(1000);
+    auto buckets = l.bucketCount();
+    EXPECT_GE(buckets * 3 / 4, 1000);
+    for (int i = 0; i < 1000; ++i)
+    {
+        l.insert({i, i});
+    }
+    EXPECT_EQ(l.bucketCount(), buckets);
+
+    for (int i = 1000; i < 5000; ++i)
+    {
+        l.insert({i, i});
+    }
+    EXPECT_GT(l.bucketCount(), buckets);
+    for (int i = 0; i < 5000; ++i)
+    {
+        ASSERT_EQ(l.at(i), i);
+    }
+
+    buckets = l.bucketCount();
+    l.clear();
+    EXPECT_TRUE(l.empty());
+    EXPECT_FALSE(l.contains(10));
+    EXPECT_EQ(l.bucketCount(), buckets);
+}
+
+TEST_F(IndexedMapTest, CopyMoveTest)
+{
+    sd::IndexedMap<std::string, int> v = {{"one", 1}, {"two", 2}, {"three", 3}};
+    sd::IndexedMap<std::string, int> l(v);
+
+    EXPECT_EQ(l, v);
+    l.remove("two");
+    EXPECT_NE(l, v);
+    EXPECT_TRUE(v.contains("two"));
+
+    // copy indexes its own nodes
+    l.at("one") = 11;
+    EXPECT_EQ(v.at("one"), 1);
+
+    sd::IndexedMap<std::string, int> moved(std::move(v));
+    EXPECT_TRUE(v.empty());
+    EXPECT_FALSE(v.contains("one"));
+    EXPECT_EQ(moved.size(), 3);
+    EXPECT_EQ(moved.at("three"), 3);
+
+    v = moved;
+    EXPECT_EQ(v, moved);
+    v.at("two") = 22;
+    EXPECT_EQ(moved.at("two"), 2);
+
+    l = std::move(moved);
+    EXPECT_EQ(l.at("two"), 2);
+    EXPECT_EQ(l.size(), 3);
+}
+
+TEST_F(IndexedMapTest, CollidingHashTest)
+{
+    sd::IndexedMap<int, int, CollidingHash> l;
+    std::map<int, int> expected;
+    std::mt19937 gen(11);
+
+    for (int i = 0; i < 3000; ++i)
+    {
+        auto key = int(gen() % 200);
+        if (gen() % 2)
+        {
+            EXPECT_EQ(l.insert({key, i}).second, expected.insert({key, i}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+        else
+        {
+            EXPECT_FALSE(l.contains(key));
+        }
+    }
+
+    expectSameItems(l, expected);
+}
+
+TEST_F(IndexedMapTest, RandomInsertRemoveTest)
+{
+    sd::IndexedMap<int64_t, int> l;
+    std::map<int64_t, int> expected;
+    std::mt19937_64 gen(123);
+
+    for (int i = 0; i < 50000; ++i)
+    {
+        auto key = int64_t(gen() % 5000);
+        if (gen() % 3)
+        {
+            EXPECT_EQ(l.insert({key, i}).second, expected.insert({key, i}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+        else
+        {
+            EXPECT_THROW(l.remove(key), std::out_of_range);
+        }
+        if (i % 97 == 0)
+        {
+            auto probe = int64_t(gen() % 5000);
+            EXPECT_EQ(l.contains(probe), expected.contains(probe));
+        }
+    }
+
+    expectSameItems(l, expected);
+}
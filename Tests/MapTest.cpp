@@ -1,5 +1,10 @@
+#include <atomic>
+#include <cmath>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <random>
 #include <thread>
 
 #include "LinkedList.hpp"
@@ -632,14 +637,16 @@ TEST_F(MapTest, InsertRangeClassTest)
 
 TEST_F(MapTest, RemoveClassTest)
 {
-    // sd::Map<TestClass, std::string> l = {{{1}, "hey"}, {{2}, "may"}, {{3}, "bay"}, {{4}, "yay"}, {{5}, "tej"}};
-    //
-    // l.remove({1});
-    // l.remove({4});
-    //
-    // EXPECT_EQ(l[{2}], "may");
-    // EXPECT_EQ(l[{3}], "bay");
-    // EXPECT_EQ(l[{5}], "tej");
+    sd::Map<TestClass, std::string> l = {{{1}, "hey"}, {{2}, "may"}, {{3}, "bay"}, {{4}, "yay"}, {{5}, "tej"}};
+
+    l.remove({1});
+    l.remove({4});
+
+    EXPECT_EQ(l[{2}], "may");
+    EXPECT_EQ(l[{3}], "bay");
+    EXPECT_EQ(l[{5}], "tej");
+    EXPECT_FALSE(l.contains({1}));
+    EXPECT_FALSE(l.contains({4}));
 }
 
 TEST_F(MapTest, RemoveFailClassTest)
@@ -668,21 +675,21 @@ TEST_F(MapTest, ClearClassTest)
     EXPECT_FALSE(l.begin());
 }
 
-// TEST_F(MapTest, SizeClassTest)
-// {
-//     sd::Map<TestClass, std::string> l = {{{1}, "hey"}, {{2}, "may"}, {{3}, "bay"}, {{4}, "yay"}, {{5}, "tej"}};
+TEST_F(MapTest, SizeClassTest)
+{
+    sd::Map<TestClass, std::string> l = {{{1}, "hey"}, {{2}, "may"}, {{3}, "bay"}, {{4}, "yay"}, {{5}, "tej"}};
 
-//     EXPECT_EQ(l.size(), 5);
+    EXPECT_EQ(l.size(), 5);
 
-//     l.insert({{22}, "111"});
+    l.insert({{22}, "111"});
 
-//     EXPECT_EQ(l.size(), 6);
+    EXPECT_EQ(l.size(), 6);
 
-//     l.remove({22});
-//     l.remove({5});
+    l.remove({22});
+    l.remove({5});
 
-//     EXPECT_EQ(l.size(), 4);
-// }
+    EXPECT_EQ(l.size(), 4);
+}
 
 TEST_F(MapTest, EmptyClassTest)
 {
@@ -831,4 +838,1531 @@ TEST_F(MapTest, SwapClassTest)
     EXPECT_EQ(l2[{3}], "bay");
     EXPECT_EQ(l2[{4}], "yay");
     EXPECT_EQ(l2[{5}], "tej");
-}
\ No newline at end of file
+}
+
+TEST_F(MapTest, RandomInsertRemoveTest)
+{
+    sd::Map<int, int> l;
+    std::map<int, int> expected;
+    std::mt19937 gen(123);
+    std::uniform_int_distribution<int> dist(0, 500);
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        auto key = dist(gen);
+        if (gen() % 3)
+        {
+            EXPECT_EQ(l.insert({key, i}).second, expected.insert({key, i}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+    }
+
+    EXPECT_EQ(l.size(), expected.size());
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+}
+
+TEST_F(MapTest, PoolAllocatorTest)
+{
+    sd::Map<TestClass, std::string, std::less<TestClass>, sd::PoolNodeAllocator> l = {
+        {{1}, "hey"}, {{2}, "may"}, {{3}, "bay"}, {{4}, "yay"}, {{5}, "tej"}};
+
+    l.remove({2});
+    l.insert({{6}, "new"});
+
+    EXPECT_EQ(l.size(), 5);
+    EXPECT_EQ(l[{1}], "hey");
+    EXPECT_EQ(l[{3}], "bay");
+    EXPECT_EQ(l[{6}], "new");
+    EXPECT_FALSE(l.contains({2}));
+
+    l.clear();
+
+    EXPECT_TRUE(l.empty());
+    EXPECT_FALSE(l.begin());
+
+    l.insert({{7}, "again"});
+
+    EXPECT_EQ(l[{7}], "again");
+}
+
+TEST_F(MapTest, PoolAllocatorRandomInsertRemoveTest)
+{
+    sd::Map<int, std::string, std::less<int>, sd::PoolNodeAllocator> l;
+    std::map<int, std::string> expected;
+    std::mt19937 gen(321);
+    std::uniform_int_distribution<int> dist(0, 3000);
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        auto key = dist(gen);
+        if (gen() % 2)
+        {
+            EXPECT_EQ(l.insert({key, std::to_string(i)}).second, expected.insert({key, std::to_string(i)}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+    }
+
+    EXPECT_EQ(l.size(), expected.size());
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+}
+
+TEST_F(MapTest, PoolAllocatorMoveTest)
+{
+    sd::Map<int, std::string, std::less<int>, sd::PoolNodeAllocator> v;
+    for (int i = 0; i < 3000; ++i)
+    {
+        v.insert({i, std::to_string(i)});
+    }
+    sd::Map<int, std::string, std::less<int>, sd::PoolNodeAllocator> l(std::move(v));
+
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(l.size(), 3000);
+    EXPECT_EQ(l[2999], "2999");
+
+    v = std::move(l);
+
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(v.size(), 3000);
+    EXPECT_EQ(v[0], "0");
+}
+
+TEST_F(MapTest, PoolNodeAllocatorReuseTest)
+{
+    sd::PoolNodeAllocator<long, 4> pool;
+
+    auto a = pool.allocate();
+    auto b = pool.allocate();
+    pool.deallocate(a);
+
+    EXPECT_EQ(pool.allocate(), a);
+    EXPECT_NE(pool.allocate(), b);
+    EXPECT_EQ(pool.chunksCount(), 1);
+
+    pool.allocate();
+    pool.allocate();
+
+    EXPECT_EQ(pool.chunksCount(), 2);
+
+    pool.releaseAll();
+
+    EXPECT_EQ(pool.chunksCount(), 0);
+}
+TEST_F(MapTest, CustomCompareTest)
+{
+    sd::Map<int, std::string, std::greater<int>> l = {{1, "hey"}, {2, "may"}, {3, "bay"}, {4, "yay"}, {5, "tej"}};
+
+    EXPECT_EQ(l.begin()->first, 5);
+    EXPECT_EQ(l.rBegin()->first, 1);
+    EXPECT_EQ(l.at(3), "bay");
+    EXPECT_FALSE(l.insert({3, "other"}).second);
+    EXPECT_THROW(l.at(22), std::out_of_range);
+}
+
+TEST_F(MapTest, ThreeWayCompareTest)
+{
+    sd::Map<std::string, int, std::compare_three_way> l = {{"b", 2}, {"a", 1}, {"c", 3}};
+
+    auto it = l.begin();
+    EXPECT_EQ((it++)->first, "a");
+    EXPECT_EQ((it++)->first, "b");
+    EXPECT_EQ((it++)->first, "c");
+    EXPECT_FALSE(it);
+    EXPECT_EQ(l.at("b"), 2);
+    EXPECT_FALSE(l.contains("d"));
+}
+
+TEST_F(MapTest, SingleComparisonPerLevelTest)
+{
+    static size_t comparisons = 0;
+    struct CountingCompare
+    {
+        std::strong_ordering operator()(int lhs, int rhs) const
+        {
+            ++comparisons;
+            return lhs <=> rhs;
+        }
+    };
+    sd::Map<int, int, CountingCompare> l;
+    for (int i = 0; i < 1023; ++i)
+    {
+        l.insert({i, i});
+    }
+
+    for (int i = 0; i < 1023; ++i)
+    {
+        comparisons = 0;
+        l.at(i);
+        // red black tree height is at most 2 * log2(n + 1)
+        EXPECT_LE(comparisons, 20);
+    }
+}
+
+TEST_F(MapTest, TransparentLookupTest)
+{
+    sd::Map<std::string, int, std::less<>> l = {{"hey", 1}, {"may", 2}, {"bay", 3}};
+    const auto &cl = l;
+    std::string_view key = "may";
+    const char *rawKey = "bay";
+
+    EXPECT_EQ(l.at(key), 2);
+    EXPECT_EQ(cl.at(key), 2);
+    EXPECT_EQ(l.at(rawKey), 3);
+    EXPECT_EQ(l.find(key)->second, 2);
+    EXPECT_EQ(cl.find(rawKey)->second, 3);
+    EXPECT_TRUE(l.contains(key));
+    EXPECT_TRUE(l.contains("hey"));
+    EXPECT_FALSE(l.contains(std::string_view{"yay"}));
+    EXPECT_FALSE(l.find(std::string_view{"yay"}));
+    EXPECT_THROW(l.at(std::string_view{"yay"}), std::out_of_range);
+}
+
+TEST_F(MapTest, SortedRangeConstructorTest)
+{
+    for (int size = 0; size < 70; ++size)
+    {
+        std::vector<std::pair<const int, int>> v;
+        for (int i = 0; i < size; ++i)
+        {
+            v.push_back({i * 2, i});
+        }
+        sd::Map<int, int> l(v.begin(), v.end());
+        sd::Map<int, int> l2(sd::sortedUnique, v.begin(), v.end());
+
+        EXPECT_EQ(l.size(), size);
+        EXPECT_EQ(l2.size(), size);
+        EXPECT_TRUE(std::equal(l.begin(), l.end(), v.begin(), v.end()));
+        EXPECT_TRUE(std::equal(l2.rBegin(), l2.rEnd(), v.rbegin(), v.rend()));
+
+        for (int i = 0; i < size; ++i)
+        {
+            l.remove(i * 2);
+            l2.insert({i * 2 + 1, i});
+        }
+
+        EXPECT_TRUE(l.empty());
+        EXPECT_EQ(l2.size(), size * 2);
+    }
+}
+
+TEST_F(MapTest, UnsortedRangeConstructorTest)
+{
+    std::vector<std::pair<int, int>> v = {{5, 1}, {3, 2}, {3, 3}, {8, 4}, {1, 5}};
+    sd::Map<int, int> l(v.begin(), v.end());
+
+    EXPECT_EQ(l.size(), 4);
+    EXPECT_EQ(l[3], 2);
+    EXPECT_EQ(l.begin()->first, 1);
+    EXPECT_EQ(l.rBegin()->first, 8);
+}
+
+TEST_F(MapTest, CopyConstructorCloneTest)
+{
+    sd::Map<int, std::string> v;
+    for (int i = 0; i < 1000; ++i)
+    {
+        v.insert({(i * 7919) % 1000, std::to_string(i)});
+    }
+    sd::Map<int, std::string> l(v);
+
+    EXPECT_EQ(l.size(), v.size());
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), v.begin(), v.end()));
+
+    for (int i = 0; i < 1000; i += 2)
+    {
+        l.remove(i);
+    }
+
+    EXPECT_EQ(l.size(), 500);
+    EXPECT_EQ(v.size(), 1000);
+
+    v = l;
+
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), v.begin(), v.end()));
+}
+
+TEST_F(MapTest, LowerUpperBoundTest)
+{
+    sd::Map<int, std::string> l = {{10, "a"}, {20, "b"}, {30, "c"}, {40, "d"}};
+    const auto &cl = l;
+
+    EXPECT_EQ(l.lowerBound(20)->first, 20);
+    EXPECT_EQ(l.lowerBound(21)->first, 30);
+    EXPECT_EQ(l.lowerBound(0)->first, 10);
+    EXPECT_EQ(l.lowerBound(41), l.end());
+    EXPECT_EQ(cl.lowerBound(25)->first, 30);
+
+    EXPECT_EQ(l.upperBound(20)->first, 30);
+    EXPECT_EQ(l.upperBound(19)->first, 20);
+    EXPECT_EQ(l.upperBound(40), l.end());
+    EXPECT_EQ(cl.upperBound(5)->first, 10);
+}
+
+TEST_F(MapTest, EqualRangeTest)
+{
+    sd::Map<int, std::string> l = {{10, "a"}, {20, "b"}, {30, "c"}};
+
+    auto [first, last] = l.equalRange(20);
+    EXPECT_EQ(first->first, 20);
+    EXPECT_EQ(last->first, 30);
+
+    auto [missFirst, missLast] = l.equalRange(25);
+    EXPECT_EQ(missFirst, missLast);
+    EXPECT_EQ(missFirst->first, 30);
+
+    auto [endFirst, endLast] = l.equalRange(30);
+    EXPECT_EQ(endFirst->first, 30);
+    EXPECT_EQ(endLast, l.end());
+}
+
+TEST_F(MapTest, RangeTest)
+{
+    sd::Map<int, int> l;
+    for (int i = 0; i < 100; i += 2)
+    {
+        l.insert({i, i});
+    }
+
+    std::vector<int> keys;
+    for (auto &[key, value] : l.range(10, 20))
+    {
+        keys.push_back(key);
+    }
+    EXPECT_EQ(keys, (std::vector<int>{10, 12, 14, 16, 18}));
+
+    keys.clear();
+    for (auto &[key, value] : l.range(91, 1000))
+    {
+        keys.push_back(key);
+    }
+    EXPECT_EQ(keys, (std::vector<int>{92, 94, 96, 98}));
+
+    EXPECT_TRUE(l.range(11, 12).empty());
+    EXPECT_TRUE(l.range(20, 10).empty());
+    EXPECT_TRUE(l.range(200, 300).empty());
+
+    const auto &cl = l;
+    EXPECT_EQ(std::distance(cl.range(-5, 5).begin(), cl.range(-5, 5).end()), 3);
+}
+
+TEST_F(MapTest, TransparentRangeTest)
+{
+    sd::Map<std::string, int, std::less<>> l = {{"apple", 1}, {"apricot", 2}, {"banana", 3}, {"blueberry", 4}};
+
+    std::vector<std::string> keys;
+    for (auto &[key, value] : l.range(std::string_view{"ap"}, std::string_view{"aq"}))
+    {
+        keys.push_back(key);
+    }
+    EXPECT_EQ(keys, (std::vector<std::string>{"apple", "apricot"}));
+    EXPECT_EQ(l.lowerBound(std::string_view{"b"})->first, "banana");
+    EXPECT_EQ(l.upperBound(std::string_view{"banana"})->first, "blueberry");
+}
+
+TEST_F(MapTest, FrontBackTest)
+{
+    sd::Map<int, std::string> l = {{3, "c"}, {1, "a"}, {2, "b"}};
+
+    EXPECT_EQ(l.front().first, 1);
+    EXPECT_EQ(l.back().first, 3);
+
+    l.insert({0, "z"});
+    l.insert({9, "y"});
+
+    EXPECT_EQ(l.front().second, "z");
+    EXPECT_EQ(l.back().second, "y");
+    EXPECT_EQ(l.begin()->first, 0);
+    EXPECT_EQ(l.rBegin()->first, 9);
+
+    l.clear();
+
+    EXPECT_THROW(l.front(), std::runtime_error);
+    EXPECT_THROW(l.back(), std::runtime_error);
+}
+
+TEST_F(MapTest, PopFrontBackTest)
+{
+    sd::Map<int, int> l;
+    for (int i = 0; i < 100; ++i)
+    {
+        l.insert({(i * 37) % 100, i});
+    }
+
+    for (int i = 0; i < 25; ++i)
+    {
+        EXPECT_EQ(l.begin()->first, i);
+        l.popFront();
+        EXPECT_EQ(l.rBegin()->first, 99 - i);
+        l.popBack();
+    }
+
+    EXPECT_EQ(l.size(), 50);
+    EXPECT_EQ(l.front().first, 25);
+    EXPECT_EQ(l.back().first, 74);
+
+    while (!l.empty())
+    {
+        l.popFront();
+    }
+
+    EXPECT_FALSE(l.begin());
+    EXPECT_FALSE(l.rBegin());
+    EXPECT_THROW(l.popFront(), std::runtime_error);
+    EXPECT_THROW(l.popBack(), std::runtime_error);
+}
+
+TEST_F(MapTest, InsertReturnsInsertedTest)
+{
+    sd::Map<int, int> l;
+    for (int i = 0; i < 100; ++i)
+    {
+        auto [it, inserted] = l.insert({i, i * 2});
+        EXPECT_TRUE(inserted);
+        EXPECT_EQ(it->first, i);
+    }
+    auto [it, inserted] = l.insert({50, 0});
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(it->second, 100);
+}
+
+TEST_F(MapTest, OrderStatisticsTest)
+{
+    sd::Map<int, int, std::less<int>, sd::HeapNodeAllocator, sd::OrderStatistics> l;
+    for (int i = 0; i < 100; ++i)
+    {
+        l.insert({(i * 37) % 100 * 2, i});
+    }
+
+    EXPECT_EQ(l.nth(0)->first, 0);
+    EXPECT_EQ(l.nth(10)->first, 20);
+    EXPECT_EQ(l.nth(99)->first, 198);
+    EXPECT_EQ(l.nth(100), l.end());
+
+    EXPECT_EQ(l.rank(0), 0);
+    EXPECT_EQ(l.rank(20), 10);
+    EXPECT_EQ(l.rank(21), 11);
+    EXPECT_EQ(l.rank(-5), 0);
+    EXPECT_EQ(l.rank(1000), 100);
+
+    const auto &cl = l;
+    EXPECT_EQ(cl.nth(50)->first, 100);
+}
+
+TEST_F(MapTest, OrderStatisticsRandomInsertRemoveTest)
+{
+    using OrderedMap = sd::Map<int, int, std::less<int>, sd::PoolNodeAllocator, sd::OrderStatistics>;
+    OrderedMap l;
+    std::map<int, int> expected;
+    std::mt19937 gen(77);
+    std::uniform_int_distribution<int> dist(0, 3000);
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        auto key = dist(gen);
+        if (gen() % 3)
+        {
+            l.insert({key, i});
+            expected.insert({key, i});
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+    }
+
+    size_t index = 0;
+    for (auto &[key, value] : expected)
+    {
+        ASSERT_EQ(l.nth(index)->first, key);
+        ASSERT_EQ(l.rank(key), index);
+        ++index;
+    }
+
+    std::vector<std::pair<const int, int>> sorted(expected.begin(), expected.end());
+    OrderedMap built(sd::sortedUnique, sorted.begin(), sorted.end());
+    OrderedMap copy(l);
+    for (size_t i = 0; i < sorted.size(); i += 7)
+    {
+        EXPECT_EQ(built.nth(i)->first, sorted[i].first);
+        EXPECT_EQ(copy.nth(i)->first, sorted[i].first);
+        EXPECT_EQ(built.rank(sorted[i].first), i);
+    }
+}
+
+TEST_F(MapTest, CompactNodeRandomInsertRemoveTest)
+{
+    using CompactMap = sd::Map<int, int, std::less<int>, sd::PoolNodeAllocator, sd::OrderStatistics,
+                               sd::CompactMapNodeLinks>;
+    CompactMap l;
+    std::map<int, int> expected;
+    std::mt19937 gen(91);
+    std::uniform_int_distribution<int> dist(0, 3000);
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        auto key = dist(gen);
+        if (gen() % 3)
+        {
+            EXPECT_EQ(l.insert({key, i}).second, expected.insert({key, i}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+    }
+
+    ASSERT_EQ(l.size(), expected.size());
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+    EXPECT_TRUE(std::equal(l.rBegin(), l.rEnd(), expected.rbegin(), expected.rend()));
+    size_t index = 0;
+    for (auto &[key, value] : expected)
+    {
+        ASSERT_EQ(l.nth(index)->first, key);
+        ASSERT_EQ(l.rank(key), index);
+        ++index;
+    }
+
+    CompactMap copy(l);
+    EXPECT_EQ(copy, l);
+
+    using CompactNode = sd::MapNode<int, int, sd::NoAugmentation, sd::CompactMapNodeLinks>;
+    EXPECT_LT(sizeof(CompactNode), sizeof(sd::MapNode<int, int>));
+}
+
+namespace
+{
+    // counts copies, node handles must move elements between maps without any
+    struct CopyCounter
+    {
+        static inline int copies = 0;
+        int value;
+
+        CopyCounter(int v) : value(v) {}
+        CopyCounter(const CopyCounter &other) : value(other.value) { ++copies; }
+        CopyCounter &operator=(const CopyCounter &other)
+        {
+            value = other.value;
+            ++copies;
+            return *this;
+        }
+    };
+} // namespace
+
+TEST_F(MapTest, ExtractInsertNodeTest)
+{
+    sd::Map<int, CopyCounter> l = {{1, 10}, {2, 20}, {3, 30}};
+    sd::Map<int, CopyCounter> l2;
+    auto address = &l.at(2);
+    CopyCounter::copies = 0;
+
+    auto handle = l.extract(2);
+
+    EXPECT_FALSE(handle.empty());
+    EXPECT_EQ(handle.key(), 2);
+    EXPECT_EQ(handle.item().value, 20);
+    EXPECT_EQ(l.size(), 2);
+    EXPECT_FALSE(l.contains(2));
+
+    auto [it, inserted] = l2.insert(std::move(handle));
+
+    EXPECT_TRUE(inserted);
+    EXPECT_TRUE(handle.empty());
+    EXPECT_EQ(it->first, 2);
+    EXPECT_EQ(&l2.at(2), address);
+
+    auto byIterator = l.extract(l.find(1));
+    EXPECT_EQ(byIterator.key(), 1);
+    EXPECT_EQ(l.begin()->first, 3);
+    EXPECT_EQ(l.size(), 1);
+
+    EXPECT_THROW(l.extract(7), std::out_of_range);
+    EXPECT_EQ(CopyCounter::copies, 0);
+}
+
+TEST_F(MapTest, InsertNodeDuplicateTest)
+{
+    sd::Map<int, std::string> l = {{1, "one"}, {2, "two"}};
+    sd::Map<int, std::string> l2 = {{1, "uno"}};
+
+    auto handle = l.extract(1);
+    auto [it, inserted] = l2.insert(std::move(handle));
+
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(it->second, "uno");
+    EXPECT_FALSE(handle.empty());
+    EXPECT_EQ(handle.item(), "one");
+
+    EXPECT_TRUE(l.insert(std::move(handle)).second);
+    EXPECT_EQ(l.at(1), "one");
+
+    sd::Map<int, std::string>::NodeHandle empty;
+    EXPECT_FALSE(l.insert(std::move(empty)).second);
+}
+
+TEST_F(MapTest, MergeTest)
+{
+    sd::Map<int, CopyCounter, std::less<int>, sd::HeapNodeAllocator, sd::OrderStatistics> l, l2;
+    for (int i = 0; i < 1000; i += 2)
+    {
+        l.insert({i, i});
+    }
+    for (int i = 0; i < 1000; i += 3)
+    {
+        l2.insert({i, -i});
+    }
+    CopyCounter::copies = 0;
+
+    l.merge(l2);
+
+    EXPECT_EQ(CopyCounter::copies, 0);
+    // multiples of 6 were in both maps and stay in source
+    EXPECT_EQ(l2.size(), 167);
+    EXPECT_EQ(l.size(), 667);
+    for (auto &[key, value] : l2)
+    {
+        EXPECT_EQ(key % 6, 0);
+        EXPECT_EQ(l.at(key).value, key);
+    }
+    size_t index = 0;
+    int previous = -1;
+    for (auto &[key, value] : l)
+    {
+        EXPECT_TRUE(key % 2 == 0 || key % 3 == 0);
+        EXPECT_EQ(value.value, key % 2 == 0 ? key : -key);
+        EXPECT_GT(key, previous);
+        EXPECT_EQ(l.rank(key), index++);
+        previous = key;
+    }
+    EXPECT_EQ(l2.nth(1)->first, 6);
+}
+
+TEST_F(MapTest, MergeIteratorsTest)
+{
+    // iterators to moved elements follow them to destination, as with std::map::merge
+    sd::Map<int, int> dst = {{0, 0}, {10, 10}};
+    sd::Map<int, int> src = {{1, 1}, {3, 3}, {5, 5}, {10, -10}};
+    auto moved = src.find(3);
+    auto kept = src.find(10);
+
+    dst.merge(src);
+
+    std::vector<int> keys;
+    for (auto it = moved; it != dst.end(); ++it)
+    {
+        keys.push_back(it->first);
+    }
+    EXPECT_EQ(keys, (std::vector<int>{3, 5, 10}));
+    EXPECT_EQ(kept->second, -10);
+    EXPECT_EQ(++kept, src.end());
+    EXPECT_EQ(src.size(), 1);
+}
+
+namespace
+{
+    // counts constructions, elements for present keys must not be constructed at all
+    struct ConstructionCounter
+    {
+        static inline int constructions = 0;
+        std::string value;
+
+        ConstructionCounter(std::string v) : value(std::move(v)) { ++constructions; }
+        ConstructionCounter(const ConstructionCounter &other) : value(other.value) { ++constructions; }
+        ConstructionCounter(ConstructionCounter &&other) : value(std::move(other.value)) { ++constructions; }
+    };
+} // namespace
+
+TEST_F(MapTest, EmplaceTest)
+{
+    sd::Map<int, std::unique_ptr<int>> l;
+
+    auto [it, inserted] = l.emplace(1, std::make_unique<int>(10));
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(*it->second, 10);
+
+    EXPECT_TRUE(l.emplace(std::piecewise_construct, std::forward_as_tuple(2), std::forward_as_tuple(new int(20))).second);
+    EXPECT_FALSE(l.emplace(2, std::make_unique<int>(0)).second);
+    EXPECT_TRUE(l.insert({3, std::make_unique<int>(30)}).second);
+
+    EXPECT_EQ(l.size(), 3);
+    EXPECT_EQ(*l.at(2), 20);
+    EXPECT_EQ(*l.at(3), 30);
+}
+
+TEST_F(MapTest, TryEmplaceTest)
+{
+    sd::Map<std::string, ConstructionCounter> l;
+    ConstructionCounter::constructions = 0;
+
+    auto [it, inserted] = l.tryEmplace("one", "1");
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(it->second.value, "1");
+    EXPECT_EQ(ConstructionCounter::constructions, 1);
+
+    std::string key = "one";
+    auto [it2, inserted2] = l.tryEmplace(std::move(key), "other");
+    EXPECT_FALSE(inserted2);
+    EXPECT_EQ(it2, it);
+    EXPECT_EQ(key, "one");
+    EXPECT_EQ(l.at("one").value, "1");
+    EXPECT_EQ(ConstructionCounter::constructions, 1);
+
+    sd::Map<int, std::unique_ptr<int>> ptrs;
+    auto ptr = std::make_unique<int>(5);
+    EXPECT_TRUE(ptrs.tryEmplace(5, std::move(ptr)).second);
+    ptr = std::make_unique<int>(6);
+    EXPECT_FALSE(ptrs.tryEmplace(5, std::move(ptr)).second);
+    EXPECT_TRUE(ptr);
+    EXPECT_EQ(*ptrs.at(5), 5);
+}
+
+TEST_F(MapTest, InsertOrAssignTest)
+{
+    sd::Map<int, std::unique_ptr<int>> l;
+
+    auto [it, inserted] = l.insertOrAssign(1, std::make_unique<int>(1));
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(*it->second, 1);
+
+    auto [it2, inserted2] = l.insertOrAssign(1, std::make_unique<int>(2));
+    EXPECT_FALSE(inserted2);
+    EXPECT_EQ(it2, it);
+    EXPECT_EQ(*l.at(1), 2);
+    EXPECT_EQ(l.size(), 1);
+
+    sd::Map<std::string, std::string> strings;
+    strings.insertOrAssign("key", "first");
+    strings.insertOrAssign("key", "second");
+    EXPECT_EQ(strings.at("key"), "second");
+}
+
+TEST_F(MapTest, InsertHintTest)
+{
+    sd::Map<int, int> l;
+
+    auto it = l.end();
+    for (int i = 0; i < 100; i += 2)
+    {
+        it = l.insert(l.end(), {i, i});
+        EXPECT_EQ(it->first, i);
+    }
+    // hint right after position
+    it = l.insert(l.find(10), {9, 9});
+    EXPECT_EQ(it->first, 9);
+    // hint right before position
+    it = l.insert(l.find(20), {21, 21});
+    EXPECT_EQ(it->first, 21);
+    // hint at begin
+    it = l.emplaceHint(l.begin(), -1, -1);
+    EXPECT_EQ(l.begin(), it);
+    // wrong hint falls back to search
+    it = l.insert(l.begin(), {51, 51});
+    EXPECT_EQ(it->first, 51);
+    it = l.insert(l.end(), {33, 33});
+    EXPECT_EQ(it->first, 33);
+    // present key is not replaced
+    it = l.insert(l.find(40), {40, 0});
+    EXPECT_EQ(it->second, 40);
+    it = l.emplaceHint(l.end(), 41, 41);
+    EXPECT_EQ(it->first, 41);
+
+    EXPECT_EQ(l.size(), 56);
+    int previous = -2;
+    for (auto &[key, value] : l)
+    {
+        EXPECT_GT(key, previous);
+        EXPECT_EQ(key, value);
+        previous = key;
+    }
+    EXPECT_EQ(l.back().first, 98);
+}
+
+TEST_F(MapTest, InsertHintRandomTest)
+{
+    sd::Map<int, int, std::less<int>, sd::HeapNodeAllocator, sd::OrderStatistics> l;
+    std::map<int, int> expected;
+    std::mt19937 gen(7);
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        auto key = int(gen() % 3000);
+        auto hint = l.lowerBound(int(gen() % 3000));
+        if (gen() % 4 == 0)
+        {
+            hint = l.lowerBound(key);
+        }
+        l.insert(hint, {key, i});
+        expected.insert({key, i});
+    }
+
+    EXPECT_EQ(l.size(), expected.size());
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+    size_t index = 0;
+    for (auto &[key, value] : expected)
+    {
+        EXPECT_EQ(l.rank(key), index++);
+    }
+}
+
+TEST_F(MapTest, FindManyTest)
+{
+    sd::Map<int, int> l;
+    for (int i = 0; i < 1000; i += 2)
+    {
+        l.insert({i, i * 10});
+    }
+    std::vector<int> keys;
+    for (int i = -5; i < 1005; i += 3)
+    {
+        keys.push_back(i);
+    }
+    std::vector<sd::Map<int, int>::Iterator> results(keys.size());
+
+    l.findMany(keys, results);
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        EXPECT_EQ(results[i], l.find(keys[i]));
+    }
+    results[3]->second = -1;
+    EXPECT_EQ(l.at(4), -1);
+
+    const auto &constMap = l;
+    std::vector<sd::Map<int, int>::ConstIterator> constResults(keys.size());
+    constMap.findMany(keys, constResults);
+    EXPECT_EQ(constResults[5]->second, 100);
+    EXPECT_EQ(constResults[4], constMap.end());
+
+    EXPECT_THROW(l.findMany(keys, std::span(results).first(3)), std::invalid_argument);
+
+    sd::Map<int, int> empty;
+    empty.findMany(keys, results);
+    EXPECT_EQ(results.back(), empty.end());
+}
+
+namespace
+{
+    std::atomic<size_t> setComparisons = 0;
+
+    struct SetCountingCompare
+    {
+        std::strong_ordering operator()(int lhs, int rhs) const
+        {
+            setComparisons.fetch_add(1, std::memory_order_relaxed);
+            return lhs <=> rhs;
+        }
+    };
+
+    template <class Balance>
+    using BalancedSetMap =
+        sd::Map<int, int, SetCountingCompare, sd::HeapNodeAllocator, sd::OrderStatistics, sd::MapNodeLinks, Balance>;
+    using SetMap = BalancedSetMap<sd::RedBlackBalance>;
+
+    template <class Balance = sd::RedBlackBalance>
+    BalancedSetMap<Balance> makeSetMap(std::map<int, int> &expected, size_t size, int range, unsigned seed)
+    {
+        BalancedSetMap<Balance> map;
+        std::mt19937 gen(seed);
+        while (map.size() < size)
+        {
+            auto key = int(gen() % unsigned(range));
+            map.insert({key, int(seed)});
+            expected.insert({key, int(seed)});
+        }
+        return map;
+    }
+
+    // longest search path allowed by balancing policy, treap height is only expected one so its bound is loose
+    template <class Balance> size_t heightBound(size_t size)
+    {
+        if constexpr (std::is_same_v<Balance, sd::AvlBalance>)
+        {
+            return size_t(1.45 * std::log2(size + 2)) + 1;
+        }
+        else if constexpr (std::is_same_v<Balance, sd::TreapBalance>)
+        {
+            return size_t(4 * std::log2(size + 1)) + 8;
+        }
+        else
+        {
+            return size_t(2 * std::log2(size + 1)) + 1;
+        }
+    }
+
+    // checks content, order statistics and that every lookup stays within height bound of balancing policy
+    template <class Balance> void expectValidSetMap(BalancedSetMap<Balance> &map, const std::map<int, int> &expected)
+    {
+        ASSERT_EQ(map.size(), expected.size());
+        EXPECT_TRUE(std::equal(map.begin(), map.end(), expected.begin(), expected.end()));
+        if (!expected.empty())
+        {
+            EXPECT_EQ(map.front().first, expected.begin()->first);
+            EXPECT_EQ(map.back().first, expected.rbegin()->first);
+        }
+        auto bound = heightBound<Balance>(expected.size());
+        size_t index = 0;
+        for (auto &[key, value] : expected)
+        {
+            setComparisons = 0;
+            EXPECT_EQ(map.at(key), value);
+            EXPECT_LE(setComparisons, bound);
+            EXPECT_EQ(map.rank(key), index++);
+        }
+    }
+
+    struct SetSizes
+    {
+        size_t mine;
+        size_t theirs;
+        int range;
+    };
+
+    const SetSizes setSizes[] = {{0, 100, 200},      {100, 0, 200},      {1, 1, 2},          {1000, 1000, 1500},
+                                 {10, 5000, 10000},  {5000, 10, 10000},  {3000, 4000, 6000}, {20000, 30000, 40000}};
+
+    template <class Balance = sd::RedBlackBalance, class Operation, class Expected>
+    void checkSetOperation(Operation operation, Expected expectedOperation)
+    {
+        unsigned seed = 1;
+        for (auto [mineSize, theirsSize, range] : setSizes)
+        {
+            std::map<int, int> mineExpected, theirsExpected, expected;
+            auto mine = makeSetMap<Balance>(mineExpected, mineSize, range, seed++);
+            auto theirs = makeSetMap<Balance>(theirsExpected, theirsSize, range, seed++);
+            expectedOperation(mineExpected, theirsExpected, expected);
+
+            operation(mine, std::move(theirs));
+
+            EXPECT_TRUE(theirs.empty());
+            expectValidSetMap(mine, expected);
+
+            // tree has to stay valid for regular modifications
+            std::mt19937 gen(seed);
+            for (int i = 0; i < 500; ++i)
+            {
+                auto key = int(gen() % unsigned(range));
+                if (i % 2)
+                {
+                    mine.insert({key, i});
+                    expected.insert({key, i});
+                }
+                else if (mine.contains(key))
+                {
+                    mine.remove(key);
+                    expected.erase(key);
+                }
+            }
+            expectValidSetMap(mine, expected);
+            theirs.insert({1, 1});
+            EXPECT_EQ(theirs.size(), 1);
+        }
+    }
+
+    void expectedUnion(const std::map<int, int> &mine, const std::map<int, int> &theirs, std::map<int, int> &result)
+    {
+        result = mine;
+        result.insert(theirs.begin(), theirs.end());
+    }
+
+    void expectedIntersection(const std::map<int, int> &mine, const std::map<int, int> &theirs,
+                              std::map<int, int> &result)
+    {
+        for (auto &pair : mine)
+        {
+            if (theirs.contains(pair.first))
+            {
+                result.insert(pair);
+            }
+        }
+    }
+
+    void expectedDifference(const std::map<int, int> &mine, const std::map<int, int> &theirs,
+                            std::map<int, int> &result)
+    {
+        for (auto &pair : mine)
+        {
+            if (!theirs.contains(pair.first))
+            {
+                result.insert(pair);
+            }
+        }
+    }
+} // namespace
+
+TEST_F(MapTest, UnionWithTest)
+{
+    checkSetOperation([](SetMap &mine, SetMap &&theirs) { mine.unionWith(std::move(theirs)); }, expectedUnion);
+}
+
+TEST_F(MapTest, IntersectWithTest)
+{
+    checkSetOperation([](SetMap &mine, SetMap &&theirs) { mine.intersectWith(std::move(theirs)); },
+                      expectedIntersection);
+}
+
+TEST_F(MapTest, DifferenceWithTest)
+{
+    checkSetOperation([](SetMap &mine, SetMap &&theirs) { mine.differenceWith(std::move(theirs)); },
+                      expectedDifference);
+}
+
+TEST_F(MapTest, ParallelSetOperationsTest)
+{
+    checkSetOperation([](SetMap &mine, SetMap &&theirs) { mine.unionWith(sd::parallel, std::move(theirs)); },
+                      expectedUnion);
+    checkSetOperation([](SetMap &mine, SetMap &&theirs) { mine.intersectWith(sd::parallel, std::move(theirs)); },
+                      expectedIntersection);
+    checkSetOperation([](SetMap &mine, SetMap &&theirs) { mine.differenceWith(sd::parallel, std::move(theirs)); },
+                      expectedDifference);
+}
+
+TEST_F(MapTest, SplitAtJoinTest)
+{
+    for (size_t size : {0, 1, 2, 100, 5000})
+    {
+        for (int at : {-1, 0, 1, int(size) / 3, int(size) / 2, int(size) - 1, int(size) + 10})
+        {
+            std::map<int, int> expected;
+            auto map = makeSetMap(expected, size, int(size) * 2 + 1, unsigned(size));
+            std::map<int, int> lower(expected.begin(), expected.lower_bound(at));
+            std::map<int, int> upper(expected.lower_bound(at), expected.end());
+
+            auto other = map.splitAt(at);
+
+            expectValidSetMap(map, lower);
+            expectValidSetMap(other, upper);
+
+            map.join(std::move(other));
+
+            EXPECT_TRUE(other.empty());
+            expectValidSetMap(map, expected);
+        }
+    }
+
+    sd::Map<int, int> l = {{1, 1}, {5, 5}};
+    EXPECT_THROW(l.join(sd::Map<int, int>{{5, 5}, {6, 6}}), std::invalid_argument);
+    EXPECT_EQ(l.size(), 2);
+}
+
+TEST_F(MapTest, SetOperationIteratorsTest)
+{
+    // smaller map is relinked to guard of bigger one, its iterators and end iterator stay valid
+    sd::Map<int, int> small = {{100, 100}};
+    sd::Map<int, int> big;
+    for (int i = 0; i < 50; ++i)
+    {
+        big.insert({i, i});
+    }
+    auto smallIt = small.find(100);
+    auto smallEnd = small.end();
+    auto bigIt = big.find(48);
+
+    small.unionWith(std::move(big));
+
+    EXPECT_EQ(small.size(), 51);
+    EXPECT_EQ(++smallIt, small.end());
+    EXPECT_EQ(smallIt, smallEnd);
+    EXPECT_EQ(++bigIt, small.find(49));
+    EXPECT_EQ(std::distance(small.begin(), smallEnd), 51);
+
+    // part staying in map is smaller, so it moves to other guard
+    sd::Map<int, int> l;
+    for (int i = 0; i < 10; ++i)
+    {
+        l.insert({i, i});
+    }
+    auto first = l.begin(), moved = l.find(5), end = l.end();
+
+    auto upper = l.splitAt(2);
+
+    std::vector<int> keys;
+    for (auto it = first; it != end; ++it)
+    {
+        keys.push_back(it->first);
+    }
+    EXPECT_EQ(keys, (std::vector<int>{0, 1}));
+    keys.clear();
+    for (auto it = moved; it != upper.end(); ++it)
+    {
+        keys.push_back(it->first);
+    }
+    EXPECT_EQ(keys, (std::vector<int>{5, 6, 7, 8, 9}));
+    EXPECT_EQ(l.end(), end);
+}
+
+namespace
+{
+    template <class Balance> void checkBalancedRandomInsertRemove()
+    {
+        BalancedSetMap<Balance> l;
+        std::map<int, int> expected;
+        std::mt19937 gen(17);
+
+        // sequential inserts first, worst case of unbalanced tree
+        for (int i = 0; i < 5000; ++i)
+        {
+            l.insert({i, i});
+            expected.insert({i, i});
+        }
+        expectValidSetMap(l, expected);
+
+        for (int i = 0; i < 40000; ++i)
+        {
+            auto key = int(gen() % 20000);
+            if (gen() % 3)
+            {
+                EXPECT_EQ(l.insert({key, i}).second, expected.insert({key, i}).second);
+            }
+            else if (expected.erase(key))
+            {
+                l.remove(key);
+            }
+        }
+        expectValidSetMap(l, expected);
+
+        BalancedSetMap<Balance> copy(l);
+        expectValidSetMap(copy, expected);
+
+        std::vector<std::pair<const int, int>> sorted(expected.begin(), expected.end());
+        BalancedSetMap<Balance> built(sd::sortedUnique, sorted.begin(), sorted.end());
+        expectValidSetMap(built, expected);
+
+        while (!expected.empty())
+        {
+            l.popFront();
+            expected.erase(expected.begin());
+            if (!expected.empty())
+            {
+                l.popBack();
+                expected.erase(std::prev(expected.end()));
+            }
+        }
+        expectValidSetMap(l, expected);
+    }
+
+    template <class Balance> void checkBalancedSetOperations()
+    {
+        using BalancedMap = BalancedSetMap<Balance>;
+        checkSetOperation<Balance>([](BalancedMap &mine, BalancedMap &&theirs) { mine.unionWith(std::move(theirs)); },
+                                   expectedUnion);
+        checkSetOperation<Balance>(
+            [](BalancedMap &mine, BalancedMap &&theirs) { mine.intersectWith(sd::parallel, std::move(theirs)); },
+            expectedIntersection);
+        checkSetOperation<Balance>(
+            [](BalancedMap &mine, BalancedMap &&theirs) { mine.differenceWith(std::move(theirs)); },
+            expectedDifference);
+
+        for (int at : {-1, 0, 700, 2500, 5000})
+        {
+            std::map<int, int> expected;
+            auto map = makeSetMap<Balance>(expected, 2500, 5000, 3);
+            std::map<int, int> lower(expected.begin(), expected.lower_bound(at));
+            std::map<int, int> upper(expected.lower_bound(at), expected.end());
+
+            auto other = map.splitAt(at);
+
+            expectValidSetMap(map, lower);
+            expectValidSetMap(other, upper);
+
+            map.join(std::move(other));
+            expectValidSetMap(map, expected);
+        }
+    }
+} // namespace
+
+TEST_F(MapTest, AvlBalanceTest)
+{
+    checkBalancedRandomInsertRemove<sd::AvlBalance>();
+    checkBalancedSetOperations<sd::AvlBalance>();
+}
+
+TEST_F(MapTest, WavlBalanceTest)
+{
+    checkBalancedRandomInsertRemove<sd::WavlBalance>();
+    checkBalancedSetOperations<sd::WavlBalance>();
+}
+
+TEST_F(MapTest, TreapBalanceTest)
+{
+    checkBalancedRandomInsertRemove<sd::TreapBalance>();
+    checkBalancedSetOperations<sd::TreapBalance>();
+
+    // treap keeps no balance data, so it fits compact links
+    using CompactTreap = sd::Map<int, int, std::less<int>, sd::PoolNodeAllocator, sd::NoAugmentation,
+                                 sd::CompactMapNodeLinks, sd::TreapBalance>;
+    CompactTreap l;
+    std::map<int, int> expected;
+    std::mt19937 gen(5);
+    for (int i = 0; i < 20000; ++i)
+    {
+        auto key = int(gen() % 3000);
+        if (gen() % 3)
+        {
+            EXPECT_EQ(l.insert({key, i}).second, expected.insert({key, i}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+    }
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+    EXPECT_TRUE(std::equal(l.rBegin(), l.rEnd(), expected.rbegin(), expected.rend()));
+}
+
+TEST_F(MapTest, IntervalMapQueryTest)
+{
+    sd::IntervalMap<int, std::string> l;
+    l.insert({{1, 5}, "a"});
+    l.insert({{3, 3}, "b"});
+    l.insert({{6, 10}, "c"});
+    l.insert({{8, 9}, "d"});
+    l.insert({{-4, 0}, "e"});
+
+    std::vector<std::string> found;
+    l.visitOverlapping(5, 7, [&](auto &item) { found.push_back(item.second); });
+    EXPECT_EQ(found, (std::vector<std::string>{"a", "c"}));
+
+    found.clear();
+    l.visitStabbing(3, [&](auto &item) { found.push_back(item.second); });
+    EXPECT_EQ(found, (std::vector<std::string>{"a", "b"}));
+
+    found.clear();
+    l.visitOverlapping(11, 20, [&](auto &item) { found.push_back(item.second); });
+    EXPECT_TRUE(found.empty());
+
+    // visitor returning false stops query
+    found.clear();
+    l.visitOverlapping(-10, 20, [&](auto &item) {
+        found.push_back(item.second);
+        return found.size() < 2;
+    });
+    EXPECT_EQ(found, (std::vector<std::string>{"e", "a"}));
+
+    const auto &constMap = l;
+    found.clear();
+    constMap.visitStabbing(8, [&](const auto &item) { found.push_back(item.second); });
+    EXPECT_EQ(found, (std::vector<std::string>{"c", "d"}));
+    l.visitStabbing(9, [](auto &item) { item.second += "!"; });
+    EXPECT_EQ((l[{8, 9}]), "d!");
+}
+
+TEST_F(MapTest, IntervalMapRandomTest)
+{
+    using Intervals = sd::IntervalMap<int, int>;
+    Intervals l;
+    std::map<sd::Interval<int>, int> expected;
+    std::mt19937 gen(2024);
+
+    auto check = [&](const Intervals &map, const std::map<sd::Interval<int>, int> &items) {
+        for (int query = 0; query < 20; ++query)
+        {
+            int low = int(gen() % 1100) - 50;
+            int high = low + int(gen() % (query % 2 ? 5 : 200));
+            std::vector<sd::Interval<int>> found, wanted;
+            map.visitOverlapping(low, high, [&](auto &item) { found.push_back(item.first); });
+            for (auto &[interval, value] : items)
+            {
+                if (interval.low <= high && low <= interval.high)
+                {
+                    wanted.push_back(interval);
+                }
+            }
+            ASSERT_EQ(found, wanted);
+        }
+    };
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        int low = int(gen() % 1000);
+        sd::Interval<int> interval{low, low + int(gen() % (i % 10 ? 20 : 300))};
+        if (gen() % 3)
+        {
+            l.insert({interval, i});
+            expected.insert({interval, i});
+        }
+        else if (!expected.empty())
+        {
+            auto victim = std::next(expected.begin(), gen() % expected.size());
+            l.remove(victim->first);
+            expected.erase(victim);
+        }
+        if (i % 250 == 0)
+        {
+            check(l, expected);
+        }
+    }
+    check(l, expected);
+
+    // join and split keep endpoints up to date too
+    auto upper = l.splitAt({500, 0});
+    check(l, std::map<sd::Interval<int>, int>(expected.begin(), expected.lower_bound({500, 0})));
+    check(upper, std::map<sd::Interval<int>, int>(expected.lower_bound({500, 0}), expected.end()));
+    l.join(std::move(upper));
+    check(l, expected);
+
+    Intervals copy(l);
+    check(copy, expected);
+}
+
+TEST_F(MapTest, ParallelForEachTest)
+{
+    std::vector<std::pair<const int, int>> pairs;
+    for (int i = 0; i < 100000; ++i)
+    {
+        pairs.emplace_back(i, 0);
+    }
+    sd::Map<int, int> l(sd::sortedUnique, pairs.begin(), pairs.end());
+
+    for (size_t threads : {0, 1, 2, 3, 8})
+    {
+        l.parallelForEach([](auto &item) { item.second += item.first % 7; }, threads);
+    }
+    std::atomic<long long> sum = 0;
+    std::atomic<size_t> visited = 0;
+    const auto &constMap = l;
+    constMap.parallelForEach(
+        [&](const auto &item) {
+            EXPECT_EQ(item.second, 5 * (item.first % 7));
+            sum += item.first;
+            ++visited;
+        },
+        4);
+
+    EXPECT_EQ(visited, l.size());
+    EXPECT_EQ(sum, 100000ll * 99999 / 2);
+
+    EXPECT_THROW(l.parallelForEach(
+                     [](auto &item) {
+                         if (item.first == 777)
+                         {
+                             throw std::runtime_error("stop");
+                         }
+                     },
+                     4),
+                 std::runtime_error);
+}
+
+TEST_F(MapTest, ParallelReduceTest)
+{
+    sd::Map<int, int> l;
+    std::mt19937 gen(17);
+    long long expectedSum = 0;
+    while (l.size() < 50000)
+    {
+        auto key = int(gen() % 1000000);
+        if (l.insert({key, key % 100}).second)
+        {
+            expectedSum += key % 100;
+        }
+    }
+
+    for (size_t threads : {0, 1, 2, 5, 16})
+    {
+        auto sum = l.parallelReduce(
+            10ll, [](auto &item) { return (long long)item.second; }, std::plus<>{}, threads);
+        EXPECT_EQ(sum, expectedSum + 10);
+
+        // combine is associative but not commutative, order of keys has to be kept
+        using Range = std::pair<int, int>;
+        auto range = l.parallelReduce(
+            Range{-1, -1}, [](auto &item) { return Range{item.first, item.first}; },
+            [](Range lhs, Range rhs) {
+                EXPECT_LT(lhs.second, rhs.first);
+                return Range{lhs.first, rhs.second};
+            },
+            threads);
+        EXPECT_EQ(range, (Range{-1, l.back().first}));
+    }
+
+    sd::Map<int, int> empty;
+    EXPECT_EQ(empty.parallelReduce(3, [](auto &item) { return item.second; }, std::plus<>{}, 4), 3);
+}
+
+TEST_F(MapTest, StatsTest)
+{
+    using StatsMap = sd::Map<int, int, std::less<int>, sd::HeapNodeAllocator, sd::NoAugmentation, sd::MapNodeLinks,
+                             sd::RedBlackBalance, sd::MapStats>;
+    StatsMap l;
+    for (int i = 0; i < 1000; ++i)
+    {
+        l.insert({i, i});
+    }
+
+    auto stats = l.stats();
+    EXPECT_EQ(stats.operations, 1000);
+    EXPECT_GT(stats.comparisons, 1000);
+    EXPECT_GT(stats.rotations, 0);
+    EXPECT_GT(stats.recolorings, 0);
+    EXPECT_EQ(stats.size, 1000);
+    auto shape = l.checkShape();
+    EXPECT_LE(shape.height, 2 * std::log2(1001.0));
+    EXPECT_GT(shape.blackHeight, 0);
+    EXPECT_TRUE(shape.balanced);
+    EXPECT_LE(stats.maxOperationVisits, shape.height);
+    // stats report shape without walking whole tree
+    EXPECT_EQ(stats.height, stats.maxOperationVisits);
+    EXPECT_GT(stats.height, 0);
+    EXPECT_EQ(stats.blackHeight, shape.blackHeight);
+
+    l.resetStats();
+    EXPECT_EQ(l.stats().comparisons, 0);
+    EXPECT_EQ(l.stats().size, 1000);
+
+    // lookup visits nodes on path to key and compares key once on each of them
+    EXPECT_EQ(l.at(500), 500);
+    stats = l.stats();
+    EXPECT_EQ(stats.operations, 1);
+    EXPECT_EQ(stats.nodeVisits, stats.comparisons);
+    EXPECT_EQ(stats.maxOperationVisits, stats.nodeVisits);
+    EXPECT_EQ(stats.rotations, 0);
+
+    for (int i = 0; i < 1000; i += 2)
+    {
+        l.remove(i);
+    }
+    stats = l.stats();
+    EXPECT_EQ(stats.operations, 501);
+    EXPECT_GT(stats.recolorings, 0);
+    shape = l.checkShape();
+    EXPECT_TRUE(shape.balanced);
+
+    // copy counts its own work
+    StatsMap copy(l);
+    EXPECT_EQ(copy.stats().operations, 0);
+    EXPECT_EQ(copy.stats().height, 0);
+    EXPECT_EQ(copy.checkShape().blackHeight, shape.blackHeight);
+    EXPECT_EQ(copy.stats().blackHeight, shape.blackHeight);
+
+    // nodes move between maps with different stats policies
+    sd::Map<int, int> plain = {{-1, 1}};
+    copy.merge(plain);
+    EXPECT_TRUE(copy.contains(-1));
+    EXPECT_TRUE(plain.empty());
+}
+
+TEST_F(MapTest, StatsShapeTest)
+{
+    // without stats policy only size is reported, shape is measured on request
+    sd::Map<int, int> l;
+    EXPECT_EQ(l.checkShape().height, 0);
+    EXPECT_TRUE(l.checkShape().balanced);
+    for (int i = 0; i < 100; ++i)
+    {
+        l.insert({i, i});
+    }
+    auto stats = l.stats();
+    EXPECT_EQ(stats.comparisons, 0);
+    EXPECT_EQ(stats.operations, 0);
+    EXPECT_EQ(stats.size, 100);
+    auto shape = l.checkShape();
+    EXPECT_GE(shape.height, 7);
+    EXPECT_TRUE(shape.balanced);
+    EXPECT_EQ(stats.height, 0);
+    EXPECT_EQ(stats.blackHeight, shape.blackHeight);
+
+    // black height follows joins and splits of set operations
+    sd::Map<int, int> other;
+    for (int i = 50; i < 5000; ++i)
+    {
+        other.insert({i, i});
+    }
+    l.unionWith(std::move(other));
+    auto upper = l.splitAt(2500);
+    EXPECT_EQ(l.stats().blackHeight, l.checkShape().blackHeight);
+    EXPECT_EQ(upper.stats().blackHeight, upper.checkShape().blackHeight);
+
+    using AvlStatsMap = sd::Map<int, int, std::less<int>, sd::HeapNodeAllocator, sd::NoAugmentation,
+                                sd::MapNodeLinks, sd::AvlBalance, sd::MapStats>;
+    AvlStatsMap avl;
+    for (int i = 0; i < 100; ++i)
+    {
+        avl.insert({i, i});
+    }
+    stats = avl.stats();
+    EXPECT_GT(stats.rotations, 0);
+    EXPECT_EQ(stats.recolorings, 0);
+    EXPECT_EQ(stats.blackHeight, 0);
+    EXPECT_GT(stats.height, 0);
+    shape = avl.checkShape();
+    EXPECT_EQ(shape.blackHeight, 0);
+    EXPECT_EQ(shape.height, 7);
+}
+
+TEST_F(MapTest, EraseIteratorTest)
+{
+    sd::Map<int, int> l;
+    for (int i = 0; i < 10; ++i)
+    {
+        l.insert({i, i * 10});
+    }
+    auto kept = l.find(7);
+
+    auto it = l.erase(l.find(3));
+    EXPECT_EQ(it->first, 4);
+    EXPECT_FALSE(l.contains(3));
+    EXPECT_EQ(l.size(), 9);
+
+    // erasing last element returns end
+    EXPECT_EQ(l.erase(l.find(9)), l.end());
+    EXPECT_EQ(l.back().second, 80);
+
+    // range erase stops before last, iterators to other elements stay valid
+    it = l.erase(l.find(1), l.find(6));
+    EXPECT_EQ(it->first, 6);
+    EXPECT_EQ(kept->second, 70);
+    std::vector<int> keys;
+    for (auto &[key, item] : l)
+    {
+        keys.push_back(key);
+    }
+    EXPECT_EQ(keys, (std::vector<int>{0, 6, 7, 8}));
+
+    EXPECT_EQ(l.erase(l.find(6), l.find(6)), l.find(6));
+    EXPECT_EQ(l.erase(l.begin(), l.end()), l.end());
+    EXPECT_TRUE(l.empty());
+    l.insert({1, 1});
+    EXPECT_EQ(l.front().first, 1);
+}
+
+TEST_F(MapTest, EraseIfTest)
+{
+    std::mt19937 gen(11);
+    sd::Map<int, int> l;
+    using AvlMap = sd::Map<int, int, std::less<int>, sd::HeapNodeAllocator, sd::NoAugmentation, sd::MapNodeLinks,
+                           sd::AvlBalance, sd::MapStats>;
+    AvlMap avl;
+    std::map<int, int> expected;
+    for (int i = 0; i < 5000; ++i)
+    {
+        auto key = int(gen() % 20000);
+        l.insert({key, i});
+        avl.insert({key, i});
+        expected.insert({key, i});
+    }
+
+    // expire entries with odd timestamps, as ttl sweep does
+    auto expired = [](const std::pair<const int, int> &pair) { return pair.second % 2 == 1; };
+    auto removed = std::erase_if(expected, expired);
+    EXPECT_EQ(l.eraseIf(expired), removed);
+    avl.resetStats();
+    EXPECT_EQ(avl.eraseIf(expired), removed);
+
+    ASSERT_EQ(l.size(), expected.size());
+    EXPECT_TRUE(std::equal(l.begin(), l.end(), expected.begin()));
+    EXPECT_TRUE(std::equal(avl.begin(), avl.end(), expected.begin()));
+    EXPECT_TRUE(l.checkShape().balanced);
+    // whole sweep is one operation which compares no keys
+    auto stats = avl.stats();
+    EXPECT_EQ(stats.operations, 1);
+    EXPECT_EQ(stats.comparisons, 0);
+    EXPECT_LE(avl.checkShape().height, 1.45 * std::log2(stats.size + 2));
+
+    EXPECT_EQ(l.eraseIf([](auto &) { return false; }), 0);
+    EXPECT_EQ(l.eraseIf([](auto &) { return true; }), expected.size());
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(l.begin(), l.end());
+}
@@ -0,0 +1,193 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Map.hpp"
+#include "MappedMap.hpp"
+
+class MappedMapTest : public ::testing::Test
+{
+  protected:
+    std::string path;
+
+    static void SetUpTestSuite() {}
+
+    MappedMapTest() {}
+
+    void SetUp() override
+    {
+        auto name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        path = (std::filesystem::temp_directory_path() / (std::string("MappedMapTest_") + name + ".snap")).string();
+    }
+
+    void TearDown() override { std::filesystem::remove(path); }
+
+    ~MappedMapTest() {}
+
+    static void TearDownTestSuite() {}
+};
+
+namespace
+{
+    struct Point
+    {
+        int x;
+        double y;
+    };
+
+    template <class Mapped, class Expected> void expectSameItems(const Mapped &mapped, const Expected &expected)
+    {
+        ASSERT_EQ(mapped.size(), expected.size());
+        auto it = mapped.begin();
+        for (auto &[key, value] : expected)
+        {
+            ASSERT_NE(it, mapped.end());
+            EXPECT_EQ(it->first, key);
+            EXPECT_EQ(it->second, value);
+            ++it;
+        }
+        EXPECT_EQ(it, mapped.end());
+    }
+} // namespace
+
+TEST_F(MappedMapTest, RoundTripTest)
+{
+    sd::Map<int, Point> l = {{3, {3, 0.5}}, {1, {1, 1.5}}, {2, {2, 2.5}}};
+    l.saveSnapshot(path);
+
+    auto mapped = sd::MappedMap<int, Point>::open(path);
+    EXPECT_EQ(mapped.size(), 3);
+    EXPECT_EQ(mapped.at(2).x, 2);
+    EXPECT_EQ(mapped[3].y, 0.5);
+    EXPECT_THROW(mapped.at(4), std::out_of_range);
+    EXPECT_TRUE(mapped.contains(1));
+    EXPECT_FALSE(mapped.contains(0));
+    EXPECT_EQ(mapped.find(5), mapped.end());
+    EXPECT_EQ(mapped.begin()->first, 1);
+    EXPECT_EQ(mapped.rBegin()->first, 3);
+}
+
+TEST_F(MappedMapTest, EmptyTest)
+{
+    sd::Map<int, int> l;
+    l.saveSnapshot(path);
+
+    auto mapped = sd::MappedMap<int, int>::open(path);
+    EXPECT_TRUE(mapped.empty());
+    EXPECT_EQ(mapped.begin(), mapped.end());
+    EXPECT_FALSE(mapped.contains(1));
+    EXPECT_EQ(mapped.lowerBound(1), mapped.end());
+
+    sd::MappedMap<int, int> unmapped;
+    EXPECT_TRUE(unmapped.empty());
+    EXPECT_FALSE(unmapped.contains(1));
+}
+
+TEST_F(MappedMapTest, LookupTest)
+{
+    // sizes around block boundaries and with several index levels
+    for (int size : {1, 15, 16, 17, 255, 256, 257, 4096, 70001})
+    {
+        sd::Map<int64_t, int> l;
+        std::map<int64_t, int> expected;
+        for (int i = 0; i < size; ++i)
+        {
+            l.insert({int64_t(i) * 3, i});
+            expected.insert({int64_t(i) * 3, i});
+        }
+        l.saveSnapshot(path);
+
+        auto mapped = sd::MappedMap<int64_t, int>::open(path);
+        expectSameItems(mapped, expected);
+        for (int64_t key = -2; key < int64_t(size) * 3 + 2; ++key)
+        {
+            auto lower = expected.lower_bound(key);
+            auto upper = expected.upper_bound(key);
+            ASSERT_EQ(mapped.contains(key), expected.contains(key)) << size << " " << key;
+            ASSERT_EQ(mapped.lowerBound(key) == mapped.end(), lower == expected.end()) << size << " " << key;
+            ASSERT_EQ(mapped.upperBound(key) == mapped.end(), upper == expected.end()) << size << " " << key;
+            if (lower != expected.end())
+            {
+                ASSERT_EQ(mapped.lowerBound(key)->first, lower->first);
+            }
+            if (upper != expected.end())
+            {
+                ASSERT_EQ(mapped.upperBound(key)->first, upper->first);
+            }
+        }
+    }
+}
+
+TEST_F(MappedMapTest, RangeTest)
+{
+    sd::Map<uint64_t, uint64_t> l;
+    std::mt19937_64 gen(5);
+    std::map<uint64_t, uint64_t> expected;
+    for (int i = 0; i < 10000; ++i)
+    {
+        auto key = gen() % 1000000;
+        l.insert({key, key * 2});
+        expected.insert({key, key * 2});
+    }
+    l.saveSnapshot(path);
+    auto mapped = sd::MappedMap<uint64_t, uint64_t>::open(path);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        auto low = gen() % 1000000, high = low + gen() % 50000;
+        std::vector<std::pair<uint64_t, uint64_t>> found, wanted;
+        for (auto [key, value] : mapped.range(low, high))
+        {
+            found.emplace_back(key, value);
+        }
+        for (auto it = expected.lower_bound(low); it != expected.lower_bound(high); ++it)
+        {
+            wanted.emplace_back(*it);
+        }
+        EXPECT_EQ(found, wanted);
+    }
+    EXPECT_TRUE(mapped.range(10, 10).empty());
+    ASSERT_EQ(mapped.keys().size(), expected.size());
+    EXPECT_TRUE(std::equal(mapped.keys().begin(), mapped.keys().end(), expected.begin(),
+                           [](auto key, auto &pair) { return key == pair.first; }));
+}
+
+TEST_F(MappedMapTest, MoveTest)
+{
+    sd::Map<int, int> l = {{1, 10}, {2, 20}};
+    l.saveSnapshot(path);
+
+    auto mapped = sd::MappedMap<int, int>::open(path);
+    sd::MappedMap<int, int> moved(std::move(mapped));
+    EXPECT_TRUE(mapped.empty());
+    EXPECT_EQ(moved.at(2), 20);
+
+    mapped = std::move(moved);
+    EXPECT_EQ(mapped.at(1), 10);
+    EXPECT_TRUE(moved.empty());
+}
+
+TEST_F(MappedMapTest, InvalidFileTest)
+{
+    EXPECT_THROW((sd::MappedMap<int, int>::open(path)), std::runtime_error);
+
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "not a snapshot";
+    }
+    EXPECT_THROW((sd::MappedMap<int, int>::open(path)), std::runtime_error);
+
+    sd::Map<int, int> l = {{1, 10}, {2, 20}};
+    l.saveSnapshot(path);
+    EXPECT_THROW((sd::MappedMap<int64_t, int>::open(path)), std::runtime_error);
+    EXPECT_THROW((sd::MappedMap<int, double>::open(path)), std::runtime_error);
+
+    // truncated file
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    EXPECT_THROW((sd::MappedMap<int, int>::open(path)), std::runtime_error);
+}
@@ -0,0 +1,257 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PersistentMap.hpp"
+
+class PersistentMapTest : public ::testing::Test
+{
+  protected:
+    static void SetUpTestSuite() {}
+
+    PersistentMapTest() {}
+
+    void SetUp() override {}
+
+    void TearDown() override {}
+
+    ~PersistentMapTest() {}
+
+    static void TearDownTestSuite() {}
+};
+
+namespace
+{
+    // counts living items, every node has to be freed once no version uses it
+    struct LiveCounter
+    {
+        static inline int alive = 0;
+        // number of copies which succeed before one throws, negative never throws
+        static inline int copiesBeforeThrow = -1;
+        int value;
+
+        LiveCounter(int v) : value(v) { ++alive; }
+        LiveCounter(const LiveCounter &other) : value(other.value)
+        {
+            if (copiesBeforeThrow >= 0 && copiesBeforeThrow-- == 0)
+            {
+                throw std::runtime_error("Copy failed");
+            }
+            ++alive;
+        }
+        ~LiveCounter() { --alive; }
+
+        bool operator==(const LiveCounter &other) const { return value == other.value; }
+    };
+} // namespace
+
+TEST_F(PersistentMapTest, InsertTest)
+{
+    sd::PersistentMap<int, std::string> empty;
+    auto one = empty.insert({1, "one"});
+    auto two = one.insert({2, "two"});
+    auto same = two.insert({2, "other"});
+
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(one.size(), 1);
+    EXPECT_EQ(two.size(), 2);
+    EXPECT_FALSE(one.contains(2));
+    EXPECT_EQ(two.at(1), "one");
+    EXPECT_EQ(two.at(2), "two");
+    EXPECT_TRUE(same.sharesTree(two));
+    EXPECT_THROW(one.at(2), std::out_of_range);
+}
+
+TEST_F(PersistentMapTest, InsertOrAssignTest)
+{
+    sd::PersistentMap<int, std::string> l = {{1, "one"}, {2, "two"}};
+
+    auto assigned = l.insertOrAssign(2, "dwa");
+    auto added = assigned.insertOrAssign(3, "trzy");
+
+    EXPECT_EQ(l.at(2), "two");
+    EXPECT_EQ(assigned.at(2), "dwa");
+    EXPECT_EQ(assigned.size(), 2);
+    EXPECT_EQ(added.size(), 3);
+    EXPECT_EQ(added.at(3), "trzy");
+}
+
+TEST_F(PersistentMapTest, RemoveTest)
+{
+    sd::PersistentMap<int, int> l = {{1, 10}, {2, 20}, {3, 30}};
+
+    auto removed = l.remove(2);
+
+    EXPECT_EQ(removed.size(), 2);
+    EXPECT_FALSE(removed.contains(2));
+    EXPECT_TRUE(l.contains(2));
+    EXPECT_EQ(l.size(), 3);
+    EXPECT_THROW(removed.remove(2), std::out_of_range);
+    EXPECT_TRUE(removed.remove(1).remove(3).empty());
+}
+
+TEST_F(PersistentMapTest, IterationTest)
+{
+    sd::PersistentMap<int, int> l;
+    for (int i = 99; i >= 0; --i)
+    {
+        l = l.insert({i, i * 2});
+    }
+
+    int expected = 0;
+    for (auto &[key, value] : l)
+    {
+        EXPECT_EQ(key, expected);
+        EXPECT_EQ(value, expected * 2);
+        ++expected;
+    }
+    EXPECT_EQ(expected, 100);
+
+    auto it = l.find(50);
+    EXPECT_EQ(it->second, 100);
+    EXPECT_EQ((++it)->first, 51);
+    EXPECT_EQ(l.find(200), l.end());
+    EXPECT_EQ(l.lowerBound(-5)->first, 0);
+    EXPECT_EQ(l.lowerBound(1000), l.end());
+    EXPECT_EQ(l, l.remove(5).insert({5, 10}));
+    EXPECT_NE(l, l.remove(5));
+}
+
+TEST_F(PersistentMapTest, VersionsRandomTest)
+{
+    LiveCounter::alive = 0;
+    {
+        std::vector<sd::PersistentMap<int, LiveCounter>> versions(1);
+        std::vector<std::map<int, LiveCounter>> expected(1);
+        std::mt19937 gen(5);
+
+        for (int i = 0; i < 3000; ++i)
+        {
+            // every version is built from random older one, so trees share subtrees in many ways
+            auto base = gen() % versions.size();
+            auto key = int(gen() % 500);
+            auto version = versions[base];
+            auto expectedVersion = expected[base];
+            if (gen() % 3 == 0 && version.contains(key))
+            {
+                version = version.remove(key);
+                expectedVersion.erase(key);
+            }
+            else
+            {
+                version = version.insertOrAssign(key, i);
+                expectedVersion.insert_or_assign(key, i);
+            }
+            versions.push_back(version);
+            expected.push_back(expectedVersion);
+            if (versions.size() > 50)
+            {
+                auto dropped = gen() % versions.size();
+                versions.erase(versions.begin() + dropped);
+                expected.erase(expected.begin() + dropped);
+            }
+        }
+
+        for (size_t i = 0; i < versions.size(); ++i)
+        {
+            EXPECT_EQ(versions[i].size(), expected[i].size());
+            EXPECT_TRUE(std::equal(versions[i].begin(), versions[i].end(), expected[i].begin(), expected[i].end()));
+        }
+        versions.clear();
+        expected.clear();
+    }
+    EXPECT_EQ(LiveCounter::alive, 0);
+}
+
+TEST_F(PersistentMapTest, AtomicSnapshotTest)
+{
+    const int versions = 2000;
+    const int keys = 64;
+    sd::AtomicPersistentMap<int, int> published;
+    std::atomic<bool> done = false;
+
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < 4; ++reader)
+    {
+        readers.emplace_back([&] {
+            int previous = -1;
+            while (!done)
+            {
+                // writer keeps all items equal to version number, snapshot must never mix two versions
+                auto snapshot = published.load();
+                if (snapshot.empty())
+                {
+                    continue;
+                }
+                auto version = snapshot.at(0);
+                EXPECT_GE(version, previous);
+                previous = version;
+                for (auto &[key, value] : snapshot)
+                {
+                    EXPECT_EQ(value, version);
+                }
+                published.read([&](const sd::PersistentMap<int, int> &current) {
+                    EXPECT_EQ(current.size(), size_t(keys));
+                    EXPECT_GE(current.at(keys - 1), version);
+                });
+            }
+        });
+    }
+
+    auto version = published.load();
+    for (int key = 0; key < keys; ++key)
+    {
+        version = version.insert({key, 0});
+    }
+    published.store(version);
+    for (int i = 1; i < versions; ++i)
+    {
+        for (int key = 0; key < keys; ++key)
+        {
+            version = version.insertOrAssign(key, i);
+        }
+        published.store(version);
+    }
+    done = true;
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(published.load().at(keys / 2), versions - 1);
+}
+
+TEST_F(PersistentMapTest, ThrowingCopyDuringRotationTest)
+{
+    // inserting 2 into {3, 1} or {1, 3} needs double rotation, each copy of item is made to throw in turn
+    for (auto [first, second] : {std::pair{3, 1}, std::pair{1, 3}})
+    {
+        for (int copies = 0; copies < 8; ++copies)
+        {
+            {
+                auto map = sd::PersistentMap<int, LiveCounter>{}.insert({first, first}).insert({second, second});
+                std::pair<const int, LiveCounter> value{2, 2};
+                LiveCounter::copiesBeforeThrow = copies;
+                try
+                {
+                    auto next = map.insert(value);
+                    LiveCounter::copiesBeforeThrow = -1;
+                    EXPECT_EQ(next.size(), 3);
+                    EXPECT_EQ(next.at(2).value, 2);
+                }
+                catch (const std::runtime_error &)
+                {
+                    LiveCounter::copiesBeforeThrow = -1;
+                }
+                EXPECT_EQ(map.size(), 2);
+                EXPECT_FALSE(map.contains(2));
+                EXPECT_EQ(map.at(first).value, first);
+            }
+            EXPECT_EQ(LiveCounter::alive, 0) << first << " " << copies;
+        }
+    }
+}
@@ -0,0 +1,309 @@
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "RadixMap.hpp"
+
+class RadixMapTest : public ::testing::Test
+{
+  protected:
+    static void SetUpTestSuite() {}
+
+    RadixMapTest() {}
+
+    void SetUp() override {}
+
+    void TearDown() override {}
+
+    ~RadixMapTest() {}
+
+    static void TearDownTestSuite() {}
+};
+
+namespace
+{
+    template <class Map, class Expected> void expectSameItems(const Map &map, const Expected &expected)
+    {
+        ASSERT_EQ(map.size(), expected.size());
+        EXPECT_TRUE(std::equal(map.begin(), map.end(), expected.begin(), expected.end()));
+        EXPECT_TRUE(std::equal(map.rBegin(), map.rEnd(), expected.rbegin(), expected.rend()));
+    }
+
+    // long shared prefixes, keys being prefixes of other keys and bytes above 127
+    std::string makeUrl(std::mt19937 &gen)
+    {
+        static const std::vector<std::string> hosts = {"https://example.com/", "https://example.com/api/v1/",
+                                                       "https://example.org/", "http://a.b/", "http://a.b/\xff"};
+        auto url = hosts[gen() % hosts.size()];
+        for (auto length = gen() % 4; length > 0; --length)
+        {
+            url += char('a' + gen() % 3);
+        }
+        return url;
+    }
+} // namespace
+
+TEST_F(RadixMapTest, InsertTest)
+{
+    sd::RadixMap<int, std::string> l;
+
+    EXPECT_TRUE(l.insert({2, "two"}).second);
+    EXPECT_TRUE(l.insert({1, "one"}).second);
+    EXPECT_TRUE(l.insert({3, "three"}).second);
+    EXPECT_FALSE(l.insert({2, "other"}).second);
+
+    EXPECT_EQ(l.size(), 3);
+    EXPECT_EQ(l[1], "one");
+    EXPECT_EQ(l[2], "two");
+    EXPECT_EQ(l[3], "three");
+    EXPECT_THROW(l.at(4), std::out_of_range);
+
+    auto [it, inserted] = l.insert({-5, "minus five"});
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(it->second, "minus five");
+    EXPECT_EQ(l.begin()->first, -5);
+}
+
+TEST_F(RadixMapTest, FindTest)
+{
+    sd::RadixMap<int, int> l = {{1, 10}, {3, 30}, {1 << 20, 50}};
+
+    EXPECT_EQ(l.find(3)->second, 30);
+    EXPECT_EQ(l.find(1 << 20)->second, 50);
+    EXPECT_EQ(l.find(4), l.end());
+    EXPECT_FALSE(l.find((1 << 20) + 3));
+    EXPECT_TRUE(l.contains(1));
+    EXPECT_FALSE(l.contains(0));
+}
+
+TEST_F(RadixMapTest, RemoveTest)
+{
+    sd::RadixMap<int, int> l = {{1, 10}, {2, 20}, {3, 30}};
+
+    l.remove(2);
+    EXPECT_THROW(l.remove(2), std::out_of_range);
+
+    EXPECT_EQ(l.size(), 2);
+    EXPECT_FALSE(l.contains(2));
+
+    l.remove(1);
+    l.remove(3);
+
+    EXPECT_TRUE(l.empty());
+    EXPECT_EQ(l.begin(), l.end());
+
+    l.insert({2, 22});
+    EXPECT_EQ(l[2], 22);
+}
+
+TEST_F(RadixMapTest, IterationTest)
+{
+    sd::RadixMap<int, int> l;
+    std::map<int, int> expected;
+    for (int i = 1000; i >= -1000; i -= 3)
+    {
+        l.insert({i, i * 2});
+        expected.insert({i, i * 2});
+    }
+
+    expectSameItems(l, expected);
+
+    auto it = l.find(-2);
+    EXPECT_EQ((++it)->first, 1);
+    EXPECT_EQ((--it)->first, -2);
+}
+
+TEST_F(RadixMapTest, LowerUpperBoundTest)
+{
+    sd::RadixMap<int, int> l;
+    for (int i = 0; i < 1000; i += 10)
+    {
+        l.insert({i * 1000, i});
+    }
+
+    EXPECT_EQ(l.lowerBound(-5)->first, 0);
+    EXPECT_EQ(l.lowerBound(0)->first, 0);
+    EXPECT_EQ(l.lowerBound(1)->first, 10000);
+    EXPECT_EQ(l.upperBound(10000)->first, 20000);
+    EXPECT_EQ(l.lowerBound(985000)->first, 990000);
+    EXPECT_EQ(l.lowerBound(990001), l.end());
+    EXPECT_EQ(l.upperBound(990000), l.end());
+}
+
+TEST_F(RadixMapTest, StringPrefixKeysTest)
+{
+    // keys ending inside other keys are kept in inner nodes
+    sd::RadixMap<std::string, int> l = {{"abc", 3}, {"", 0}, {"ab", 2}, {"abd", 4}, {"a", 1}, {"b", 5}};
+    std::map<std::string, int> expected = {{"abc", 3}, {"", 0}, {"ab", 2}, {"abd", 4}, {"a", 1}, {"b", 5}};
+
+    expectSameItems(l, expected);
+    EXPECT_EQ(l.at(""), 0);
+    EXPECT_EQ(l.lowerBound("aa")->first, "ab");
+    EXPECT_EQ(l.lowerBound("abca")->first, "abd");
+    EXPECT_FALSE(l.contains("abcd"));
+
+    l.remove("ab");
+    l.remove("");
+    expected.erase("ab");
+    expected.erase("");
+    expectSameItems(l, expected);
+
+    l.remove("abc");
+    l.remove("abd");
+    expected.erase("abc");
+    expected.erase("abd");
+    expectSameItems(l, expected);
+}
+
+TEST_F(RadixMapTest, PrefixRangeTest)
+{
+    sd::RadixMap<std::string, int> l;
+    std::map<std::string, int> expected;
+    std::mt19937 gen(5);
+    for (int i = 0; i < 2000; ++i)
+    {
+        auto url = makeUrl(gen);
+        l.insert({url, i});
+        expected.insert({url, i});
+    }
+
+    for (std::string prefix : {"", "h", "https://example.com/", "https://example.com/api/v1/a", "http://a.b/\xff",
+                               "http://a.b/c", "https://example.net/", "https://example.com/api/v1/abcz"})
+    {
+        std::vector<std::pair<std::string, int>> found, wanted;
+        for (auto &[key, value] : l.prefixRange(prefix))
+        {
+            found.emplace_back(key, value);
+        }
+        for (auto it = expected.lower_bound(prefix); it != expected.end() && it->first.starts_with(prefix); ++it)
+        {
+            wanted.emplace_back(it->first, it->second);
+        }
+        EXPECT_EQ(found, wanted) << prefix;
+    }
+    EXPECT_TRUE(l.prefixRange("ftp").empty());
+}
+
+TEST_F(RadixMapTest, NodeGrowShrinkTest)
+{
+    // one byte varies, so single node grows through all sizes and shrinks back
+    sd::RadixMap<uint32_t, int> l;
+    std::map<uint32_t, int> expected;
+    std::vector<uint32_t> keys;
+    for (uint32_t byte = 0; byte < 256; ++byte)
+    {
+        keys.push_back(0x12345600 | byte);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{3});
+    for (auto key : keys)
+    {
+        l.insert({key, int(key)});
+        expected.insert({key, int(key)});
+        ASSERT_TRUE(l.contains(key));
+    }
+    expectSameItems(l, expected);
+
+    for (auto key : keys)
+    {
+        l.remove(key);
+        expected.erase(key);
+        ASSERT_FALSE(l.contains(key));
+        ASSERT_EQ(l.size(), expected.size());
+    }
+    EXPECT_TRUE(l.empty());
+}
+
+TEST_F(RadixMapTest, CopyMoveTest)
+{
+    sd::RadixMap<std::string, int> v = {{"one", 1}, {"two", 2}, {"three", 3}};
+    sd::RadixMap<std::string, int> l(v);
+
+    EXPECT_EQ(l, v);
+    l.remove("two");
+    EXPECT_NE(l, v);
+
+    sd::RadixMap<std::string, int> moved(std::move(v));
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(moved.size(), 3);
+
+    v = moved;
+    EXPECT_EQ(v, moved);
+}
+
+TEST_F(RadixMapTest, RandomIntInsertRemoveTest)
+{
+    sd::RadixMap<int64_t, int> l;
+    std::map<int64_t, int> expected;
+    std::mt19937_64 gen(123);
+
+    for (int i = 0; i < 30000; ++i)
+    {
+        // mix of dense small keys and sparse keys of whole range
+        auto key = gen() % 2 ? int64_t(gen() % 2000) - 1000 : int64_t(gen());
+        if (gen() % 3)
+        {
+            EXPECT_EQ(l.insert({key, i}).second, expected.insert({key, i}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+        if (i % 97 == 0)
+        {
+            auto probe = int64_t(gen() % 3000) - 1500;
+            auto it = l.lowerBound(probe);
+            auto wanted = expected.lower_bound(probe);
+            ASSERT_EQ(it == l.end(), wanted == expected.end());
+            if (wanted != expected.end())
+            {
+                EXPECT_EQ(it->first, wanted->first);
+            }
+        }
+    }
+
+    expectSameItems(l, expected);
+}
+
+TEST_F(RadixMapTest, RandomStringInsertRemoveTest)
+{
+    sd::RadixMap<std::string, int> l;
+    std::map<std::string, int> expected;
+    std::mt19937 gen(321);
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        auto key = makeUrl(gen);
+        if (gen() % 2)
+        {
+            EXPECT_EQ(l.insert({key, i}).second, expected.insert({key, i}).second);
+        }
+        else if (expected.erase(key))
+        {
+            l.remove(key);
+        }
+        else
+        {
+            EXPECT_THROW(l.remove(key), std::out_of_range);
+        }
+        if (i % 101 == 0)
+        {
+            auto probe = makeUrl(gen);
+            auto it = l.lowerBound(probe);
+            auto wanted = expected.lower_bound(probe);
+            ASSERT_EQ(it == l.end(), wanted == expected.end());
+            if (wanted != expected.end())
+            {
+                EXPECT_EQ(it->first, wanted->first);
+            }
+        }
+    }
+
+    expectSameItems(l, expected);
+    for (auto &[key, value] : expected)
+    {
+        EXPECT_EQ(l.at(key), value);
+    }
+}